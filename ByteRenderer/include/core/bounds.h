@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "math/vec.h"
+#include "math/mat.h"
+#include "math/quaternion.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define BYTE_BOUNDS_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Byte {
+
+	struct BoundingBox {
+		Vec3 min{ 0.0f, 0.0f, 0.0f };
+		Vec3 max{ 0.0f, 0.0f, 0.0f };
+
+		Vec3 center() const {
+			return (min + max) * 0.5f;
+		}
+
+		Vec3 extent() const {
+			return (max - min) * 0.5f;
+		}
+
+		// Box around this one after scaling, rotating and translating it, as the world matrix does.
+		BoundingBox transformed(const Vec3& position, const Quaternion& rotation, const Vec3& scale) const {
+			Vec3 axes[3]{
+				rotation * Vec3{ scale.x, 0.0f, 0.0f },
+				rotation * Vec3{ 0.0f, scale.y, 0.0f },
+				rotation * Vec3{ 0.0f, 0.0f, scale.z }
+			};
+
+			Vec3 local{ extent() };
+			Vec3 half{ absolute(axes[0]) * local.x + absolute(axes[1]) * local.y + absolute(axes[2]) * local.z };
+			Vec3 middle{ rotation * (center() * scale) + position };
+
+			return BoundingBox{ middle - half, middle + half };
+		}
+
+		// Box in the space of an affine matrix, such as an orthographic light space.
+		BoundingBox transformed(const Mat4& matrix) const {
+			Vec3 local{ extent() };
+			Vec3 middle{ center() };
+
+			float values[3][2]{};
+			for (size_t row{}; row < 3; ++row) {
+				values[row][0] = matrix(row, 0) * middle.x + matrix(row, 1) * middle.y + matrix(row, 2) * middle.z + matrix(row, 3);
+				values[row][1] = std::abs(matrix(row, 0)) * local.x + std::abs(matrix(row, 1)) * local.y + std::abs(matrix(row, 2)) * local.z;
+			}
+
+			Vec3 center{ values[0][0], values[1][0], values[2][0] };
+			Vec3 half{ values[0][1], values[1][1], values[2][1] };
+
+			return BoundingBox{ center - half, center + half };
+		}
+
+	private:
+		static Vec3 absolute(const Vec3& value) {
+			return Vec3{ std::abs(value.x), std::abs(value.y), std::abs(value.z) };
+		}
+	};
+
+	struct BoundingSphere {
+		Vec3 center{ 0.0f, 0.0f, 0.0f };
+		float radius{};
+	};
+
+	// Box and sphere around a mesh's positions, in mesh space. A negative radius marks bounds
+	// that were not computed yet.
+	struct MeshBounds {
+		BoundingBox box;
+		BoundingSphere sphere{ Vec3{ 0.0f, 0.0f, 0.0f }, -1.0f };
+
+		bool empty() const {
+			return sphere.radius < 0.0f;
+		}
+
+		// Bounds of a box that was grown beyond the positions, such as for displaced meshes.
+		static MeshBounds enclosing(const BoundingBox& box) {
+			MeshBounds bounds{};
+			bounds.box = box;
+			bounds.sphere = BoundingSphere{ box.center(), box.extent().length() };
+
+			return bounds;
+		}
+
+		// Positions are the first components floats of every stride floats.
+		static MeshBounds compute(const float* positions, size_t count, size_t stride, size_t components = 3) {
+			MeshBounds bounds{};
+			bounds.sphere.radius = 0.0f;
+
+			components = std::min<size_t>(components, 3);
+			if (!count || !components) {
+				return bounds;
+			}
+
+			bounds.box = computeBox(positions, count, stride, components);
+			bounds.sphere = computeSphere(positions, count, stride, components, bounds.box);
+
+			return bounds;
+		}
+
+		static BoundingBox computeBox(const float* positions, size_t count, size_t stride, size_t components = 3) {
+			constexpr float limit{ std::numeric_limits<float>::max() };
+
+#ifdef BYTE_BOUNDS_SSE
+			// Four floats are read per vertex, so the fourth lane belongs to the next attribute.
+			if (components == 3 && stride >= 4) {
+				__m128 low[2]{ _mm_set1_ps(limit), _mm_set1_ps(limit) };
+				__m128 high[2]{ _mm_set1_ps(-limit), _mm_set1_ps(-limit) };
+
+				size_t i{};
+				for (; i + 1 < count; i += 2) {
+					__m128 first{ _mm_loadu_ps(positions + i * stride) };
+					__m128 second{ _mm_loadu_ps(positions + (i + 1) * stride) };
+
+					low[0] = _mm_min_ps(low[0], first);
+					high[0] = _mm_max_ps(high[0], first);
+					low[1] = _mm_min_ps(low[1], second);
+					high[1] = _mm_max_ps(high[1], second);
+				}
+
+				if (i < count) {
+					__m128 last{ _mm_loadu_ps(positions + i * stride) };
+					low[0] = _mm_min_ps(low[0], last);
+					high[0] = _mm_max_ps(high[0], last);
+				}
+
+				alignas(16) float min[4];
+				alignas(16) float max[4];
+				_mm_store_ps(min, _mm_min_ps(low[0], low[1]));
+				_mm_store_ps(max, _mm_max_ps(high[0], high[1]));
+
+				return BoundingBox{ Vec3{ min[0], min[1], min[2] }, Vec3{ max[0], max[1], max[2] } };
+			}
+#endif
+
+			float min[3]{ limit, limit, limit };
+			float max[3]{ -limit, -limit, -limit };
+
+			for (size_t i{}; i < count; ++i) {
+				Vec3 point{ position(positions + i * stride, components) };
+
+				for (size_t axis{}; axis < 3; ++axis) {
+					min[axis] = std::min(min[axis], coordinate(point, axis));
+					max[axis] = std::max(max[axis], coordinate(point, axis));
+				}
+			}
+
+			return BoundingBox{ Vec3{ min[0], min[1], min[2] }, Vec3{ max[0], max[1], max[2] } };
+		}
+
+		// Ritter's sphere seeded by the farthest pair of the six axis extremes (EPOS-6), kept
+		// only if it is smaller than the sphere around the box center.
+		static BoundingSphere computeSphere(const float* positions, size_t count, size_t stride, size_t components, const BoundingBox& box) {
+			size_t extremes[6]{};
+
+			for (size_t i{}; i < count; ++i) {
+				Vec3 point{ position(positions + i * stride, components) };
+
+				for (size_t axis{}; axis < 3; ++axis) {
+					if (coordinate(point, axis) < coordinate(position(positions + extremes[axis * 2] * stride, components), axis)) {
+						extremes[axis * 2] = i;
+					}
+
+					if (coordinate(point, axis) > coordinate(position(positions + extremes[axis * 2 + 1] * stride, components), axis)) {
+						extremes[axis * 2 + 1] = i;
+					}
+				}
+			}
+
+			size_t pair{};
+			float farthest{ -1.0f };
+
+			for (size_t axis{}; axis < 3; ++axis) {
+				Vec3 low{ position(positions + extremes[axis * 2] * stride, components) };
+				Vec3 high{ position(positions + extremes[axis * 2 + 1] * stride, components) };
+
+				float distance{ (high - low).dot(high - low) };
+				if (distance > farthest) {
+					farthest = distance;
+					pair = axis;
+				}
+			}
+
+			Vec3 first{ position(positions + extremes[pair * 2] * stride, components) };
+			Vec3 second{ position(positions + extremes[pair * 2 + 1] * stride, components) };
+
+			BoundingSphere ritter{ (first + second) * 0.5f, std::sqrt(farthest) * 0.5f };
+
+			for (size_t i{}; i < count; ++i) {
+				Vec3 point{ position(positions + i * stride, components) };
+				Vec3 offset{ point - ritter.center };
+
+				float distance{ offset.length() };
+				if (distance > ritter.radius) {
+					float radius{ (ritter.radius + distance) * 0.5f };
+					ritter.center += offset * ((radius - ritter.radius) / distance);
+					ritter.radius = radius;
+				}
+			}
+
+			BoundingSphere boxed{ box.center(), 0.0f };
+			for (size_t i{}; i < count; ++i) {
+				boxed.radius = std::max(boxed.radius, (position(positions + i * stride, components) - boxed.center).length());
+			}
+
+			return ritter.radius < boxed.radius ? ritter : boxed;
+		}
+
+	private:
+		static Vec3 position(const float* source, size_t components) {
+			return Vec3{ source[0], components > 1 ? source[1] : 0.0f, components > 2 ? source[2] : 0.0f };
+		}
+
+		static float coordinate(const Vec3& point, size_t axis) {
+			return axis == 0 ? point.x : axis == 1 ? point.y : point.z;
+		}
+	};
+
+}
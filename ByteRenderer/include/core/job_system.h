@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+#include "core/core_types.h"
+
+namespace Byte {
+
+	class JobSystem {
+	private:
+		struct Batch {
+			const std::function<void(size_t)>* job{};
+			size_t count{};
+			std::atomic<size_t> next{};
+			std::atomic<size_t> remaining{};
+		};
+
+		Buffer<std::thread> _workers;
+
+		std::mutex _mutex;
+		std::condition_variable _wake;
+		std::condition_variable _done;
+
+		std::shared_ptr<Batch> _batch;
+		uint64_t _generation{};
+		bool _stopping{ false };
+
+	public:
+		explicit JobSystem(size_t workerCount = defaultWorkerCount()) {
+			for (size_t i{}; i < workerCount; ++i) {
+				_workers.emplace_back([this]() {
+					work();
+				});
+			}
+		}
+
+		JobSystem(const JobSystem&) = delete;
+
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		~JobSystem() {
+			{
+				std::lock_guard<std::mutex> lock{ _mutex };
+				_stopping = true;
+			}
+
+			_wake.notify_all();
+
+			for (auto& worker : _workers) {
+				worker.join();
+			}
+		}
+
+		// Runs job(i) for every i in [0, count) and returns once all have finished.
+		// The calling thread takes part, so a pool without workers runs inline.
+		void parallelFor(size_t count, const std::function<void(size_t)>& job) {
+			if (count <= 1 || _workers.empty()) {
+				for (size_t i{}; i < count; ++i) {
+					job(i);
+				}
+				return;
+			}
+
+			auto batch{ std::make_shared<Batch>() };
+			batch->job = &job;
+			batch->count = count;
+			batch->remaining.store(count, std::memory_order_relaxed);
+
+			{
+				std::lock_guard<std::mutex> lock{ _mutex };
+				_batch = batch;
+				++_generation;
+			}
+
+			_wake.notify_all();
+
+			run(*batch);
+
+			std::unique_lock<std::mutex> lock{ _mutex };
+			_done.wait(lock, [&batch]() {
+				return batch->remaining.load(std::memory_order_acquire) == 0;
+			});
+
+			_batch.reset();
+		}
+
+		size_t workerCount() const {
+			return _workers.size();
+		}
+
+		static JobSystem& shared() {
+			static JobSystem system;
+			return system;
+		}
+
+		static size_t defaultWorkerCount() {
+			size_t cores{ std::thread::hardware_concurrency() };
+			return cores > 1 ? cores - 1 : 0;
+		}
+
+	private:
+		void work() {
+			uint64_t seen{};
+
+			while (true) {
+				std::shared_ptr<Batch> batch;
+
+				{
+					std::unique_lock<std::mutex> lock{ _mutex };
+					_wake.wait(lock, [this, seen]() {
+						return _stopping || _generation != seen;
+					});
+
+					if (_stopping) {
+						return;
+					}
+
+					seen = _generation;
+					batch = _batch;
+				}
+
+				if (batch) {
+					run(*batch);
+				}
+			}
+		}
+
+		void run(Batch& batch) {
+			while (true) {
+				size_t index{ batch.next.fetch_add(1, std::memory_order_relaxed) };
+				if (index >= batch.count) {
+					return;
+				}
+
+				(*batch.job)(index);
+
+				if (batch.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					std::lock_guard<std::mutex> lock{ _mutex };
+					_done.notify_all();
+				}
+			}
+		}
+	};
+
+}
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "core/core_types.h"
+
+namespace Byte {
+
+	enum class JsonType : uint8_t {
+		NUL,
+		BOOLEAN,
+		NUMBER,
+		STRING,
+		ARRAY,
+		OBJECT,
+	};
+
+	// A parsed JSON document. Objects keep their members in file order and are searched
+	// linearly, which suits the small objects of asset formats.
+	struct JsonValue {
+		JsonType type{ JsonType::NUL };
+
+		bool boolean{};
+		double number{};
+		std::string string;
+
+		Buffer<JsonValue> items;
+		Buffer<std::pair<std::string, JsonValue>> members;
+
+		const JsonValue* find(std::string_view key) const {
+			for (const auto& [name, value] : members) {
+				if (name == key) {
+					return &value;
+				}
+			}
+
+			return nullptr;
+		}
+
+		// Missing members read as null, so lookups can be chained.
+		const JsonValue& operator[](std::string_view key) const {
+			const JsonValue* value{ find(key) };
+			return value ? *value : null();
+		}
+
+		const JsonValue& operator[](size_t index) const {
+			return index < items.size() ? items[index] : null();
+		}
+
+		double value(std::string_view key, double fallback) const {
+			const JsonValue* member{ find(key) };
+			return member && member->type == JsonType::NUMBER ? member->number : fallback;
+		}
+
+		bool has(std::string_view key) const {
+			return find(key) != nullptr;
+		}
+
+		size_t size() const {
+			return type == JsonType::OBJECT ? members.size() : items.size();
+		}
+
+		bool isNull() const {
+			return type == JsonType::NUL;
+		}
+
+		static const JsonValue& null() {
+			static const JsonValue value;
+			return value;
+		}
+	};
+
+	struct Json {
+		static constexpr size_t maxDepth{ 256 };
+
+		static JsonValue parse(std::string_view text) {
+			Parser parser{ text.data(), text.data() + text.size() };
+
+			JsonValue value{ parser.value(0) };
+
+			parser.skip();
+			if (parser.current != parser.end) {
+				throw std::exception("Unexpected data after JSON value");
+			}
+
+			return value;
+		}
+
+	private:
+		struct Parser {
+			const char* current{};
+			const char* end{};
+
+			JsonValue value(size_t depth) {
+				if (depth > maxDepth) {
+					throw std::exception("JSON nested too deeply");
+				}
+
+				skip();
+				if (current == end) {
+					throw std::exception("Unexpected end of JSON");
+				}
+
+				JsonValue result;
+
+				switch (*current) {
+				case '{':
+					result.type = JsonType::OBJECT;
+					++current;
+
+					if (!consume('}')) {
+						do {
+							skip();
+							std::string key{ string() };
+
+							if (!consume(':')) {
+								throw std::exception("Expected ':' in JSON object");
+							}
+
+							result.members.emplace_back(std::move(key), value(depth + 1));
+						} while (consume(','));
+
+						if (!consume('}')) {
+							throw std::exception("Expected '}' in JSON object");
+						}
+					}
+					break;
+				case '[':
+					result.type = JsonType::ARRAY;
+					++current;
+
+					if (!consume(']')) {
+						do {
+							result.items.push_back(value(depth + 1));
+						} while (consume(','));
+
+						if (!consume(']')) {
+							throw std::exception("Expected ']' in JSON array");
+						}
+					}
+					break;
+				case '"':
+					result.type = JsonType::STRING;
+					result.string = string();
+					break;
+				case 't':
+					literal("true");
+					result.type = JsonType::BOOLEAN;
+					result.boolean = true;
+					break;
+				case 'f':
+					literal("false");
+					result.type = JsonType::BOOLEAN;
+					break;
+				case 'n':
+					literal("null");
+					break;
+				default: {
+					result.type = JsonType::NUMBER;
+
+					auto [next, error] { std::from_chars(current, end, result.number) };
+					if (error != std::errc{}) {
+						throw std::exception("Invalid JSON number");
+					}
+
+					current = next;
+					break;
+				}
+				}
+
+				return result;
+			}
+
+			std::string string() {
+				if (current == end || *current != '"') {
+					throw std::exception("Expected JSON string");
+				}
+
+				++current;
+
+				std::string result;
+				while (current != end && *current != '"') {
+					char c{ *current++ };
+
+					if (c != '\\') {
+						result += c;
+						continue;
+					}
+
+					if (current == end) {
+						break;
+					}
+
+					switch (char escape{ *current++ }) {
+					case 'b':
+						result += '\b';
+						break;
+					case 'f':
+						result += '\f';
+						break;
+					case 'n':
+						result += '\n';
+						break;
+					case 'r':
+						result += '\r';
+						break;
+					case 't':
+						result += '\t';
+						break;
+					case 'u': {
+						uint32_t code{ hex() };
+
+						if (code >= 0xD800 && code < 0xDC00 && end - current >= 2 && current[0] == '\\' && current[1] == 'u') {
+							current += 2;
+							code = 0x10000 + ((code - 0xD800) << 10) + (hex() - 0xDC00);
+						}
+
+						utf8(result, code);
+						break;
+					}
+					default:
+						result += escape;
+						break;
+					}
+				}
+
+				if (current == end) {
+					throw std::exception("Unterminated JSON string");
+				}
+
+				++current;
+				return result;
+			}
+
+			uint32_t hex() {
+				if (end - current < 4) {
+					throw std::exception("Invalid JSON escape");
+				}
+
+				uint32_t code{};
+				auto [next, error] { std::from_chars(current, current + 4, code, 16) };
+				if (error != std::errc{} || next != current + 4) {
+					throw std::exception("Invalid JSON escape");
+				}
+
+				current = next;
+				return code;
+			}
+
+			static void utf8(std::string& target, uint32_t code) {
+				if (code < 0x80) {
+					target += static_cast<char>(code);
+				}
+				else if (code < 0x800) {
+					target += static_cast<char>(0xC0 | (code >> 6));
+					target += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else if (code < 0x10000) {
+					target += static_cast<char>(0xE0 | (code >> 12));
+					target += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+					target += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else {
+					target += static_cast<char>(0xF0 | (code >> 18));
+					target += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+					target += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+					target += static_cast<char>(0x80 | (code & 0x3F));
+				}
+			}
+
+			void literal(std::string_view word) {
+				if (std::string_view{ current, static_cast<size_t>(end - current) }.substr(0, word.size()) != word) {
+					throw std::exception("Invalid JSON literal");
+				}
+
+				current += word.size();
+			}
+
+			bool consume(char c) {
+				skip();
+
+				if (current != end && *current == c) {
+					++current;
+					return true;
+				}
+
+				return false;
+			}
+
+			void skip() {
+				while (current != end && (*current == ' ' || *current == '\t' || *current == '\n' || *current == '\r')) {
+					++current;
+				}
+			}
+		};
+	};
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+
+#include "core/core_types.h"
+
+namespace Byte {
+
+	// A read-only view of a whole file mapped into memory. Pages are read in by the OS on
+	// first access, so data can be handed straight to the GPU without being copied first.
+	class MappedFile {
+	private:
+		const uint8_t* _data{};
+		size_t _size{};
+
+		// Win32 file and mapping handles, kept opaque so windows.h stays out of this header.
+		void* _file{};
+		void* _mapping{};
+
+	public:
+		MappedFile() = default;
+
+		explicit MappedFile(const Path& path) {
+			open(path);
+		}
+
+		MappedFile(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& right) noexcept {
+			swap(right);
+		}
+
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile& operator=(MappedFile&& right) noexcept {
+			if (this != &right) {
+				close();
+				swap(right);
+			}
+
+			return *this;
+		}
+
+		~MappedFile() {
+			close();
+		}
+
+		const uint8_t* data() const {
+			return _data;
+		}
+
+		size_t size() const {
+			return _size;
+		}
+
+		std::span<const uint8_t> bytes() const {
+			return { _data, _size };
+		}
+
+		bool empty() const {
+			return _size == 0;
+		}
+
+	private:
+		void open(const Path& path);
+
+		void close();
+
+		void swap(MappedFile& right) {
+			std::swap(_data, right._data);
+			std::swap(_size, right._size);
+			std::swap(_file, right._file);
+			std::swap(_mapping, right._mapping);
+		}
+	};
+
+}
@@ -3,6 +3,7 @@
 #include <type_traits>
 #include <unordered_map>
 #include <string>
+#include <atomic>
 
 #include "math/vec.h"
 #include "core/core_types.h"
@@ -40,6 +41,9 @@ namespace Byte {
 		using TextureMap = std::unordered_map<TextureTag, Texture*>;
 		TextureMap textureMap;
 
+		using LayerMap = std::unordered_map<TextureTag, uint32_t>;
+		LayerMap layers;
+
 		ShadowMode shadow{ ShadowMode::ENABLED };
 		TransparencyMode transparency{ TransparencyMode::BINARY };
 	};
@@ -47,6 +51,7 @@ namespace Byte {
 	class Material {
 	private:
 		MaterialData _data;
+		uint64_t _revision{ next() };
 
 	public:
 		Material() = default;
@@ -62,10 +67,12 @@ namespace Byte {
 
 		void albedo(Vec4 value) {
 			_data.albedo = value;
+			touch();
 		}
 
 		void albedo(Vec3 value) {
 			_data.albedo = Vec4(value.x,value.y,value.z,1.0f);
+			touch();
 		}
 
 		const MaterialData::ShaderMap& shaderMap() const {
@@ -73,6 +80,7 @@ namespace Byte {
 		}
 
 		MaterialData::ShaderMap& shaderMap() {
+			touch();
 			return _data.shaderMap;
 		}
 
@@ -82,6 +90,7 @@ namespace Byte {
 
 		void metallic(float value) {
 			_data.metallic = value;
+			touch();
 		}
 
 		float roughness() const {
@@ -90,6 +99,7 @@ namespace Byte {
 
 		void roughness(float value) {
 			_data.roughness = value;
+			touch();
 		}
 
 		float ambientOcclusion() const {
@@ -98,6 +108,7 @@ namespace Byte {
 
 		void ambientOcclusion(float value) {
 			_data.ambientOcclusion = value;
+			touch();
 		}
 
 		float emission() const {
@@ -106,6 +117,7 @@ namespace Byte {
 
 		void emission(float value) {
 			_data.emission = value;
+			touch();
 		}
 
 		const MaterialData& data() const {
@@ -114,6 +126,7 @@ namespace Byte {
 
 		void data(const MaterialData& materialData) {
 			_data = materialData;
+			touch();
 		}
 
 		const Texture& texture(const TextureTag& tag) const {
@@ -122,6 +135,23 @@ namespace Byte {
 
 		void texture(const TextureTag& tag, Texture& texture) {
 			_data.textureMap.emplace(tag, &texture);
+			touch();
+		}
+
+		// Points the tag at one layer of an array texture, replacing any earlier texture.
+		void texture(const TextureTag& tag, Texture& array, uint32_t layer) {
+			_data.textureMap.insert_or_assign(tag, &array);
+			_data.layers.insert_or_assign(tag, layer);
+			touch();
+		}
+
+		uint32_t layer(const TextureTag& tag) const {
+			auto result{ _data.layers.find(tag) };
+			return result != _data.layers.end() ? result->second : 0;
+		}
+
+		const MaterialData::LayerMap& layers() const {
+			return _data.layers;
 		}
 
 		const MaterialData::TextureMap& textureMap() const {
@@ -129,6 +159,7 @@ namespace Byte {
 		}
 
 		MaterialData::TextureMap& textureMap() {
+			touch();
 			return _data.textureMap;
 		}
 
@@ -142,6 +173,7 @@ namespace Byte {
 
 		void shadow(ShadowMode mode) {
 			_data.shadow = mode;
+			touch();
 		}
 
 		TransparencyMode transparency() const {
@@ -150,6 +182,22 @@ namespace Byte {
 
 		void transparency(TransparencyMode mode) {
 			_data.transparency = mode;
+			touch();
+		}
+
+		// Changes with every edit and is unique across materials, so caches can compare it alone.
+		uint64_t revision() const {
+			return _revision;
+		}
+
+	private:
+		void touch() {
+			_revision = next();
+		}
+
+		static uint64_t next() {
+			static std::atomic<uint64_t> counter{};
+			return ++counter;
 		}
 
 	};
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <cmath>
 #include <utility> 
 #include <memory>
 
+#include "math/vec.h"
+#include "math/trigonometry.h"
+#include "core/bounds.h"
 #include "core/core_types.h"
+#include "core/vertex_format.h"
+#include "core/vertex.h"
 
 namespace Byte {
 
@@ -14,15 +21,41 @@ namespace Byte {
         DYNAMIC,
     };
 
+    // A run of indices within a mesh and a sphere, in mesh space, around the vertices it draws.
+    struct MeshRange {
+        uint32_t firstIndex{};
+        uint32_t indexCount{};
+        Vec3 center;
+        float radius{};
+    };
+
+    // A coarser index buffer over the same vertices and the mesh space error it introduces.
+    struct MeshLod {
+        Buffer<uint32_t> indices;
+        float error{};
+    };
+
     struct MeshData {
         Buffer<float> vertices;
         Buffer<uint32_t> indices;
 
         MeshMode mode{ MeshMode::STATIC };
 
-        float boundingRadius{ 1.0f };
+        // Computed from the positions when the mesh is created if left empty, so anything
+        // that moves vertices has to reset it.
+        MeshBounds bounds;
 
         Buffer<uint8_t> vertexLayout{ 3,3,2 };
+        Buffer<VertexType> vertexTypes;
+
+        Buffer<MeshRange> ranges;
+
+        // Ordered from finest to coarsest.
+        Buffer<MeshLod> lods;
+
+        // GPU-ready vertices in the layout and types above, uploaded as they are when set.
+        // Anything that changes the float vertices has to clear them.
+        PackedVertices packed;
     };
 
 	class Mesh {
@@ -34,7 +67,11 @@ namespace Byte {
 
 		Mesh(MeshData&& data)
 			: _data{ std::move(data) }
-		{}
+		{
+			if (_data.bounds.empty()) {
+				_data.bounds = computeBounds(_data);
+			}
+		}
 
 		const Buffer<float>& vertices() const {
 			return _data.vertices;
@@ -52,18 +89,103 @@ namespace Byte {
 			return _data;
 		}
 
+		const Buffer<MeshRange>& ranges() const {
+			return _data.ranges;
+		}
+
+		const MeshBounds& bounds() const {
+			return _data.bounds;
+		}
+
         bool empty() const {
-            return _data.vertices.empty();
+            return _data.vertices.empty() && _data.packed.empty();
+        }
+
+        // Level 0 is the mesh itself, higher levels are its coarser LODs.
+        size_t lodCount() const {
+            return _data.lods.size() + 1;
+        }
+
+        float lodError(size_t level) const {
+            return level ? _data.lods[level - 1].error : 0.0f;
+        }
+
+        uint32_t lodIndexCount(size_t level) const {
+            return static_cast<uint32_t>(level ? _data.lods[level - 1].indices.size() : _data.indices.size());
+        }
+
+        // Offset of a level within allIndices.
+        uint32_t lodFirstIndex(size_t level) const {
+            size_t first{};
+            for (size_t i{}; i < level; ++i) {
+                first += lodIndexCount(i);
+            }
+
+            return static_cast<uint32_t>(first);
+        }
+
+        // The mesh's indices followed by those of every LOD, as they are uploaded.
+        Buffer<uint32_t> allIndices() const {
+            Buffer<uint32_t> indices{ _data.indices };
+            for (const MeshLod& lod : _data.lods) {
+                indices.insert(indices.end(), lod.indices.begin(), lod.indices.end());
+            }
+
+            return indices;
+        }
+
+        // Coarsest level whose error, times pixelsPerUnit, stays within threshold pixels. Going
+        // coarser than current needs the error to be below threshold * (1 - hysteresis), so
+        // meshes close to a switching distance keep their level instead of flickering.
+        size_t selectLod(float pixelsPerUnit, float threshold, float hysteresis, size_t current) const {
+            size_t level{};
+            while (level + 1 < lodCount() && lodError(level + 1) * pixelsPerUnit <= threshold) {
+                ++level;
+            }
+
+            while (level > current && lodError(level) * pixelsPerUnit > threshold * (1.0f - hysteresis)) {
+                --level;
+            }
+
+            return level;
+        }
+
+        // Positions are the first attribute, decoded from the packed vertices when there are no floats.
+        static MeshBounds computeBounds(const MeshData& data) {
+            if (data.vertexLayout.empty()) {
+                return MeshBounds{};
+            }
+
+            size_t stride{};
+            for (uint8_t count : data.vertexLayout) {
+                stride += count;
+            }
+
+            if (!data.vertices.empty()) {
+                return MeshBounds::compute(data.vertices.data(), data.vertices.size() / stride, stride, data.vertexLayout[0]);
+            }
+
+            Buffer<float> vertices{ VertexFormat::unpack(
+                data.packed.bytes(),
+                data.packed.stride,
+                data.vertexLayout,
+                data.vertexTypes,
+                data.packed.positionScale,
+                data.packed.positionOffset) };
+
+            return MeshBounds::compute(vertices.data(), vertices.size() / stride, stride, data.vertexLayout[0]);
         }
 	};
 
     struct MeshBuilder {
+        static constexpr size_t minSphereSegments{ 4 };
+
+        template<typename Format = StandardVertex>
         static Mesh sphere(float radius, size_t numSegments) {
             size_t numVertices{ (numSegments + 1) * (numSegments + 1) };
-            size_t numTriangles{ numSegments * numSegments * 2 };
+            float scale{ positionScale<Format>(radius) };
 
-            Buffer<float> vertexData(numVertices * (3 + 3 + 2));
-            Buffer<uint32_t> indices(numTriangles * 3);
+            Buffer<Format> vertices(numVertices);
 
             for (size_t i{}; i <= numSegments; ++i) {
                 float phi{ pi<float>() * static_cast<float>(i) / numSegments };
@@ -74,66 +196,46 @@ namespace Byte {
                     float y{ radius * std::sin(phi) * std::sin(theta) };
                     float z{ radius * std::cos(phi) };
 
-                    size_t index{ i * (numSegments + 1) + j };
-                    size_t offset{ index * (3 + 3 + 2) };
-
-                    vertexData[offset] = x;
-                    vertexData[offset + 1] = y;
-                    vertexData[offset + 2] = z;
-
-                    Vec3 normal{ Vec3(x, y, z).normalized() };
-                    vertexData[offset + 3] = normal.x;
-                    vertexData[offset + 4] = normal.y;
-                    vertexData[offset + 5] = normal.z;
+                    Vec3 position{ x, y, z };
+                    Vec2 uv{ static_cast<float>(j) / numSegments, static_cast<float>(i) / numSegments };
 
-                    vertexData[offset + 6] = static_cast<float>(j) / numSegments;
-                    vertexData[offset + 7] = static_cast<float>(i) / numSegments;
+                    vertices[i * (numSegments + 1) + j] = Format{ position / scale, position.normalized(), uv };
                 }
             }
     
-            for (size_t i{}; i < numSegments; ++i) {
-                for (size_t j{}; j < numSegments; ++j) {
-                    uint32_t first{ static_cast<uint32_t>(i * (numSegments + 1) + j) };
-                    uint32_t second{ static_cast<uint32_t>(first + numSegments + 1) };
-
-                    indices.push_back(first);
-                    indices.push_back(second);
-                    indices.push_back(first + 1);
-
-                    indices.push_back(second);
-                    indices.push_back(second + 1);
-                    indices.push_back(first + 1);
-                }
+            MeshData data{ build(vertices, sphereIndices(numSegments, numSegments), scale).data() };
+
+            // Levels take about every other ring and segment of the level before, so they share its
+            // vertices. The error is how much further their flat faces sink below the surface.
+            float base{ std::cos(pi<float>() / numSegments) };
+            for (size_t segments{ numSegments / 2 }; segments >= minSphereSegments; segments /= 2) {
+                data.lods.push_back(MeshLod{
+                    sphereIndices(numSegments, segments),
+                    radius * (base - std::cos(pi<float>() / segments)) });
             }
 
-            MeshData data{ std::move(vertexData), std::move(indices), MeshMode::STATIC, radius};
             return Mesh{ std::move(data) };
         }
 
+        template<typename Format = StandardVertex>
         static Mesh plane(float width, float height, size_t numSegments) {
             size_t numVertices{ (numSegments + 1) * (numSegments + 1) };
             size_t numTriangles{ numSegments * numSegments * 2 };
 
-            std::vector<float> vertexData(numVertices * (3 + 3 + 2));
-            std::vector<uint32_t> indices(numTriangles * 3);
+            float scale{ positionScale<Format>(std::max(width, height) / 2.0f) };
+
+            Buffer<Format> vertices(numVertices);
+            Buffer<uint32_t> indices(numTriangles * 3);
 
             for (size_t i{}; i <= numSegments; ++i) {
                 float y{ static_cast<float>(i) / numSegments * height - height / 2.0f };
                 for (size_t j{}; j <= numSegments; ++j) {
                     float x{ static_cast<float>(j) / numSegments * width - width / 2.0f };
-                    size_t index{ i * (numSegments + 1) + j };
-                    size_t offset{ index * (3 + 3 + 2) };
 
-                    vertexData[offset] = x;
-                    vertexData[offset + 1] = 0.0f;
-                    vertexData[offset + 2] = y;
+                    Vec3 position{ x, 0.0f, y };
+                    Vec2 uv{ static_cast<float>(j) / numSegments, static_cast<float>(i) / numSegments };
 
-                    vertexData[offset + 3] = 0.0f;
-                    vertexData[offset + 4] = 1.0f;
-                    vertexData[offset + 5] = 0.0f;
-
-                    vertexData[offset + 6] = static_cast<float>(j) / numSegments;
-                    vertexData[offset + 7] = static_cast<float>(i) / numSegments;
+                    vertices[i * (numSegments + 1) + j] = Format{ position / scale, Vec3{ 0.0f, 1.0f, 0.0f }, uv };
                 }
             }
 
@@ -156,30 +258,30 @@ namespace Byte {
                 }
             }
 
-            float radius{ Vec2{ width / 2, height / 2 }.length() };
-
-            MeshData data{ std::move(vertexData), std::move(indices), MeshMode::STATIC, radius };
-            return Mesh{ std::move(data) };
+            return build(vertices, std::move(indices), scale);
         }
 
         static Mesh quad() {
-            const Buffer<float> vertexData{
+            MeshData data{};
+            data.vertices = {
                -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
                -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
                 1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
                 1.0f, -1.0f, 0.0f, 1.0f, 0.0f
             };
-            const Buffer<uint32_t> indices{
+            data.indices = {
                 0, 1, 2,
                 1, 3, 2
             };
+            data.mode = MeshMode::STATIC;
+            data.vertexLayout = { 3,2 };
 
-            MeshData data{ vertexData, indices, MeshMode::STATIC, 1.0f, {3,2} };
             return Mesh{ std::move(data) };
         }
 
+        template<typename Format = StandardVertex>
         static Mesh cube() {
-            std::vector<float> vertices{
+            constexpr float table[]{
                 -0.5f,-0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
                  0.5f,-0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,
                  0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
@@ -220,7 +322,135 @@ namespace Byte {
                 20, 21, 22, 20, 22, 23
             };
 
-            MeshData data{ std::move(vertices), std::move(indices), MeshMode::STATIC, 0.71f };
+            float scale{ positionScale<Format>(0.5f) };
+
+            Buffer<Format> vertices(24);
+            for (size_t i{}; i < vertices.size(); ++i) {
+                const float* vertex{ table + i * 8 };
+
+                vertices[i] = Format{
+                    Vec3{ vertex[0], vertex[1], vertex[2] } / scale,
+                    Vec3{ vertex[3], vertex[4], vertex[5] },
+                    Vec2{ vertex[6], vertex[7] } };
+            }
+
+            return build(vertices, std::move(indices), scale);
+        }
+
+        // Takes typed vertices as they are for the GPU and keeps float copies of them for the
+        // CPU side. positionScale undoes Position16 coordinates being relative to the bounds.
+        template<typename Format>
+        static Mesh build(
+            const Buffer<Format>& vertices,
+            Buffer<uint32_t>&& indices,
+            float positionScale = 1.0f,
+            MeshMode mode = MeshMode::STATIC) {
+            static_assert(sizeof(Format) == Format::stride);
+
+            MeshData data{};
+            data.indices = std::move(indices);
+            data.mode = mode;
+            data.vertexLayout = Format::vertexLayout();
+            data.vertexTypes = Format::vertexTypes();
+
+            data.vertices.resize(vertices.size() * Format::floats);
+
+            if constexpr (Format::packed) {
+                for (size_t i{}; i < vertices.size(); ++i) {
+                    float* target{ data.vertices.data() + i * Format::floats };
+                    vertices[i].unpack(target);
+
+                    if constexpr (Format::types[0] == VertexType::SNORM16) {
+                        for (size_t c{}; c < Format::layout[0]; ++c) {
+                            target[c] *= positionScale;
+                        }
+                    }
+                }
+
+                data.packed.vertices.resize(vertices.size() * Format::stride);
+                std::memcpy(data.packed.vertices.data(), vertices.data(), data.packed.vertices.size());
+                data.packed.stride = Format::stride;
+                data.packed.positionScale = positionScale;
+            }
+            else {
+                std::memcpy(data.vertices.data(), vertices.data(), vertices.size() * Format::stride);
+            }
+
+            return Mesh{ std::move(data) };
+        }
+
+        // Picks compact GPU types: positions relative to the bounds, an octahedral normal if the
+        // second attribute has three components, and texture coordinates as UNORM16 while they
+        // stay within [0, 1]. Remaining attributes stay floats.
+        static void quantize(MeshData& data) {
+            const Buffer<uint8_t>& layout{ data.vertexLayout };
+
+            data.packed = PackedVertices{};
+            data.vertexTypes.assign(layout.size(), VertexType::FLOAT);
+            if (layout.empty() || layout[0] != 3) {
+                return;
+            }
+
+            size_t stride{};
+            for (uint8_t count : layout) {
+                stride += count;
+            }
+
+            data.vertexTypes[0] = VertexType::SNORM16;
+
+            size_t offset{ layout[0] };
+            for (size_t i{ 1 }; i < layout.size(); offset += layout[i], ++i) {
+                if (i == 1 && layout[i] == 3) {
+                    data.vertexTypes[i] = VertexType::OCTAHEDRAL;
+                }
+                else if (layout[i] == 2) {
+                    bool unit{ true };
+                    for (size_t v{ offset }; v < data.vertices.size() && unit; v += stride) {
+                        unit = data.vertices[v] >= 0.0f && data.vertices[v] <= 1.0f &&
+                            data.vertices[v + 1] >= 0.0f && data.vertices[v + 1] <= 1.0f;
+                    }
+
+                    data.vertexTypes[i] = unit ? VertexType::UNORM16 : VertexType::HALF_FLOAT;
+                }
+            }
+        }
+
+        template<typename Format>
+        static float positionScale(float extent) {
+            return Format::types[0] == VertexType::SNORM16 && extent > 0.0f ? extent : 1.0f;
+        }
+
+        // Triangles over segments + 1 of the numSegments + 1 rings and columns of a sphere grid.
+        static Buffer<uint32_t> sphereIndices(size_t numSegments, size_t segments) {
+            auto line = [numSegments, segments](size_t k) {
+                return (k * numSegments + segments / 2) / segments;
+            };
+
+            Buffer<uint32_t> indices;
+            indices.reserve(segments * segments * 6);
+
+            for (size_t i{}; i < segments; ++i) {
+                for (size_t j{}; j < segments; ++j) {
+                    uint32_t first{ static_cast<uint32_t>(line(i) * (numSegments + 1) + line(j)) };
+                    uint32_t second{ static_cast<uint32_t>(line(i + 1) * (numSegments + 1) + line(j)) };
+                    uint32_t next{ static_cast<uint32_t>(line(j + 1) - line(j)) };
+
+                    indices.push_back(first);
+                    indices.push_back(second);
+                    indices.push_back(first + next);
+
+                    indices.push_back(second);
+                    indices.push_back(second + next);
+                    indices.push_back(first + next);
+                }
+            }
+
+            return indices;
+        }
+
+        static Mesh quantized(const Mesh& mesh) {
+            MeshData data{ mesh.data() };
+            quantize(data);
             return Mesh{ std::move(data) };
         }
     };
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+#include "core/bounds.h"
+#include "core/core_types.h"
+#include "core/mapped_file.h"
+#include "core/mesh.h"
+#include "core/vertex_format.h"
+
+namespace Byte {
+
+	// Fixed header at the start of a mesh file. Sections follow at the given offsets, each
+	// aligned to sectionAlignment: vertices already in their GPU layout, indices at indexSize
+	// bytes each with the LOD indices after the base ones, ranges, and the LOD table. All
+	// values are little-endian.
+	struct MeshFileHeader {
+		static constexpr char signature[8]{ 'B', 'Y', 'T', 'E', 'M', 'S', 'H', '\0' };
+		static constexpr uint32_t currentVersion{ 3 };
+		static constexpr size_t maxAttributes{ 8 };
+
+		char magic[8]{};
+		uint32_t version{};
+		uint32_t headerSize{};
+
+		uint64_t vertexOffset{};
+		uint64_t indexOffset{};
+		uint64_t rangeOffset{};
+		uint64_t lodOffset{};
+
+		uint32_t vertexCount{};
+		uint32_t stride{};
+		uint32_t indexCount{};
+		uint32_t lodIndexCount{};
+		uint32_t indexSize{};
+		uint32_t rangeCount{};
+		uint32_t lodCount{};
+		uint32_t attributeCount{};
+
+		uint8_t layout[maxAttributes]{};
+		uint8_t types[maxAttributes]{};
+
+		uint8_t mode{};
+		uint8_t padding[3]{};
+
+		float positionScale{ 1.0f };
+		float positionOffset[3]{};
+		float center[3]{};
+		float radius{};
+		float min[3]{};
+		float max[3]{};
+	};
+
+	struct MeshFileRange {
+		uint32_t firstIndex{};
+		uint32_t indexCount{};
+		float center[3]{};
+		float radius{};
+	};
+
+	// firstIndex counts from the start of the index section.
+	struct MeshFileLod {
+		uint32_t firstIndex{};
+		uint32_t indexCount{};
+		float error{};
+		uint32_t padding{};
+	};
+
+	// Binary mesh container, written from any Mesh and loaded by mapping the file. Loaded
+	// meshes keep the mapping alive and view their vertices straight out of it, so uploads
+	// read from the page cache with no copy in between. Indices, ranges and LODs are small
+	// and copied out. Float vertices are only decoded on request, for CPU users such as
+	// StaticBatcher or MeshOptimizer.
+	struct MeshFile {
+		static constexpr size_t sectionAlignment{ 64 };
+
+		static void write(const Path& path, const Mesh& mesh) {
+			const MeshData& data{ mesh.data() };
+
+			if (data.vertexLayout.size() > MeshFileHeader::maxAttributes) {
+				throw std::exception("Too many vertex attributes for a mesh file");
+			}
+
+			PackedVertices converted;
+			std::span<const uint8_t> vertices;
+			size_t stride{};
+			float positionScale{ 1.0f };
+			Vec3 positionOffset;
+
+			if (!data.packed.empty()) {
+				vertices = data.packed.bytes();
+				stride = data.packed.stride;
+				positionScale = data.packed.positionScale;
+				positionOffset = data.packed.positionOffset;
+			}
+			else if (!data.vertexTypes.empty()) {
+				converted = VertexFormat::pack(data.vertices, data.vertexLayout, data.vertexTypes);
+				vertices = converted.bytes();
+				stride = converted.stride;
+				positionScale = converted.positionScale;
+				positionOffset = converted.positionOffset;
+			}
+			else {
+				vertices = std::span<const uint8_t>{
+					reinterpret_cast<const uint8_t*>(data.vertices.data()),
+					data.vertices.size() * sizeof(float) };
+				stride = VertexFormat::stride(data.vertexLayout, data.vertexTypes);
+			}
+
+			MeshFileHeader header{};
+			std::memcpy(header.magic, MeshFileHeader::signature, sizeof(header.magic));
+			header.version = MeshFileHeader::currentVersion;
+			header.headerSize = sizeof(MeshFileHeader);
+
+			header.vertexCount = static_cast<uint32_t>(stride ? vertices.size() / stride : 0);
+			header.stride = static_cast<uint32_t>(stride);
+			header.indexCount = static_cast<uint32_t>(data.indices.size());
+			header.rangeCount = static_cast<uint32_t>(data.ranges.size());
+			header.lodCount = static_cast<uint32_t>(data.lods.size());
+			header.attributeCount = static_cast<uint32_t>(data.vertexLayout.size());
+			header.mode = static_cast<uint8_t>(data.mode);
+			header.positionScale = positionScale;
+			store(header.positionOffset, positionOffset);
+
+			const MeshBounds& bounds{ mesh.bounds() };
+			store(header.center, bounds.sphere.center);
+			store(header.min, bounds.box.min);
+			store(header.max, bounds.box.max);
+			header.radius = bounds.sphere.radius;
+
+			for (size_t i{}; i < data.vertexLayout.size(); ++i) {
+				header.layout[i] = data.vertexLayout[i];
+				header.types[i] = static_cast<uint8_t>(VertexFormat::type(data.vertexTypes, i));
+			}
+
+			Buffer<uint32_t> indices{ data.indices };
+			Buffer<MeshFileLod> lods;
+			lods.reserve(data.lods.size());
+
+			for (const MeshLod& lod : data.lods) {
+				lods.push_back(MeshFileLod{ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lod.indices.size()), lod.error });
+				indices.insert(indices.end(), lod.indices.begin(), lod.indices.end());
+			}
+
+			header.lodIndexCount = static_cast<uint32_t>(indices.size() - data.indices.size());
+
+			bool narrow{ std::all_of(indices.begin(), indices.end(), [](uint32_t index) {
+				return index <= UINT16_MAX;
+			}) };
+
+			header.indexSize = narrow ? sizeof(uint16_t) : sizeof(uint32_t);
+
+			Buffer<MeshFileRange> ranges;
+			ranges.reserve(data.ranges.size());
+
+			for (const MeshRange& range : data.ranges) {
+				ranges.push_back(MeshFileRange{
+					range.firstIndex,
+					range.indexCount,
+					{ range.center.x, range.center.y, range.center.z },
+					range.radius });
+			}
+
+			header.vertexOffset = align(sizeof(MeshFileHeader));
+			header.indexOffset = align(header.vertexOffset + vertices.size());
+			header.rangeOffset = align(header.indexOffset + indices.size() * header.indexSize);
+			header.lodOffset = align(header.rangeOffset + ranges.size() * sizeof(MeshFileRange));
+
+			std::ofstream file{ path, std::ios::binary };
+			if (!file) {
+				throw std::exception("Cannot open mesh file");
+			}
+
+			put(file, &header, sizeof(header));
+
+			pad(file, header.vertexOffset);
+			put(file, vertices.data(), vertices.size());
+
+			pad(file, header.indexOffset);
+			if (narrow) {
+				Buffer<uint16_t> narrowed{ indices.begin(), indices.end() };
+				put(file, narrowed.data(), narrowed.size() * sizeof(uint16_t));
+			}
+			else {
+				put(file, indices.data(), indices.size() * sizeof(uint32_t));
+			}
+
+			pad(file, header.rangeOffset);
+			put(file, ranges.data(), ranges.size() * sizeof(MeshFileRange));
+
+			pad(file, header.lodOffset);
+			put(file, lods.data(), lods.size() * sizeof(MeshFileLod));
+
+			if (!file) {
+				throw std::exception("Cannot write mesh file");
+			}
+		}
+
+		// Vertices stay in the mapping, which is released with the last copy of the mesh data.
+		static Mesh load(const Path& path, bool floats = false) {
+			auto file{ std::make_shared<const MappedFile>(path) };
+			MeshFileHeader header{ validate(*file) };
+
+			const uint8_t* bytes{ file->data() };
+
+			MeshData data;
+			data.mode = static_cast<MeshMode>(header.mode);
+			data.bounds.box = BoundingBox{ Vec3{ header.min[0], header.min[1], header.min[2] }, Vec3{ header.max[0], header.max[1], header.max[2] } };
+			data.bounds.sphere = BoundingSphere{ Vec3{ header.center[0], header.center[1], header.center[2] }, header.radius };
+			data.vertexLayout.assign(header.layout, header.layout + header.attributeCount);
+
+			bool typed{ false };
+			for (uint32_t i{}; i < header.attributeCount; ++i) {
+				typed = typed || static_cast<VertexType>(header.types[i]) != VertexType::FLOAT;
+			}
+
+			if (typed) {
+				data.vertexTypes.resize(header.attributeCount);
+				for (uint32_t i{}; i < header.attributeCount; ++i) {
+					data.vertexTypes[i] = static_cast<VertexType>(header.types[i]);
+				}
+			}
+
+			data.packed.view = std::span<const uint8_t>{ bytes + header.vertexOffset, size_t{ header.vertexCount } * header.stride };
+			data.packed.owner = file;
+			data.packed.stride = header.stride;
+			data.packed.positionScale = header.positionScale;
+			data.packed.positionOffset = Vec3{ header.positionOffset[0], header.positionOffset[1], header.positionOffset[2] };
+
+			Buffer<uint32_t> indices{ readIndices(bytes + header.indexOffset, header) };
+			data.indices.assign(indices.begin(), indices.begin() + header.indexCount);
+
+			data.ranges.reserve(header.rangeCount);
+			for (uint32_t i{}; i < header.rangeCount; ++i) {
+				MeshFileRange range{ read<MeshFileRange>(bytes + header.rangeOffset, i) };
+				data.ranges.push_back(MeshRange{
+					range.firstIndex,
+					range.indexCount,
+					Vec3{ range.center[0], range.center[1], range.center[2] },
+					range.radius });
+			}
+
+			data.lods.reserve(header.lodCount);
+			for (uint32_t i{}; i < header.lodCount; ++i) {
+				MeshFileLod lod{ read<MeshFileLod>(bytes + header.lodOffset, i) };
+
+				data.lods.push_back(MeshLod{
+					Buffer<uint32_t>{ indices.begin() + lod.firstIndex, indices.begin() + lod.firstIndex + lod.indexCount },
+					lod.error });
+			}
+
+			if (floats) {
+				data.vertices = VertexFormat::unpack(data.packed.view, data.packed.stride, data.vertexLayout, data.vertexTypes, data.packed.positionScale, data.packed.positionOffset);
+			}
+
+			return Mesh{ std::move(data) };
+		}
+
+		static MeshFileHeader inspect(const Path& path) {
+			return validate(MappedFile{ path });
+		}
+
+	private:
+		static MeshFileHeader validate(const MappedFile& file) {
+			if (file.size() < sizeof(MeshFileHeader)) {
+				throw std::exception("Not a mesh file");
+			}
+
+			MeshFileHeader header{ read<MeshFileHeader>(file.data(), 0) };
+
+			if (std::memcmp(header.magic, MeshFileHeader::signature, sizeof(header.magic)) != 0) {
+				throw std::exception("Not a mesh file");
+			}
+
+			if (header.version != MeshFileHeader::currentVersion || header.headerSize != sizeof(MeshFileHeader)) {
+				throw std::exception("Unsupported mesh file version");
+			}
+
+			if (header.attributeCount > MeshFileHeader::maxAttributes ||
+				(header.indexSize != sizeof(uint16_t) && header.indexSize != sizeof(uint32_t))) {
+				throw std::exception("Corrupt mesh file");
+			}
+
+			Buffer<uint8_t> layout{ header.layout, header.layout + header.attributeCount };
+			Buffer<VertexType> types(header.attributeCount);
+
+			for (uint32_t i{}; i < header.attributeCount; ++i) {
+				if (header.types[i] > static_cast<uint8_t>(VertexType::OCTAHEDRAL)) {
+					throw std::exception("Corrupt mesh file");
+				}
+
+				types[i] = static_cast<VertexType>(header.types[i]);
+			}
+
+			uint64_t indexCount{ uint64_t{ header.indexCount } + header.lodIndexCount };
+
+			if (header.stride != VertexFormat::stride(layout, types) ||
+				!fits(file, header.vertexOffset, uint64_t{ header.vertexCount } * header.stride) ||
+				!fits(file, header.indexOffset, indexCount * header.indexSize) ||
+				!fits(file, header.rangeOffset, uint64_t{ header.rangeCount } * sizeof(MeshFileRange)) ||
+				!fits(file, header.lodOffset, uint64_t{ header.lodCount } * sizeof(MeshFileLod))) {
+				throw std::exception("Corrupt mesh file");
+			}
+
+			for (uint32_t i{}; i < header.rangeCount; ++i) {
+				MeshFileRange range{ read<MeshFileRange>(file.data() + header.rangeOffset, i) };
+
+				if (uint64_t{ range.firstIndex } + range.indexCount > header.indexCount) {
+					throw std::exception("Corrupt mesh file");
+				}
+			}
+
+			for (uint32_t i{}; i < header.lodCount; ++i) {
+				MeshFileLod lod{ read<MeshFileLod>(file.data() + header.lodOffset, i) };
+
+				if (lod.firstIndex < header.indexCount || uint64_t{ lod.firstIndex } + lod.indexCount > indexCount) {
+					throw std::exception("Corrupt mesh file");
+				}
+			}
+
+			return header;
+		}
+
+		// Widens the base and LOD indices and checks them against the vertex count.
+		static Buffer<uint32_t> readIndices(const uint8_t* source, const MeshFileHeader& header) {
+			Buffer<uint32_t> indices(size_t{ header.indexCount } + header.lodIndexCount);
+
+			if (header.indexSize == sizeof(uint16_t)) {
+				for (size_t i{}; i < indices.size(); ++i) {
+					indices[i] = read<uint16_t>(source, i);
+				}
+			}
+			else {
+				std::memcpy(indices.data(), source, indices.size() * sizeof(uint32_t));
+			}
+
+			bool valid{ std::all_of(indices.begin(), indices.end(), [&header](uint32_t index) {
+				return index < header.vertexCount;
+			}) };
+
+			if (!valid) {
+				throw std::exception("Mesh file index out of range");
+			}
+
+			return indices;
+		}
+
+		static void store(float (&target)[3], const Vec3& value) {
+			target[0] = value.x;
+			target[1] = value.y;
+			target[2] = value.z;
+		}
+
+		template<typename Type>
+		static Type read(const uint8_t* source, size_t index) {
+			static_assert(std::is_trivially_copyable_v<Type>);
+
+			Type value;
+			std::memcpy(&value, source + index * sizeof(Type), sizeof(Type));
+			return value;
+		}
+
+		static bool fits(const MappedFile& file, uint64_t offset, uint64_t size) {
+			return offset <= file.size() && size <= file.size() - offset;
+		}
+
+		static uint64_t align(uint64_t offset) {
+			return (offset + sectionAlignment - 1) & ~uint64_t{ sectionAlignment - 1 };
+		}
+
+		static void put(std::ofstream& file, const void* data, size_t size) {
+			file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+		}
+
+		static void pad(std::ofstream& file, uint64_t offset) {
+			constexpr char zeros[sectionAlignment]{};
+
+			uint64_t position{ static_cast<uint64_t>(file.tellp()) };
+			put(file, zeros, static_cast<size_t>(offset - position));
+		}
+	};
+
+}
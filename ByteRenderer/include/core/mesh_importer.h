@@ -0,0 +1,1163 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "math/vec.h"
+#include "math/mat.h"
+#include "core/bounds.h"
+#include "core/core_types.h"
+#include "core/job_system.h"
+#include "core/json.h"
+#include "core/mapped_file.h"
+#include "core/mesh.h"
+#include "core/mesh_simplifier.h"
+
+namespace Byte {
+
+	struct ImportSettings {
+		MeshMode mode{ MeshMode::STATIC };
+
+		// Stores the result in the compact vertex types picked by MeshBuilder::quantize.
+		bool quantize{ false };
+
+		// Adds a chain of simplified index buffers for MeshSimplifier's levels of detail.
+		bool lods{ false };
+
+		// Text inputs are split into chunks of about this many bytes that are parsed in parallel.
+		size_t chunkSize{ size_t{ 4 } << 20 };
+	};
+
+	// Loads OBJ and glTF 2.0 (.gltf, .glb) files into one mesh of the default 3,3,2 layout. Each
+	// OBJ object, group or material and each glTF primitive becomes a range with its own bounds;
+	// glTF node transforms are baked in. Inputs are mapped rather than read, OBJ text is parsed
+	// in parallel chunks and its vertices are deduplicated by hashing their index triples.
+	// Missing normals are generated: smooth for OBJ, flat for glTF as its specification asks.
+	struct MeshImporter {
+		static MeshData load(const Path& path, const ImportSettings& settings = {}) {
+			std::string extension{ path.extension().string() };
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+				return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+			});
+
+			MeshData data;
+
+			if (extension == ".obj") {
+				data = loadObj(path, settings);
+			}
+			else if (extension == ".gltf" || extension == ".glb") {
+				data = loadGltf(path);
+			}
+			else {
+				throw std::exception("Unsupported mesh format");
+			}
+
+			finish(data, settings);
+			return data;
+		}
+
+	private:
+		static constexpr size_t stride{ 8 };
+		static constexpr uint32_t missing{ UINT32_MAX };
+
+		// Where a range of the output starts, in triangle corners.
+		struct Part {
+			size_t firstCorner{};
+		};
+
+		// Face corner as written in the file; components flagged relative count back from the
+		// end of the chunk's own attributes and are resolved once all chunks are parsed.
+		struct ObjCorner {
+			int64_t index[3]{};
+			uint8_t relative{};
+			uint8_t present{};
+		};
+
+		struct ObjChunk {
+			Buffer<float> positions;
+			Buffer<float> uvs;
+			Buffer<float> normals;
+
+			Buffer<ObjCorner> corners;
+			Buffer<Part> parts;
+
+			Buffer<uint32_t> resolved;
+			Buffer<uint32_t> local;
+			Buffer<uint32_t> keys;
+			Buffer<uint32_t> remap;
+		};
+
+		// Open addressing table from index triples to dense ids in first-use order.
+		class TripleTable {
+		private:
+			Buffer<uint32_t> _slots;
+			Buffer<uint32_t> _keys;
+			size_t _mask{};
+
+		public:
+			explicit TripleTable(size_t expected) {
+				size_t capacity{ 16 };
+				while (capacity < expected * 2) {
+					capacity <<= 1;
+				}
+
+				_slots.assign(capacity, missing);
+				_mask = capacity - 1;
+				_keys.reserve(expected * 3);
+			}
+
+			uint32_t insert(const uint32_t* key) {
+				size_t slot{ hash(key) & _mask };
+
+				while (true) {
+					uint32_t id{ _slots[slot] };
+
+					if (id == missing) {
+						id = static_cast<uint32_t>(_keys.size() / 3);
+						_slots[slot] = id;
+						_keys.insert(_keys.end(), key, key + 3);
+						return id;
+					}
+
+					if (std::memcmp(_keys.data() + size_t{ id } * 3, key, 3 * sizeof(uint32_t)) == 0) {
+						return id;
+					}
+
+					slot = (slot + 1) & _mask;
+				}
+			}
+
+			const Buffer<uint32_t>& keys() const {
+				return _keys;
+			}
+
+		private:
+			static size_t hash(const uint32_t* key) {
+				uint64_t value{ key[0] * 0x9E3779B97F4A7C15ULL };
+				value ^= (key[1] + 0x632BE59BD9B4E019ULL + (value << 6) + (value >> 2)) * 0xC2B2AE3D27D4EB4FULL;
+				value ^= (key[2] + 0x165667B19E3779F9ULL + (value << 6) + (value >> 2)) * 0x9E3779B97F4A7C15ULL;
+				return static_cast<size_t>(value ^ (value >> 29));
+			}
+		};
+
+		static MeshData loadObj(const Path& path, const ImportSettings& settings) {
+			MappedFile file{ path };
+			std::string_view text{ reinterpret_cast<const char*>(file.data()), file.size() };
+
+			Buffer<std::string_view> pieces{ split(text, settings.chunkSize) };
+			Buffer<ObjChunk> chunks(pieces.size());
+
+			parallel(chunks.size(), [&](size_t i) {
+				parseObj(pieces[i], chunks[i]);
+			});
+
+			size_t counts[3]{};
+			Buffer<size_t> bases(chunks.size() * 3);
+
+			for (size_t i{}; i < chunks.size(); ++i) {
+				bases[i * 3] = counts[0];
+				bases[i * 3 + 1] = counts[1];
+				bases[i * 3 + 2] = counts[2];
+
+				counts[0] += chunks[i].positions.size() / 3;
+				counts[1] += chunks[i].uvs.size() / 2;
+				counts[2] += chunks[i].normals.size() / 3;
+			}
+
+			if (counts[0] > missing || counts[1] > missing || counts[2] > missing) {
+				throw std::exception("OBJ file has too many vertices");
+			}
+
+			// Corners are resolved and deduplicated within each chunk first, so the shared
+			// table only sees every chunk's distinct triples.
+			parallel(chunks.size(), [&](size_t i) {
+				ObjChunk& chunk{ chunks[i] };
+				chunk.resolved.resize(chunk.corners.size() * 3);
+
+				for (size_t c{}; c < chunk.corners.size(); ++c) {
+					const ObjCorner& corner{ chunk.corners[c] };
+
+					for (size_t k{}; k < 3; ++k) {
+						uint32_t& target{ chunk.resolved[c * 3 + k] };
+
+						if (!(corner.present & (1 << k))) {
+							target = missing;
+							continue;
+						}
+
+						int64_t index{ corner.index[k] };
+						if (corner.relative & (1 << k)) {
+							index += static_cast<int64_t>(bases[i * 3 + k]);
+						}
+
+						if (index < 0 || static_cast<size_t>(index) >= counts[k]) {
+							throw std::exception("OBJ face index out of range");
+						}
+
+						target = static_cast<uint32_t>(index);
+					}
+				}
+
+				TripleTable table{ chunk.corners.size() };
+				chunk.local.resize(chunk.corners.size());
+
+				for (size_t c{}; c < chunk.corners.size(); ++c) {
+					chunk.local[c] = table.insert(chunk.resolved.data() + c * 3);
+				}
+
+				chunk.keys = table.keys();
+				chunk.resolved = Buffer<uint32_t>{};
+				chunk.corners = Buffer<ObjCorner>{};
+			});
+
+			size_t keyCount{};
+			for (const ObjChunk& chunk : chunks) {
+				keyCount += chunk.keys.size() / 3;
+			}
+
+			TripleTable table{ keyCount };
+			for (ObjChunk& chunk : chunks) {
+				chunk.remap.resize(chunk.keys.size() / 3);
+
+				for (size_t k{}; k < chunk.remap.size(); ++k) {
+					chunk.remap[k] = table.insert(chunk.keys.data() + k * 3);
+				}
+
+				chunk.keys = Buffer<uint32_t>{};
+			}
+
+			Buffer<float> positions;
+			Buffer<float> uvs;
+			Buffer<float> normals;
+			positions.reserve(counts[0] * 3);
+			uvs.reserve(counts[1] * 2);
+			normals.reserve(counts[2] * 3);
+
+			for (const ObjChunk& chunk : chunks) {
+				positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+				uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+				normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+			}
+
+			MeshData data;
+
+			Buffer<size_t> firstCorners(chunks.size() + 1);
+			Buffer<size_t> parts{ 0 };
+
+			for (size_t i{}; i < chunks.size(); ++i) {
+				firstCorners[i + 1] = firstCorners[i] + chunks[i].local.size();
+
+				for (const Part& part : chunks[i].parts) {
+					parts.push_back(firstCorners[i] + part.firstCorner);
+				}
+			}
+
+			// A part only becomes a range once faces follow it.
+			for (size_t i{}; i < parts.size(); ++i) {
+				size_t next{ i + 1 < parts.size() ? parts[i + 1] : firstCorners.back() };
+
+				if (parts[i] < next) {
+					data.ranges.push_back(MeshRange{ static_cast<uint32_t>(parts[i]), 0, Vec3{ 0.0f, 0.0f, 0.0f }, 0.0f });
+				}
+			}
+
+			data.indices.resize(firstCorners.back());
+
+			parallel(chunks.size(), [&](size_t i) {
+				const ObjChunk& chunk{ chunks[i] };
+				uint32_t* target{ data.indices.data() + firstCorners[i] };
+
+				for (size_t c{}; c < chunk.local.size(); ++c) {
+					target[c] = chunk.remap[chunk.local[c]];
+				}
+			});
+
+			const Buffer<uint32_t>& keys{ table.keys() };
+			size_t vertexCount{ keys.size() / 3 };
+
+			data.vertices.resize(vertexCount * stride);
+
+			bool generate{ false };
+			for (size_t v{}; v < vertexCount && !generate; ++v) {
+				generate = keys[v * 3 + 2] == missing;
+			}
+
+			parallel(chunkCount(vertexCount), [&](size_t i) {
+				size_t first{ i * vertexChunk };
+				size_t last{ std::min(first + vertexChunk, vertexCount) };
+
+				for (size_t v{ first }; v < last; ++v) {
+					const uint32_t* key{ keys.data() + v * 3 };
+					float* vertex{ data.vertices.data() + v * stride };
+
+					std::memcpy(vertex, positions.data() + size_t{ key[0] } * 3, 3 * sizeof(float));
+
+					if (key[2] != missing) {
+						std::memcpy(vertex + 3, normals.data() + size_t{ key[2] } * 3, 3 * sizeof(float));
+					}
+
+					if (key[1] != missing) {
+						std::memcpy(vertex + 6, uvs.data() + size_t{ key[1] } * 2, 2 * sizeof(float));
+					}
+				}
+			});
+
+			if (generate) {
+				smoothNormals(data, keys);
+			}
+
+			return data;
+		}
+
+		// Splits text after line breaks into pieces of about size bytes.
+		static Buffer<std::string_view> split(std::string_view text, size_t size) {
+			Buffer<std::string_view> pieces;
+			size = std::max<size_t>(size, 1);
+
+			size_t first{};
+			while (first < text.size()) {
+				size_t last{ std::min(first + size, text.size()) };
+
+				if (last < text.size()) {
+					size_t line{ text.find('\n', last) };
+					last = line == std::string_view::npos ? text.size() : line + 1;
+				}
+
+				pieces.push_back(text.substr(first, last - first));
+				first = last;
+			}
+
+			return pieces;
+		}
+
+		static void parseObj(std::string_view text, ObjChunk& chunk) {
+			const char* current{ text.data() };
+			const char* end{ text.data() + text.size() };
+
+			Buffer<ObjCorner> polygon;
+
+			while (current < end) {
+				const char* lineEnd{ static_cast<const char*>(std::memchr(current, '\n', end - current)) };
+				if (!lineEnd) {
+					lineEnd = end;
+				}
+
+				const char* c{ current };
+				blank(c, lineEnd);
+
+				if (c + 1 < lineEnd && c[0] == 'v' && c[1] == ' ') {
+					read(c + 2, lineEnd, chunk.positions, 3);
+				}
+				else if (c + 2 < lineEnd && c[0] == 'v' && c[1] == 't' && c[2] == ' ') {
+					read(c + 3, lineEnd, chunk.uvs, 2);
+				}
+				else if (c + 2 < lineEnd && c[0] == 'v' && c[1] == 'n' && c[2] == ' ') {
+					read(c + 3, lineEnd, chunk.normals, 3);
+				}
+				else if (c + 1 < lineEnd && c[0] == 'f' && c[1] == ' ') {
+					face(c + 2, lineEnd, chunk, polygon);
+				}
+				else if (keyword(c, lineEnd, "o") || keyword(c, lineEnd, "g") || keyword(c, lineEnd, "usemtl")) {
+					size_t corner{ chunk.corners.size() };
+
+					if (!chunk.parts.empty() && chunk.parts.back().firstCorner == corner) {
+						chunk.parts.pop_back();
+					}
+
+					chunk.parts.push_back(Part{ corner });
+				}
+
+				current = lineEnd + 1;
+			}
+		}
+
+		// Reads count floats; missing ones are zero and extra ones, such as vertex colors, dropped.
+		static void read(const char* c, const char* end, Buffer<float>& target, size_t count) {
+			for (size_t i{}; i < count; ++i) {
+				float value{};
+				blank(c, end);
+
+				if (c < end && *c == '+') {
+					++c;
+				}
+
+				auto [next, error] { std::from_chars(c, end, value) };
+				if (error != std::errc{}) {
+					value = 0.0f;
+				}
+
+				c = next;
+				target.push_back(value);
+			}
+		}
+
+		// Polygons are split into fans.
+		static void face(const char* c, const char* end, ObjChunk& chunk, Buffer<ObjCorner>& polygon) {
+			polygon.clear();
+
+			while (true) {
+				blank(c, end);
+				if (c >= end || *c == '#') {
+					break;
+				}
+
+				ObjCorner corner{};
+				int64_t counts[3]{
+					static_cast<int64_t>(chunk.positions.size() / 3),
+					static_cast<int64_t>(chunk.uvs.size() / 2),
+					static_cast<int64_t>(chunk.normals.size() / 3) };
+
+				for (size_t k{}; k < 3; ++k) {
+					int64_t index{};
+					auto [next, error] { std::from_chars(c, end, index) };
+
+					if (error == std::errc{}) {
+						corner.present |= static_cast<uint8_t>(1 << k);
+
+						if (index < 0) {
+							corner.index[k] = counts[k] + index;
+							corner.relative |= static_cast<uint8_t>(1 << k);
+						}
+						else {
+							corner.index[k] = index - 1;
+						}
+					}
+
+					c = next;
+					if (c >= end || *c != '/') {
+						break;
+					}
+
+					++c;
+				}
+
+				if (!(corner.present & 1)) {
+					throw std::exception("OBJ face without position");
+				}
+
+				while (c < end && *c != ' ' && *c != '\t' && *c != '\r') {
+					++c;
+				}
+
+				polygon.push_back(corner);
+			}
+
+			for (size_t i{ 2 }; i < polygon.size(); ++i) {
+				chunk.corners.push_back(polygon[0]);
+				chunk.corners.push_back(polygon[i - 1]);
+				chunk.corners.push_back(polygon[i]);
+			}
+		}
+
+		static bool keyword(const char* c, const char* end, std::string_view word) {
+			size_t length{ word.size() };
+
+			return static_cast<size_t>(end - c) > length &&
+				std::string_view{ c, length } == word &&
+				(c[length] == ' ' || c[length] == '\t' || c[length] == '\r');
+		}
+
+		static void blank(const char*& c, const char* end) {
+			while (c < end && (*c == ' ' || *c == '\t' || *c == '\r')) {
+				++c;
+			}
+		}
+
+		// Area weighted normals shared by every vertex at the same file position.
+		static void smoothNormals(MeshData& data, const Buffer<uint32_t>& keys) {
+			uint32_t positionCount{};
+			for (size_t v{}; v < keys.size() / 3; ++v) {
+				positionCount = std::max(positionCount, keys[v * 3] + 1);
+			}
+
+			Buffer<Vec3> sums(positionCount, Vec3{ 0.0f, 0.0f, 0.0f });
+
+			for (size_t t{}; t + 2 < data.indices.size(); t += 3) {
+				Vec3 corners[3];
+				for (size_t k{}; k < 3; ++k) {
+					const float* vertex{ data.vertices.data() + size_t{ data.indices[t + k] } * stride };
+					corners[k] = Vec3{ vertex[0], vertex[1], vertex[2] };
+				}
+
+				Vec3 normal{ (corners[1] - corners[0]).cross(corners[2] - corners[0]) };
+
+				for (size_t k{}; k < 3; ++k) {
+					sums[keys[size_t{ data.indices[t + k] } * 3]] += normal;
+				}
+			}
+
+			for (size_t v{}; v < keys.size() / 3; ++v) {
+				if (keys[v * 3 + 2] != missing) {
+					continue;
+				}
+
+				Vec3 normal{ sums[keys[v * 3]].normalized() };
+				float* vertex{ data.vertices.data() + v * stride };
+
+				vertex[3] = normal.x;
+				vertex[4] = normal.y;
+				vertex[5] = normal.z;
+			}
+		}
+
+		struct GltfFile {
+			JsonValue document;
+			Buffer<std::span<const uint8_t>> buffers;
+
+			std::shared_ptr<MappedFile> file;
+			Buffer<std::unique_ptr<MappedFile>> external;
+			Buffer<Buffer<uint8_t>> decoded;
+		};
+
+		struct GltfPrimitive {
+			const JsonValue* primitive{};
+			Mat4 transform;
+
+			Buffer<float> vertices;
+			Buffer<uint32_t> indices;
+		};
+
+		static MeshData loadGltf(const Path& path) {
+			GltfFile gltf{ openGltf(path) };
+			const JsonValue& document{ gltf.document };
+
+			for (const JsonValue& extension : document["extensionsRequired"].items) {
+				if (extension.string == "KHR_draco_mesh_compression" || extension.string == "EXT_meshopt_compression") {
+					throw std::exception("Compressed glTF meshes are not supported");
+				}
+			}
+
+			Buffer<GltfPrimitive> primitives;
+
+			auto visit = [&](const auto& self, size_t node, const Mat4& parent, size_t depth) -> void {
+				const JsonValue& value{ document["nodes"][node] };
+				if (value.isNull() || depth > document["nodes"].size()) {
+					throw std::exception("Invalid glTF node");
+				}
+
+				Mat4 transform{ parent * local(value) };
+
+				if (value.has("mesh")) {
+					for (const JsonValue& primitive : document["meshes"][index(value["mesh"])]["primitives"].items) {
+						primitives.push_back(GltfPrimitive{ &primitive, transform, {}, {} });
+					}
+				}
+
+				for (const JsonValue& child : value["children"].items) {
+					self(self, index(child), transform, depth + 1);
+				}
+			};
+
+			const JsonValue& scenes{ document["scenes"] };
+
+			if (scenes.size()) {
+				const JsonValue& scene{ scenes[static_cast<size_t>(document.value("scene", 0.0))] };
+
+				for (const JsonValue& node : scene["nodes"].items) {
+					visit(visit, index(node), Mat4::identity(), 0);
+				}
+			}
+			else {
+				for (const JsonValue& mesh : document["meshes"].items) {
+					for (const JsonValue& primitive : mesh["primitives"].items) {
+						primitives.push_back(GltfPrimitive{ &primitive, Mat4::identity(), {}, {} });
+					}
+				}
+			}
+
+			parallel(primitives.size(), [&](size_t i) {
+				readPrimitive(gltf, primitives[i]);
+			});
+
+			MeshData data;
+
+			size_t vertexCount{};
+			size_t indexCount{};
+			for (const GltfPrimitive& primitive : primitives) {
+				vertexCount += primitive.vertices.size() / stride;
+				indexCount += primitive.indices.size();
+			}
+
+			if (vertexCount > missing) {
+				throw std::exception("glTF file has too many vertices");
+			}
+
+			data.vertices.reserve(vertexCount * stride);
+			data.indices.reserve(indexCount);
+
+			for (const GltfPrimitive& primitive : primitives) {
+				if (primitive.indices.empty()) {
+					continue;
+				}
+
+				uint32_t base{ static_cast<uint32_t>(data.vertices.size() / stride) };
+
+				data.ranges.push_back(MeshRange{
+					static_cast<uint32_t>(data.indices.size()),
+					static_cast<uint32_t>(primitive.indices.size()),
+					Vec3{ 0.0f, 0.0f, 0.0f },
+					0.0f });
+
+				data.vertices.insert(data.vertices.end(), primitive.vertices.begin(), primitive.vertices.end());
+
+				for (uint32_t index : primitive.indices) {
+					data.indices.push_back(base + index);
+				}
+			}
+
+			return data;
+		}
+
+		static GltfFile openGltf(const Path& path) {
+			constexpr uint32_t magic{ 0x46546C67 };
+			constexpr uint32_t jsonChunk{ 0x4E4F534A };
+			constexpr uint32_t binaryChunk{ 0x004E4942 };
+
+			GltfFile gltf;
+			gltf.file = std::make_shared<MappedFile>(path);
+
+			std::span<const uint8_t> bytes{ gltf.file->bytes() };
+			std::string_view json{ reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+			std::span<const uint8_t> binary;
+
+			if (bytes.size() >= 12 && load<uint32_t>(bytes.data()) == magic) {
+				size_t length{ std::min<size_t>(load<uint32_t>(bytes.data() + 8), bytes.size()) };
+				json = {};
+
+				for (size_t offset{ 12 }; offset + 8 <= length;) {
+					size_t size{ load<uint32_t>(bytes.data() + offset) };
+					uint32_t type{ load<uint32_t>(bytes.data() + offset + 4) };
+
+					if (size > length - offset - 8) {
+						throw std::exception("Truncated glTF binary chunk");
+					}
+
+					if (type == jsonChunk && json.empty()) {
+						json = std::string_view{ reinterpret_cast<const char*>(bytes.data() + offset + 8), size };
+					}
+					else if (type == binaryChunk && binary.empty()) {
+						binary = bytes.subspan(offset + 8, size);
+					}
+
+					offset += 8 + ((size + 3) & ~size_t{ 3 });
+				}
+			}
+
+			gltf.document = Json::parse(json);
+
+			for (const JsonValue& buffer : gltf.document["buffers"].items) {
+				const JsonValue* uri{ buffer.find("uri") };
+
+				if (!uri) {
+					gltf.buffers.push_back(binary);
+					continue;
+				}
+
+				std::string_view source{ uri->string };
+
+				if (source.starts_with("data:")) {
+					size_t comma{ source.find(";base64,") };
+					if (comma == std::string_view::npos) {
+						throw std::exception("Unsupported glTF data URI");
+					}
+
+					gltf.decoded.push_back(base64(source.substr(comma + 8)));
+					gltf.buffers.push_back(gltf.decoded.back());
+					continue;
+				}
+
+				gltf.external.push_back(std::make_unique<MappedFile>(path.parent_path() / unescape(source)));
+				gltf.buffers.push_back(gltf.external.back()->bytes());
+			}
+
+			return gltf;
+		}
+
+		static void readPrimitive(const GltfFile& gltf, GltfPrimitive& target) {
+			constexpr uint32_t triangles{ 4 };
+			constexpr uint32_t strip{ 5 };
+			constexpr uint32_t fan{ 6 };
+
+			const JsonValue& primitive{ *target.primitive };
+			const JsonValue& attributes{ primitive["attributes"] };
+
+			uint32_t mode{ static_cast<uint32_t>(primitive.value("mode", triangles)) };
+			if ((mode != triangles && mode != strip && mode != fan) || !attributes.has("POSITION")) {
+				return;
+			}
+
+			Buffer<float> positions{ readAccessor<float>(gltf, index(attributes["POSITION"]), 3) };
+			size_t count{ positions.size() / 3 };
+
+			Buffer<float> normals;
+			if (attributes.has("NORMAL")) {
+				normals = readAccessor<float>(gltf, index(attributes["NORMAL"]), 3);
+			}
+
+			Buffer<float> uvs;
+			if (attributes.has("TEXCOORD_0")) {
+				uvs = readAccessor<float>(gltf, index(attributes["TEXCOORD_0"]), 2);
+			}
+
+			Buffer<uint32_t> indices;
+			if (primitive.has("indices")) {
+				indices = readAccessor<uint32_t>(gltf, index(primitive["indices"]), 1);
+			}
+			else {
+				indices.resize(count);
+				for (size_t i{}; i < count; ++i) {
+					indices[i] = static_cast<uint32_t>(i);
+				}
+			}
+
+			indices = triangulate(indices, mode);
+
+			for (uint32_t index : indices) {
+				if (index >= count) {
+					throw std::exception("glTF index out of range");
+				}
+			}
+
+			const Mat4& transform{ target.transform };
+			Mat4 normalTransform{ transform.inverse().transposed() };
+
+			bool mirrored{ transform.determinant() < 0.0f };
+			if (mirrored) {
+				for (size_t t{}; t + 2 < indices.size(); t += 3) {
+					std::swap(indices[t + 1], indices[t + 2]);
+				}
+			}
+
+			Buffer<float> vertices(count * stride);
+
+			for (size_t v{}; v < count; ++v) {
+				float* vertex{ vertices.data() + v * stride };
+
+				Vec4 position{ transform * Vec4{ positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2], 1.0f } };
+				vertex[0] = position.x;
+				vertex[1] = position.y;
+				vertex[2] = position.z;
+
+				if (v * 3 + 2 < normals.size()) {
+					Vec4 normal{ normalTransform * Vec4{ normals[v * 3], normals[v * 3 + 1], normals[v * 3 + 2], 0.0f } };
+					Vec3 unit{ Vec3{ normal.x, normal.y, normal.z }.normalized() };
+
+					vertex[3] = unit.x;
+					vertex[4] = unit.y;
+					vertex[5] = unit.z;
+				}
+
+				if (v * 2 + 1 < uvs.size()) {
+					vertex[6] = uvs[v * 2];
+					vertex[7] = uvs[v * 2 + 1];
+				}
+			}
+
+			if (normals.size() < count * 3) {
+				flatNormals(vertices, indices);
+			}
+
+			target.vertices = std::move(vertices);
+			target.indices = std::move(indices);
+		}
+
+		static Buffer<uint32_t> triangulate(const Buffer<uint32_t>& indices, uint32_t mode) {
+			if (mode == 4) {
+				Buffer<uint32_t> result{ indices };
+				result.resize(result.size() - result.size() % 3);
+				return result;
+			}
+
+			Buffer<uint32_t> result;
+			for (size_t i{ 2 }; i < indices.size(); ++i) {
+				if (mode == 6) {
+					result.insert(result.end(), { indices[0], indices[i - 1], indices[i] });
+				}
+				else if (i % 2 == 0) {
+					result.insert(result.end(), { indices[i - 2], indices[i - 1], indices[i] });
+				}
+				else {
+					result.insert(result.end(), { indices[i - 1], indices[i - 2], indices[i] });
+				}
+			}
+
+			return result;
+		}
+
+		// Gives every triangle its own vertices with the face normal.
+		static void flatNormals(Buffer<float>& vertices, Buffer<uint32_t>& indices) {
+			Buffer<float> result(indices.size() * stride);
+
+			for (size_t t{}; t + 2 < indices.size(); t += 3) {
+				Vec3 corners[3];
+				for (size_t k{}; k < 3; ++k) {
+					const float* source{ vertices.data() + size_t{ indices[t + k] } * stride };
+					std::memcpy(result.data() + (t + k) * stride, source, stride * sizeof(float));
+					corners[k] = Vec3{ source[0], source[1], source[2] };
+				}
+
+				Vec3 normal{ (corners[1] - corners[0]).cross(corners[2] - corners[0]).normalized() };
+
+				for (size_t k{}; k < 3; ++k) {
+					float* vertex{ result.data() + (t + k) * stride };
+					vertex[3] = normal.x;
+					vertex[4] = normal.y;
+					vertex[5] = normal.z;
+
+					indices[t + k] = static_cast<uint32_t>(t + k);
+				}
+			}
+
+			vertices = std::move(result);
+		}
+
+		// Reads an accessor as floats, applying normalization, or as indices. Sparse accessors
+		// are not supported.
+		template<typename Value>
+		static Buffer<Value> readAccessor(const GltfFile& gltf, size_t accessorIndex, size_t components) {
+			constexpr bool scalar{ std::is_same_v<Value, uint32_t> };
+
+			const JsonValue& document{ gltf.document };
+			const JsonValue& accessor{ document["accessors"][accessorIndex] };
+
+			if (accessor.isNull() || accessor.has("sparse")) {
+				throw std::exception("Unsupported glTF accessor");
+			}
+
+			static constexpr std::pair<std::string_view, size_t> types[]{
+				{ "SCALAR", 1 }, { "VEC2", 2 }, { "VEC3", 3 }, { "VEC4", 4 }
+			};
+
+			size_t width{};
+			for (const auto& [name, size] : types) {
+				if (accessor["type"].string == name) {
+					width = size;
+				}
+			}
+
+			if (!width || (scalar && width != 1) || (!scalar && width < components)) {
+				throw std::exception("Unexpected glTF accessor type");
+			}
+
+			uint32_t componentType{ static_cast<uint32_t>(accessor.value("componentType", 0)) };
+			size_t componentSize{ gltfComponentSize(componentType) };
+			bool normalized{ accessor["normalized"].boolean };
+
+			size_t count{ static_cast<size_t>(accessor.value("count", 0)) };
+			Buffer<Value> result(count * components);
+
+			if (!accessor.has("bufferView")) {
+				return result;
+			}
+
+			const JsonValue& view{ document["bufferViews"][index(accessor["bufferView"])] };
+			size_t bufferIndex{ index(view["buffer"]) };
+
+			if (view.isNull() || bufferIndex >= gltf.buffers.size()) {
+				throw std::exception("Invalid glTF buffer view");
+			}
+
+			std::span<const uint8_t> buffer{ gltf.buffers[bufferIndex] };
+
+			size_t elementSize{ width * componentSize };
+			size_t elementStride{ static_cast<size_t>(view.value("byteStride", 0.0)) };
+			if (!elementStride) {
+				elementStride = elementSize;
+			}
+
+			size_t offset{ static_cast<size_t>(view.value("byteOffset", 0.0) + accessor.value("byteOffset", 0.0)) };
+			size_t viewEnd{ static_cast<size_t>(view.value("byteOffset", 0.0) + view.value("byteLength", 0.0)) };
+
+			if (count && (viewEnd > buffer.size() || offset + (count - 1) * elementStride + elementSize > viewEnd)) {
+				throw std::exception("glTF accessor outside of its buffer");
+			}
+
+			for (size_t i{}; i < count; ++i) {
+				const uint8_t* element{ buffer.data() + offset + i * elementStride };
+
+				for (size_t c{}; c < components; ++c) {
+					if constexpr (scalar) {
+						result[i * components + c] = gltfIndex(element + c * componentSize, componentType);
+					}
+					else {
+						result[i * components + c] = gltfComponent(element + c * componentSize, componentType, normalized);
+					}
+				}
+			}
+
+			return result;
+		}
+
+		static size_t gltfComponentSize(uint32_t type) {
+			switch (type) {
+			case 5120:
+			case 5121:
+				return 1;
+			case 5122:
+			case 5123:
+				return 2;
+			case 5125:
+			case 5126:
+				return 4;
+			default:
+				throw std::exception("Unsupported glTF component type");
+			}
+		}
+
+		static uint32_t gltfIndex(const uint8_t* source, uint32_t type) {
+			switch (type) {
+			case 5121:
+				return load<uint8_t>(source);
+			case 5123:
+				return load<uint16_t>(source);
+			case 5125:
+				return load<uint32_t>(source);
+			default:
+				throw std::exception("Unsupported glTF index type");
+			}
+		}
+
+		static float gltfComponent(const uint8_t* source, uint32_t type, bool normalized) {
+			switch (type) {
+			case 5120: {
+				float value{ static_cast<float>(load<int8_t>(source)) };
+				return normalized ? std::max(value / 127.0f, -1.0f) : value;
+			}
+			case 5121: {
+				float value{ static_cast<float>(load<uint8_t>(source)) };
+				return normalized ? value / 255.0f : value;
+			}
+			case 5122: {
+				float value{ static_cast<float>(load<int16_t>(source)) };
+				return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+			}
+			case 5123: {
+				float value{ static_cast<float>(load<uint16_t>(source)) };
+				return normalized ? value / 65535.0f : value;
+			}
+			case 5125:
+				return static_cast<float>(load<uint32_t>(source));
+			default:
+				return load<float>(source);
+			}
+		}
+
+		// Node matrix, or translation * rotation * scale.
+		static Mat4 local(const JsonValue& node) {
+			Mat4 result{ Mat4::identity() };
+
+			const JsonValue& matrix{ node["matrix"] };
+			if (matrix.size() == 16) {
+				for (size_t i{}; i < 16; ++i) {
+					result.data[i] = static_cast<float>(matrix[i].number);
+				}
+
+				return result;
+			}
+
+			auto vector = [&node](std::string_view key, size_t index, float fallback) {
+				const JsonValue& value{ node[key][index] };
+				return value.type == JsonType::NUMBER ? static_cast<float>(value.number) : fallback;
+			};
+
+			float x{ vector("rotation", 0, 0.0f) };
+			float y{ vector("rotation", 1, 0.0f) };
+			float z{ vector("rotation", 2, 0.0f) };
+			float w{ vector("rotation", 3, 1.0f) };
+
+			float rotation[3][3]{
+				{ 1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w) },
+				{ 2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w) },
+				{ 2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y) }
+			};
+
+			for (size_t column{}; column < 3; ++column) {
+				float scale{ vector("scale", column, 1.0f) };
+
+				for (size_t row{}; row < 3; ++row) {
+					result(row, column) = rotation[row][column] * scale;
+				}
+
+				result(column, 3) = vector("translation", column, 0.0f);
+			}
+
+			return result;
+		}
+
+		static size_t index(const JsonValue& value) {
+			if (value.type != JsonType::NUMBER || value.number < 0.0) {
+				throw std::exception("Invalid glTF index");
+			}
+
+			return static_cast<size_t>(value.number);
+		}
+
+		static Buffer<uint8_t> base64(std::string_view text) {
+			Buffer<uint8_t> result;
+			result.reserve(text.size() / 4 * 3);
+
+			uint32_t bits{};
+			int count{};
+
+			for (char c : text) {
+				int value{ -1 };
+
+				if (c >= 'A' && c <= 'Z') {
+					value = c - 'A';
+				}
+				else if (c >= 'a' && c <= 'z') {
+					value = c - 'a' + 26;
+				}
+				else if (c >= '0' && c <= '9') {
+					value = c - '0' + 52;
+				}
+				else if (c == '+') {
+					value = 62;
+				}
+				else if (c == '/') {
+					value = 63;
+				}
+
+				if (value < 0) {
+					continue;
+				}
+
+				bits = (bits << 6) | static_cast<uint32_t>(value);
+				count += 6;
+
+				if (count >= 8) {
+					count -= 8;
+					result.push_back(static_cast<uint8_t>(bits >> count));
+				}
+			}
+
+			return result;
+		}
+
+		// Decodes percent escapes in relative URIs.
+		static std::string unescape(std::string_view uri) {
+			std::string result;
+
+			for (size_t i{}; i < uri.size(); ++i) {
+				uint32_t code{};
+
+				if (uri[i] == '%' && i + 2 < uri.size() &&
+					std::from_chars(uri.data() + i + 1, uri.data() + i + 3, code, 16).ptr == uri.data() + i + 3) {
+					result += static_cast<char>(code);
+					i += 2;
+				}
+				else {
+					result += uri[i];
+				}
+			}
+
+			return result;
+		}
+
+		template<typename Type>
+		static Type load(const uint8_t* source) {
+			Type value;
+			std::memcpy(&value, source, sizeof(Type));
+			return value;
+		}
+
+		// Bounds of every range and of the whole mesh, then the settings.
+		static void finish(MeshData& data, const ImportSettings& settings) {
+			data.mode = settings.mode;
+			data.vertexLayout = { 3, 3, 2 };
+
+			for (size_t i{}; i < data.ranges.size(); ++i) {
+				size_t last{ i + 1 < data.ranges.size() ? data.ranges[i + 1].firstIndex : data.indices.size() };
+				data.ranges[i].indexCount = static_cast<uint32_t>(last - data.ranges[i].firstIndex);
+			}
+
+			if (data.ranges.size() < 2) {
+				data.ranges.clear();
+			}
+
+			parallel(data.ranges.size(), [&data](size_t i) {
+				MeshRange& range{ data.ranges[i] };
+				bound(data, range.firstIndex, range.indexCount, range.center, range.radius);
+			});
+
+			data.bounds = MeshBounds::compute(data.vertices.data(), data.vertices.size() / stride, stride);
+
+			if (settings.lods) {
+				MeshSimplifier::buildLods(data);
+			}
+
+			if (settings.quantize) {
+				MeshBuilder::quantize(data);
+			}
+		}
+
+		// Center of the box around the referenced vertices and the sphere around it.
+		static void bound(const MeshData& data, size_t first, size_t count, Vec3& center, float& radius) {
+			constexpr float limit{ std::numeric_limits<float>::max() };
+
+			Vec3 min{ limit, limit, limit };
+			Vec3 max{ -limit, -limit, -limit };
+
+			auto position = [&data](uint32_t index) {
+				const float* vertex{ data.vertices.data() + size_t{ index } * stride };
+				return Vec3{ vertex[0], vertex[1], vertex[2] };
+			};
+
+			for (size_t i{ first }; i < first + count; ++i) {
+				Vec3 point{ position(data.indices[i]) };
+
+				min = Vec3{ std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z) };
+				max = Vec3{ std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z) };
+			}
+
+			center = count ? (min + max) * 0.5f : Vec3{ 0.0f, 0.0f, 0.0f };
+
+			radius = 0.0f;
+			for (size_t i{ first }; i < first + count; ++i) {
+				radius = std::max(radius, (position(data.indices[i]) - center).length());
+			}
+		}
+
+		static constexpr size_t vertexChunk{ size_t{ 1 } << 16 };
+
+		// JobSystem::parallelFor that hands the first exception of any job back to the caller.
+		template<typename Job>
+		static void parallel(size_t count, const Job& job) {
+			std::mutex mutex;
+			std::exception_ptr error;
+
+			JobSystem::shared().parallelFor(count, [&](size_t i) {
+				try {
+					job(i);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> lock{ mutex };
+					if (!error) {
+						error = std::current_exception();
+					}
+				}
+			});
+
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+
+		static size_t chunkCount(size_t count) {
+			return (count + vertexChunk - 1) / vertexChunk;
+		}
+	};
+
+}
@@ -0,0 +1,401 @@
+#pragma once
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "core/core_types.h"
+#include "core/mesh.h"
+
+namespace Byte {
+
+	struct MeshStatistics {
+		size_t vertexCount{};
+		size_t triangleCount{};
+
+		// Vertices transformed per triangle and per vertex with a FIFO post-transform cache.
+		float acmr{};
+		float atvr{};
+	};
+
+	// Reorders and compacts triangle list meshes before they are uploaded: welds identical
+	// vertices, orders triangles for the post-transform vertex cache (Tipsify), sorts the
+	// resulting clusters so outward facing ones draw first, and renumbers vertices in the order
+	// they are first used so vertex fetch walks memory forward. Triangles never leave the range
+	// they belong to, so ranges stay valid.
+	struct MeshOptimizer {
+		static constexpr size_t cacheSize{ 16 };
+
+		struct Report {
+			MeshStatistics before;
+			MeshStatistics after;
+		};
+
+		static Report optimize(MeshData& data) {
+			Report report{};
+			report.before = analyze(data);
+
+			weld(data);
+
+			size_t count{ vertexCount(data) };
+
+			if (data.ranges.empty()) {
+				Buffer<uint32_t> clusters{ optimizeVertexCache(data.indices, count) };
+				optimizeOverdraw(data, data.indices, clusters);
+			}
+
+			for (const MeshRange& range : data.ranges) {
+				auto first{ data.indices.begin() + range.firstIndex };
+				Buffer<uint32_t> indices{ first, first + range.indexCount };
+
+				Buffer<uint32_t> clusters{ optimizeVertexCache(indices, count) };
+				optimizeOverdraw(data, indices, clusters);
+
+				std::copy(indices.begin(), indices.end(), first);
+			}
+
+			for (MeshLod& lod : data.lods) {
+				optimizeVertexCache(lod.indices, count);
+			}
+
+			optimizeVertexFetch(data);
+
+			report.after = analyze(data);
+			return report;
+		}
+
+		// Merges vertices whose attributes are bitwise equal. Returns how many were removed.
+		static size_t weld(MeshData& data) {
+			size_t stride{ vertexSize(data.vertexLayout) };
+			size_t count{ vertexCount(data) };
+
+			Buffer<float> vertices;
+			vertices.reserve(data.vertices.size());
+
+			Buffer<uint32_t> remap(count);
+			std::unordered_multimap<uint64_t, uint32_t> unique;
+			unique.reserve(count);
+
+			for (size_t i{}; i < count; ++i) {
+				const float* vertex{ data.vertices.data() + i * stride };
+				uint64_t key{ hash(vertex, stride) };
+
+				uint32_t index{ static_cast<uint32_t>(vertices.size() / stride) };
+
+				auto [first, last] { unique.equal_range(key) };
+				for (auto it{ first }; it != last; ++it) {
+					if (std::memcmp(vertices.data() + it->second * stride, vertex, stride * sizeof(float)) == 0) {
+						index = it->second;
+						break;
+					}
+				}
+
+				if (index == vertices.size() / stride) {
+					unique.emplace(key, index);
+					vertices.insert(vertices.end(), vertex, vertex + stride);
+				}
+
+				remap[i] = index;
+			}
+
+			for (uint32_t& index : data.indices) {
+				index = remap[index];
+			}
+
+			for (MeshLod& lod : data.lods) {
+				for (uint32_t& index : lod.indices) {
+					index = remap[index];
+				}
+			}
+
+			size_t removed{ count - vertices.size() / stride };
+			data.vertices = std::move(vertices);
+			data.packed = PackedVertices{};
+
+			return removed;
+		}
+
+		// Tipsify: fans around the most recently cached vertex that still has triangles left, and
+		// jumps to a dead-end vertex when none fits the cache. Returns the first triangle of each
+		// cluster, where a jump broke the locality.
+		static Buffer<uint32_t> optimizeVertexCache(Buffer<uint32_t>& indices, size_t vertexCount, size_t cache = cacheSize) {
+			size_t triangleCount{ indices.size() / 3 };
+			Buffer<uint32_t> clusters;
+
+			if (!triangleCount || !vertexCount) {
+				return clusters;
+			}
+
+			Buffer<uint32_t> live(vertexCount);
+			for (size_t i{}; i < triangleCount * 3; ++i) {
+				++live[indices[i]];
+			}
+
+			Buffer<uint32_t> offsets(vertexCount + 1);
+			for (size_t v{}; v < vertexCount; ++v) {
+				offsets[v + 1] = offsets[v] + live[v];
+			}
+
+			Buffer<uint32_t> adjacency(offsets.back());
+			Buffer<uint32_t> fill{ offsets.begin(), offsets.end() - 1 };
+			for (size_t t{}; t < triangleCount; ++t) {
+				for (size_t k{}; k < 3; ++k) {
+					adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+				}
+			}
+
+			Buffer<uint32_t> timestamps(vertexCount);
+			Buffer<uint8_t> emitted(triangleCount);
+			Buffer<uint32_t> deadEnds;
+			Buffer<uint32_t> candidates;
+
+			Buffer<uint32_t> result;
+			result.reserve(triangleCount * 3);
+
+			uint32_t time{ static_cast<uint32_t>(cache) + 1 };
+			size_t cursor{};
+			int64_t fan{};
+
+			clusters.push_back(0);
+
+			while (fan >= 0) {
+				candidates.clear();
+
+				for (uint32_t i{ offsets[fan] }; i < offsets[fan + 1]; ++i) {
+					uint32_t t{ adjacency[i] };
+					if (emitted[t]) {
+						continue;
+					}
+
+					for (size_t k{}; k < 3; ++k) {
+						uint32_t v{ indices[t * 3 + k] };
+
+						result.push_back(v);
+						deadEnds.push_back(v);
+						candidates.push_back(v);
+						--live[v];
+
+						if (time - timestamps[v] > cache) {
+							timestamps[v] = time++;
+						}
+					}
+
+					emitted[t] = 1;
+				}
+
+				fan = -1;
+				int64_t best{ -1 };
+
+				for (uint32_t v : candidates) {
+					if (!live[v]) {
+						continue;
+					}
+
+					int64_t priority{};
+					if (time - timestamps[v] + 2 * live[v] <= cache) {
+						priority = time - timestamps[v];
+					}
+
+					if (priority > best) {
+						best = priority;
+						fan = v;
+					}
+				}
+
+				if (fan >= 0) {
+					continue;
+				}
+
+				while (!deadEnds.empty() && fan < 0) {
+					uint32_t v{ deadEnds.back() };
+					deadEnds.pop_back();
+
+					if (live[v]) {
+						fan = v;
+					}
+				}
+
+				for (; cursor < vertexCount && fan < 0; ++cursor) {
+					if (live[cursor]) {
+						fan = static_cast<int64_t>(cursor);
+					}
+				}
+
+				if (fan >= 0 && result.size() < triangleCount * 3) {
+					clusters.push_back(static_cast<uint32_t>(result.size() / 3));
+				}
+			}
+
+			std::copy(result.begin(), result.end(), indices.begin());
+			return clusters;
+		}
+
+		// Draws clusters of indices whose faces point away from their center first, so they
+		// cover what lies behind them. Needs positions as the first attribute.
+		static void optimizeOverdraw(const MeshData& data, Buffer<uint32_t>& indices, const Buffer<uint32_t>& clusters) {
+			size_t triangleCount{ indices.size() / 3 };
+
+			if (clusters.size() < 2 || data.vertexLayout.empty() || data.vertexLayout[0] != 3) {
+				return;
+			}
+
+			size_t stride{ vertexSize(data.vertexLayout) };
+			auto position = [&data, stride](uint32_t index) {
+				const float* vertex{ data.vertices.data() + index * stride };
+				return Vec3{ vertex[0], vertex[1], vertex[2] };
+			};
+
+			struct Cluster {
+				uint32_t first{};
+				uint32_t last{};
+				float order{};
+			};
+
+			Buffer<Cluster> sorted(clusters.size());
+			Vec3 meshCenter{};
+			float meshArea{};
+
+			for (size_t c{}; c < clusters.size(); ++c) {
+				Cluster& cluster{ sorted[c] };
+				cluster.first = clusters[c];
+				cluster.last = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<uint32_t>(triangleCount);
+			}
+
+			Buffer<Vec3> centers(sorted.size());
+			Buffer<Vec3> normals(sorted.size());
+
+			for (size_t c{}; c < sorted.size(); ++c) {
+				float area{};
+
+				for (uint32_t t{ sorted[c].first }; t < sorted[c].last; ++t) {
+					Vec3 a{ position(indices[t * 3]) };
+					Vec3 b{ position(indices[t * 3 + 1]) };
+					Vec3 d{ position(indices[t * 3 + 2]) };
+
+					Vec3 normal{ (b - a).cross(d - a) };
+					float weight{ normal.length() * 0.5f };
+
+					centers[c] += (a + b + d) * (weight / 3.0f);
+					normals[c] += normal;
+					area += weight;
+				}
+
+				meshCenter += centers[c];
+				meshArea += area;
+
+				if (area > 0.0f) {
+					centers[c] /= area;
+				}
+			}
+
+			if (meshArea > 0.0f) {
+				meshCenter /= meshArea;
+			}
+
+			for (size_t c{}; c < sorted.size(); ++c) {
+				float length{ normals[c].length() };
+				sorted[c].order = length > 0.0f ? (centers[c] - meshCenter).dot(normals[c] / length) : 0.0f;
+			}
+
+			std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& left, const Cluster& right) {
+				return left.order > right.order;
+			});
+
+			Buffer<uint32_t> ordered;
+			ordered.reserve(indices.size());
+
+			for (const Cluster& cluster : sorted) {
+				ordered.insert(ordered.end(), indices.begin() + cluster.first * 3, indices.begin() + cluster.last * 3);
+			}
+
+			indices = std::move(ordered);
+		}
+
+		// Renumbers vertices in the order the indices first use them and drops unused ones.
+		static void optimizeVertexFetch(MeshData& data) {
+			size_t stride{ vertexSize(data.vertexLayout) };
+
+			Buffer<uint32_t> remap(vertexCount(data), UINT32_MAX);
+			Buffer<float> vertices;
+			vertices.reserve(data.vertices.size());
+
+			auto renumber = [&](Buffer<uint32_t>& indices) {
+				for (uint32_t& index : indices) {
+					if (remap[index] == UINT32_MAX) {
+						remap[index] = static_cast<uint32_t>(vertices.size() / stride);
+
+						const float* vertex{ data.vertices.data() + index * stride };
+						vertices.insert(vertices.end(), vertex, vertex + stride);
+					}
+
+					index = remap[index];
+				}
+			};
+
+			renumber(data.indices);
+			for (MeshLod& lod : data.lods) {
+				renumber(lod.indices);
+			}
+
+			data.vertices = std::move(vertices);
+			data.packed = PackedVertices{};
+		}
+
+		static MeshStatistics analyze(const MeshData& data, size_t cache = cacheSize) {
+			MeshStatistics statistics{};
+			statistics.vertexCount = vertexCount(data);
+			statistics.triangleCount = data.indices.size() / 3;
+
+			if (!statistics.triangleCount || !statistics.vertexCount) {
+				return statistics;
+			}
+
+			Buffer<uint32_t> timestamps(statistics.vertexCount);
+			uint32_t time{ static_cast<uint32_t>(cache) + 1 };
+			size_t transformed{};
+
+			for (size_t i{}; i < statistics.triangleCount * 3; ++i) {
+				uint32_t v{ data.indices[i] };
+
+				if (time - timestamps[v] > cache) {
+					timestamps[v] = time++;
+					++transformed;
+				}
+			}
+
+			statistics.acmr = static_cast<float>(transformed) / statistics.triangleCount;
+			statistics.atvr = static_cast<float>(transformed) / statistics.vertexCount;
+
+			return statistics;
+		}
+
+	private:
+		static size_t vertexCount(const MeshData& data) {
+			size_t stride{ vertexSize(data.vertexLayout) };
+			return stride ? data.vertices.size() / stride : 0;
+		}
+
+		static size_t vertexSize(const Buffer<uint8_t>& layout) {
+			size_t size{};
+			for (uint8_t count : layout) {
+				size += count;
+			}
+
+			return size;
+		}
+
+		static uint64_t hash(const float* vertex, size_t stride) {
+			uint64_t value{ 14695981039346656037ULL };
+
+			const uint8_t* bytes{ reinterpret_cast<const uint8_t*>(vertex) };
+			for (size_t i{}; i < stride * sizeof(float); ++i) {
+				value ^= bytes[i];
+				value *= 1099511628211ULL;
+			}
+
+			return value;
+		}
+	};
+
+}
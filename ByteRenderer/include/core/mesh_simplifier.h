@@ -0,0 +1,496 @@
+#pragma once
+
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "math/vec.h"
+#include "core/core_types.h"
+#include "core/mesh.h"
+#include "core/mesh_optimizer.h"
+
+namespace Byte {
+
+	// Builds coarser index buffers over a mesh's own vertices by quadric edge collapse. Every
+	// collapse moves one vertex onto a neighbour instead of a new position, so all levels share
+	// the vertex buffer. Vertices on open borders or on attribute seams, where several vertices
+	// share a position, stay where they are so the outline and texture mapping hold.
+	struct MeshSimplifier {
+		static constexpr size_t maxLevels{ 6 };
+		static constexpr float levelRatio{ 0.5f };
+
+		// The planes of a mesh's triangles, and for every vertex those of the triangles it stands
+		// in for. Errors are the largest distance to them, unweighted by the triangles' areas so
+		// that a few small triangles moved far are not averaged away.
+		struct Planes {
+			Buffer<Vec4> planes;
+			Buffer<Buffer<uint32_t>> vertices;
+
+			float distance(uint32_t vertex, const Vec3& point) const {
+				float result{};
+				for (uint32_t plane : vertices[vertex]) {
+					const Vec4& p{ planes[plane] };
+					result = std::max(result, std::abs(p.x * point.x + p.y * point.y + p.z * point.z + p.w));
+				}
+
+				return result;
+			}
+
+			void merge(uint32_t from, uint32_t to) {
+				Buffer<uint32_t>& target{ vertices[to] };
+				target.insert(target.end(), vertices[from].begin(), vertices[from].end());
+
+				vertices[from].clear();
+				vertices[from].shrink_to_fit();
+			}
+		};
+
+		// Replaces the mesh's LODs with levels of about ratio times the triangles of the level
+		// before. Stops early once a level barely shrinks. Needs a triangle list. Each level
+		// simplifies the one before, but its error is measured against the mesh's own triangles.
+		static void buildLods(MeshData& data, size_t levels = maxLevels, float ratio = levelRatio) {
+			data.lods.clear();
+
+			Buffer<Vec3> points{ positions(data) };
+			const Buffer<uint32_t>* previous{ &data.indices };
+
+			Planes planes{ originalPlanes(points, data.indices) };
+
+			for (size_t level{}; level < levels; ++level) {
+				size_t target{ static_cast<size_t>(previous->size() / 3 * ratio) * 3 };
+
+				float error{};
+				Buffer<uint32_t> indices{ simplify(points, *previous, target, std::numeric_limits<float>::max(), planes, error) };
+
+				if (indices.empty() || indices.size() * 10 > previous->size() * 9) {
+					break;
+				}
+
+				MeshOptimizer::optimizeVertexCache(indices, points.size());
+
+				float floor{ data.lods.empty() ? 0.0f : data.lods.back().error };
+				data.lods.push_back(MeshLod{ std::move(indices), std::max(error, floor) });
+				previous = &data.lods.back().indices;
+			}
+		}
+
+		// Collapses edges until at most targetIndexCount indices are left or the next collapse
+		// would move the surface by more than maxError. error receives the largest error made.
+		static Buffer<uint32_t> simplify(
+			const Buffer<Vec3>& points,
+			const Buffer<uint32_t>& source,
+			size_t targetIndexCount,
+			float maxError,
+			float& error) {
+			Planes planes{ originalPlanes(points, source) };
+			return simplify(points, source, targetIndexCount, maxError, planes, error);
+		}
+
+		// Collapsed vertices hand their planes on to their targets, so errors of later calls are
+		// still measured against the triangles the planes were taken from.
+		static Buffer<uint32_t> simplify(
+			const Buffer<Vec3>& points,
+			const Buffer<uint32_t>& source,
+			size_t targetIndexCount,
+			float maxError,
+			Planes& planes,
+			float& error) {
+			size_t count{ points.size() };
+
+			Buffer<uint32_t> groups{ positionGroups(points) };
+
+			// Triangles with two corners at one position cover nothing, like the fans at a sphere's poles.
+			Buffer<uint32_t> indices;
+			indices.reserve(source.size());
+
+			for (size_t t{}; t + 2 < source.size(); t += 3) {
+				uint32_t a{ groups[source[t]] };
+				uint32_t b{ groups[source[t + 1]] };
+				uint32_t c{ groups[source[t + 2]] };
+
+				if (a != b && b != c && a != c) {
+					indices.insert(indices.end(), source.begin() + t, source.begin() + t + 3);
+				}
+			}
+
+			Buffer<uint8_t> locked{ lockedVertices(indices, groups) };
+
+			Buffer<Quadric> quadrics(count);
+			for (size_t t{}; t + 2 < indices.size(); t += 3) {
+				Quadric quadric{ Quadric::plane(points[indices[t]], points[indices[t + 1]], points[indices[t + 2]]) };
+
+				for (size_t k{}; k < 3; ++k) {
+					quadrics[indices[t + k]] += quadric;
+				}
+			}
+
+			Buffer<uint32_t> offsets;
+			Buffer<uint32_t> adjacency;
+			Buffer<Collapse> collapses;
+			Buffer<uint32_t> remap(count);
+			Buffer<uint8_t> touched(count);
+
+			error = 0.0f;
+
+			while (indices.size() > targetIndexCount) {
+				buildAdjacency(indices, count, offsets, adjacency);
+
+				collapses.clear();
+				for (size_t t{}; t + 2 < indices.size(); t += 3) {
+					for (size_t k{}; k < 3; ++k) {
+						uint32_t a{ indices[t + k] };
+						uint32_t b{ indices[t + (k + 1) % 3] };
+
+						float forward{ locked[a] ? infinity : (quadrics[a] + quadrics[b]).error(points[b]) };
+						float backward{ locked[b] ? infinity : (quadrics[a] + quadrics[b]).error(points[a]) };
+
+						if (forward != infinity || backward != infinity) {
+							collapses.push_back(forward <= backward ? Collapse{ a, b, forward } : Collapse{ b, a, backward });
+						}
+					}
+				}
+
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& left, const Collapse& right) {
+					return left.cost < right.cost;
+				});
+
+				for (size_t i{}; i < count; ++i) {
+					remap[i] = static_cast<uint32_t>(i);
+				}
+				std::fill(touched.begin(), touched.end(), uint8_t{ 0 });
+
+				// Each collapse removes about two triangles.
+				size_t budget{ (indices.size() - targetIndexCount) / 6 + 1 };
+				size_t applied{};
+
+				for (const Collapse& collapse : collapses) {
+					if (applied >= budget) {
+						break;
+					}
+
+					if (touched[collapse.from] || touched[collapse.to] ||
+						!valid(points, indices, groups, offsets, adjacency, touched, collapse.from, collapse.to)) {
+						continue;
+					}
+
+					float distance{ planes.distance(collapse.from, points[collapse.to]) };
+					if (distance > maxError) {
+						continue;
+					}
+
+					remap[collapse.from] = collapse.to;
+					quadrics[collapse.to] += quadrics[collapse.from];
+					planes.merge(collapse.from, collapse.to);
+					error = std::max(error, distance);
+
+					for (uint32_t k{ offsets[collapse.from] }; k < offsets[collapse.from + 1]; ++k) {
+						const uint32_t* triangle{ indices.data() + adjacency[k] * 3 };
+						touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+					}
+
+					++applied;
+				}
+
+				if (!applied) {
+					break;
+				}
+
+				size_t kept{};
+				for (size_t t{}; t + 2 < indices.size(); t += 3) {
+					uint32_t a{ remap[indices[t]] };
+					uint32_t b{ remap[indices[t + 1]] };
+					uint32_t c{ remap[indices[t + 2]] };
+
+					if (a != b && b != c && a != c) {
+						indices[kept++] = a;
+						indices[kept++] = b;
+						indices[kept++] = c;
+					}
+				}
+
+				indices.resize(kept);
+			}
+
+			return indices;
+		}
+
+		// Positions are the first attribute, decoded from the packed vertices when there are no floats.
+		static Buffer<Vec3> positions(const MeshData& data) {
+			size_t stride{};
+			for (uint8_t size : data.vertexLayout) {
+				stride += size;
+			}
+
+			Buffer<float> decoded;
+			if (data.vertices.empty() && stride) {
+				decoded = VertexFormat::unpack(data.packed.bytes(), data.packed.stride, data.vertexLayout, data.vertexTypes, data.packed.positionScale, data.packed.positionOffset);
+			}
+
+			const Buffer<float>& vertices{ data.vertices.empty() ? decoded : data.vertices };
+			uint8_t components{ data.vertexLayout.empty() ? uint8_t{} : data.vertexLayout[0] };
+
+			Buffer<Vec3> points(stride ? vertices.size() / stride : 0);
+			for (size_t i{}; i < points.size(); ++i) {
+				const float* vertex{ vertices.data() + i * stride };
+				points[i] = Vec3{ vertex[0], components > 1 ? vertex[1] : 0.0f, components > 2 ? vertex[2] : 0.0f };
+			}
+
+			return points;
+		}
+
+	private:
+		static constexpr float infinity{ std::numeric_limits<float>::infinity() };
+
+		// Area weighted sum of squared distances to planes, as a symmetric 4x4 matrix.
+		struct Quadric {
+			double a2{}, ab{}, ac{}, ad{};
+			double b2{}, bc{}, bd{};
+			double c2{}, cd{};
+			double d2{};
+			double weight{};
+
+			static Quadric plane(const Vec3& p0, const Vec3& p1, const Vec3& p2) {
+				Vec3 normal{ (p1 - p0).cross(p2 - p0) };
+				double area{ normal.length() * 0.5 };
+
+				if (area == 0.0) {
+					return Quadric{};
+				}
+
+				double a{ normal.x / (area * 2.0) };
+				double b{ normal.y / (area * 2.0) };
+				double c{ normal.z / (area * 2.0) };
+				double d{ -(a * p0.x + b * p0.y + c * p0.z) };
+
+				return Quadric{
+					a * a * area, a * b * area, a * c * area, a * d * area,
+					b * b * area, b * c * area, b * d * area,
+					c * c * area, c * d * area,
+					d * d * area,
+					area };
+			}
+
+			Quadric& operator+=(const Quadric& other) {
+				a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+				b2 += other.b2; bc += other.bc; bd += other.bd;
+				c2 += other.c2; cd += other.cd;
+				d2 += other.d2;
+				weight += other.weight;
+
+				return *this;
+			}
+
+			Quadric operator+(const Quadric& other) const {
+				Quadric result{ *this };
+				result += other;
+				return result;
+			}
+
+			// Root mean square distance of the point to the planes.
+			float error(const Vec3& point) const {
+				if (weight == 0.0) {
+					return 0.0f;
+				}
+
+				double x{ point.x };
+				double y{ point.y };
+				double z{ point.z };
+
+				double value{
+					a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x +
+					b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y +
+					c2 * z * z + 2.0 * cd * z +
+					d2 };
+
+				return static_cast<float>(std::sqrt(std::max(value, 0.0) / weight));
+			}
+		};
+
+		struct Collapse {
+			uint32_t from{};
+			uint32_t to{};
+			float cost{};
+		};
+
+		static Planes originalPlanes(const Buffer<Vec3>& points, const Buffer<uint32_t>& indices) {
+			Planes result;
+			result.vertices.resize(points.size());
+
+			for (size_t t{}; t + 2 < indices.size(); t += 3) {
+				const Vec3& p0{ points[indices[t]] };
+				Vec3 normal{ (points[indices[t + 1]] - p0).cross(points[indices[t + 2]] - p0) };
+
+				float length{ normal.length() };
+				if (length == 0.0f) {
+					continue;
+				}
+
+				normal = normal * (1.0f / length);
+
+				uint32_t plane{ static_cast<uint32_t>(result.planes.size()) };
+				result.planes.push_back(Vec4{ normal.x, normal.y, normal.z, -normal.dot(p0) });
+
+				for (size_t k{}; k < 3; ++k) {
+					result.vertices[indices[t + k]].push_back(plane);
+				}
+			}
+
+			return result;
+		}
+
+		// Every vertex mapped to the first vertex with an equal position.
+		static Buffer<uint32_t> positionGroups(const Buffer<Vec3>& points) {
+			Buffer<uint32_t> groups(points.size());
+			std::unordered_multimap<uint64_t, uint32_t> unique;
+			unique.reserve(points.size());
+
+			for (size_t i{}; i < points.size(); ++i) {
+				// Adding zero turns negative zeros positive so they hash alike.
+				float values[3]{ points[i].x + 0.0f, points[i].y + 0.0f, points[i].z + 0.0f };
+
+				uint64_t key{ 14695981039346656037ULL };
+				for (size_t c{}; c < sizeof(values); ++c) {
+					key = (key ^ reinterpret_cast<const uint8_t*>(values)[c]) * 1099511628211ULL;
+				}
+
+				groups[i] = static_cast<uint32_t>(i);
+
+				auto [first, last] { unique.equal_range(key) };
+				for (auto it{ first }; it != last; ++it) {
+					const Vec3& other{ points[it->second] };
+					if (other.x == values[0] && other.y == values[1] && other.z == values[2]) {
+						groups[i] = it->second;
+						break;
+					}
+				}
+
+				if (groups[i] == i) {
+					unique.emplace(key, static_cast<uint32_t>(i));
+				}
+			}
+
+			return groups;
+		}
+
+		// Seam vertices share their position with another vertex. Border edges are used by one
+		// triangle once seams are joined, non-manifold ones by more than two.
+		static Buffer<uint8_t> lockedVertices(const Buffer<uint32_t>& indices, const Buffer<uint32_t>& groups) {
+			Buffer<uint8_t> locked(groups.size());
+			Buffer<uint32_t> members(groups.size());
+
+			for (uint32_t group : groups) {
+				++members[group];
+			}
+
+			for (size_t i{}; i < groups.size(); ++i) {
+				locked[i] = members[groups[i]] > 1;
+			}
+
+			std::unordered_map<uint64_t, uint32_t> edges;
+			edges.reserve(indices.size());
+
+			for (size_t t{}; t + 2 < indices.size(); t += 3) {
+				for (size_t k{}; k < 3; ++k) {
+					uint32_t a{ groups[indices[t + k]] };
+					uint32_t b{ groups[indices[t + (k + 1) % 3]] };
+
+					++edges[uint64_t{ std::min(a, b) } << 32 | std::max(a, b)];
+				}
+			}
+
+			for (size_t t{}; t + 2 < indices.size(); t += 3) {
+				for (size_t k{}; k < 3; ++k) {
+					uint32_t a{ indices[t + k] };
+					uint32_t b{ indices[t + (k + 1) % 3] };
+					uint32_t first{ std::min(groups[a], groups[b]) };
+					uint32_t second{ std::max(groups[a], groups[b]) };
+
+					if (edges[uint64_t{ first } << 32 | second] != 2) {
+						locked[a] = locked[b] = 1;
+					}
+				}
+			}
+
+			return locked;
+		}
+
+		static void buildAdjacency(
+			const Buffer<uint32_t>& indices,
+			size_t count,
+			Buffer<uint32_t>& offsets,
+			Buffer<uint32_t>& adjacency) {
+			offsets.assign(count + 1, 0);
+			for (uint32_t index : indices) {
+				++offsets[index + 1];
+			}
+
+			for (size_t i{}; i < count; ++i) {
+				offsets[i + 1] += offsets[i];
+			}
+
+			Buffer<uint32_t> fill{ offsets.begin(), offsets.end() - 1 };
+			adjacency.resize(indices.size());
+
+			for (size_t i{}; i < indices.size(); ++i) {
+				adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		// Rejects collapses that flip or fold a remaining triangle around from, that would join it to the
+		// other side of a seam through to, or whose triangles changed earlier in the pass.
+		static bool valid(
+			const Buffer<Vec3>& points,
+			const Buffer<uint32_t>& indices,
+			const Buffer<uint32_t>& groups,
+			const Buffer<uint32_t>& offsets,
+			const Buffer<uint32_t>& adjacency,
+			const Buffer<uint8_t>& touched,
+			uint32_t from,
+			uint32_t to) {
+			for (uint32_t k{ offsets[from] }; k < offsets[from + 1]; ++k) {
+				const uint32_t* triangle{ indices.data() + adjacency[k] * 3 };
+
+				bool shared{ false };
+				for (size_t c{}; c < 3; ++c) {
+					if (touched[triangle[c]] || (triangle[c] != to && groups[triangle[c]] == groups[to])) {
+						return false;
+					}
+
+					shared = shared || triangle[c] == to;
+				}
+
+				if (shared) {
+					continue;
+				}
+
+				Vec3 corners[3]{ points[triangle[0]], points[triangle[1]], points[triangle[2]] };
+				Vec3 first{ corners[1] - corners[0] };
+				Vec3 second{ corners[2] - corners[0] };
+				Vec3 before{ first.cross(second) };
+
+				// Slivers have no orientation to keep.
+				if (before.length() <= 1e-4f * std::max(first.dot(first), second.dot(second))) {
+					continue;
+				}
+
+				for (size_t c{}; c < 3; ++c) {
+					if (triangle[c] == from) {
+						corners[c] = points[to];
+					}
+				}
+
+				// Normals turning by more than about 75 degrees count as flips too.
+				Vec3 after{ (corners[1] - corners[0]).cross(corners[2] - corners[0]) };
+				if (after.dot(before) <= 0.25f * after.length() * before.length()) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+	};
+
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include "core/core_types.h"
+
+namespace Byte {
+
+	struct ProfileEvent {
+		const char* name{};
+		uint64_t begin{};
+		uint64_t end{};
+	};
+
+	struct ProfileBuffer {
+		static constexpr size_t capacity{ 1 << 16 };
+
+		ProfileEvent events[capacity];
+		std::atomic<uint64_t> head{};
+
+		uint32_t thread{};
+	};
+
+	class Profiler {
+	private:
+		inline static std::mutex _mutex;
+		inline static Buffer<std::unique_ptr<ProfileBuffer>> _buffers;
+		inline static std::atomic<uint32_t> _threadCount{ 1 };
+
+		inline static ProfileBuffer _gpuBuffer;
+		inline static std::unordered_set<std::string> _names;
+		inline static std::atomic<int64_t> _gpuOffset{};
+
+	public:
+		static uint64_t now() {
+			auto time{ std::chrono::steady_clock::now().time_since_epoch() };
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+		}
+
+		static void record(const char* name, uint64_t begin, uint64_t end) {
+			push(local(), ProfileEvent{ name, begin, end });
+		}
+
+		// Returns a name that stays valid for the lifetime of the program.
+		static const char* intern(std::string_view name) {
+			std::lock_guard<std::mutex> lock{ _mutex };
+			return _names.emplace(name).first->c_str();
+		}
+
+		// GPU events come from the thread owning the GL context only, names are interned.
+		static void gpu(const char* name, uint64_t begin, uint64_t end) {
+			int64_t offset{ _gpuOffset.load(std::memory_order_relaxed) };
+			push(_gpuBuffer, ProfileEvent{
+				name,
+				static_cast<uint64_t>(static_cast<int64_t>(begin) + offset),
+				static_cast<uint64_t>(static_cast<int64_t>(end) + offset) });
+		}
+
+		static void calibrate(uint64_t gpuTime) {
+			int64_t offset{ static_cast<int64_t>(now()) - static_cast<int64_t>(gpuTime) };
+			_gpuOffset.store(offset, std::memory_order_relaxed);
+		}
+
+		static bool exportChromeTrace(const Path& path) {
+			std::ofstream file{ path };
+			if (!file) {
+				return false;
+			}
+
+			file << "{\"traceEvents\":[";
+			file.precision(15);
+
+			bool first{ true };
+			auto separate = [&file, &first]() {
+				file << (first ? "\n" : ",\n");
+				first = false;
+			};
+
+			auto write = [&file, &separate](const ProfileBuffer& buffer) {
+				uint64_t head{ buffer.head.load(std::memory_order_acquire) };
+				uint64_t start{ head > ProfileBuffer::capacity ? head - ProfileBuffer::capacity : 0 };
+
+				std::string thread{ buffer.thread ? "CPU " + std::to_string(buffer.thread) : "GPU" };
+
+				separate();
+				file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.thread
+					<< ",\"args\":{\"name\":\"" << thread << "\"}}";
+
+				for (uint64_t i{ start }; i < head; ++i) {
+					const ProfileEvent& event{ buffer.events[i & (ProfileBuffer::capacity - 1)] };
+
+					separate();
+					file << "{\"name\":\"";
+					escape(file, event.name);
+					file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.thread
+						<< ",\"ts\":" << static_cast<double>(event.begin) * 1e-3
+						<< ",\"dur\":" << static_cast<double>(event.end - event.begin) * 1e-3 << "}";
+				}
+			};
+
+			write(_gpuBuffer);
+
+			std::lock_guard<std::mutex> lock{ _mutex };
+			for (const auto& buffer : _buffers) {
+				write(*buffer);
+			}
+
+			file << "\n]}\n";
+
+			return static_cast<bool>(file);
+		}
+
+		static void clear() {
+			_gpuBuffer.head.store(0, std::memory_order_release);
+
+			std::lock_guard<std::mutex> lock{ _mutex };
+			for (auto& buffer : _buffers) {
+				buffer->head.store(0, std::memory_order_release);
+			}
+		}
+
+	private:
+		static void escape(std::ostream& stream, const char* text) {
+			for (; *text; ++text) {
+				if (*text == '"' || *text == '\\') {
+					stream << '\\';
+				}
+				stream << *text;
+			}
+		}
+
+		static ProfileBuffer& local() {
+			thread_local ProfileBuffer* buffer{ nullptr };
+
+			if (!buffer) {
+				auto created{ std::make_unique<ProfileBuffer>() };
+				created->thread = _threadCount.fetch_add(1, std::memory_order_relaxed);
+				buffer = created.get();
+
+				std::lock_guard<std::mutex> lock{ _mutex };
+				_buffers.push_back(std::move(created));
+			}
+
+			return *buffer;
+		}
+
+		static void push(ProfileBuffer& buffer, const ProfileEvent& event) {
+			uint64_t head{ buffer.head.load(std::memory_order_relaxed) };
+			buffer.events[head & (ProfileBuffer::capacity - 1)] = event;
+			buffer.head.store(head + 1, std::memory_order_release);
+		}
+	};
+
+	class ProfileZone {
+	private:
+		const char* _name;
+		uint64_t _begin;
+
+	public:
+		ProfileZone(const char* name)
+			:_name{ name }, _begin{ Profiler::now() } {
+		}
+
+		ProfileZone(const ProfileZone&) = delete;
+
+		ProfileZone& operator=(const ProfileZone&) = delete;
+
+		~ProfileZone() {
+			Profiler::record(_name, _begin, Profiler::now());
+		}
+	};
+
+}
+
+#define BYTE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define BYTE_PROFILE_CONCAT(a, b) BYTE_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef BYTE_PROFILE
+#define BYTE_PROFILE_ZONE(name) ::Byte::ProfileZone BYTE_PROFILE_CONCAT(profileZone, __LINE__){ name }
+#define BYTE_PROFILE_GPU(name, begin, end) ::Byte::Profiler::gpu(name, begin, end)
+#define BYTE_PROFILE_CALIBRATE(gpuTime) ::Byte::Profiler::calibrate(gpuTime)
+#else
+#define BYTE_PROFILE_ZONE(name)
+#define BYTE_PROFILE_GPU(name, begin, end)
+#define BYTE_PROFILE_CALIBRATE(gpuTime)
+#endif
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "core/bounds.h"
+#include "core/core_types.h"
+#include "core/mesh.h"
+#include "core/material.h"
+#include "core/transform.h"
+
+namespace Byte {
+
+	struct StaticBatch {
+		Mesh mesh;
+		Material material;
+		Transform transform;
+	};
+
+	// Merges static meshes that share material and vertex layout into one mesh per group, with
+	// each source's transform baked into its vertices. Every source keeps a range of the merged
+	// indices with its own bounds, so culling can still skip parts of a batch. Vertices are kept
+	// relative to the center of the batch, which becomes the position of the batch transform.
+	class StaticBatcher {
+	private:
+		struct Source {
+			const Mesh* mesh{};
+			const Material* material{};
+			const Transform* transform{};
+		};
+
+		Buffer<Source> _sources;
+
+	public:
+		// The first attribute must be the position; a second three component attribute is
+		// treated as the normal. Other attributes are copied as they are.
+		static bool accepts(const Mesh& mesh) {
+			const Buffer<uint8_t>& layout{ mesh.data().vertexLayout };
+			size_t stride{ vertexSize(layout) };
+
+			return mesh.mode() == MeshMode::STATIC &&
+				!layout.empty() && layout[0] == 3 &&
+				!mesh.indices().empty() &&
+				!mesh.vertices().empty() &&
+				mesh.vertices().size() % stride == 0;
+		}
+
+		// Sources are read on build, so they must stay alive until then.
+		bool add(const Mesh& mesh, const Material& material, const Transform& transform) {
+			if (!accepts(mesh)) {
+				return false;
+			}
+
+			_sources.push_back(Source{ &mesh, &material, &transform });
+			return true;
+		}
+
+		Buffer<StaticBatch> build() const {
+			Buffer<Buffer<const Source*>> groups;
+
+			for (const Source& source : _sources) {
+				auto group{ std::find_if(groups.begin(), groups.end(), [&source](const Buffer<const Source*>& group) {
+					return compatible(*group.front(), source);
+				}) };
+
+				if (group != groups.end()) {
+					group->push_back(&source);
+				}
+				else {
+					groups.push_back({ &source });
+				}
+			}
+
+			Buffer<StaticBatch> batches;
+			batches.reserve(groups.size());
+
+			for (const auto& group : groups) {
+				batches.push_back(merge(group));
+			}
+
+			return batches;
+		}
+
+		void clear() {
+			_sources.clear();
+		}
+
+		size_t size() const {
+			return _sources.size();
+		}
+
+	private:
+		static bool compatible(const Source& left, const Source& right) {
+			const MaterialData& a{ left.material->data() };
+			const MaterialData& b{ right.material->data() };
+
+			return left.mesh->data().vertexLayout == right.mesh->data().vertexLayout &&
+				left.mesh->data().vertexTypes == right.mesh->data().vertexTypes &&
+				a.shaderMap == b.shaderMap &&
+				a.albedo == b.albedo &&
+				a.metallic == b.metallic &&
+				a.roughness == b.roughness &&
+				a.ambientOcclusion == b.ambientOcclusion &&
+				a.emission == b.emission &&
+				a.textureMap == b.textureMap &&
+				a.layers == b.layers &&
+				a.shadow == b.shadow &&
+				a.transparency == b.transparency;
+		}
+
+		static StaticBatch merge(const Buffer<const Source*>& group) {
+			const Source& first{ *group.front() };
+			const Buffer<uint8_t>& layout{ first.mesh->data().vertexLayout };
+
+			size_t stride{ vertexSize(layout) };
+			bool normals{ layout.size() > 1 && layout[1] == 3 };
+
+			MeshData data;
+			data.vertexLayout = layout;
+			data.vertexTypes = first.mesh->data().vertexTypes;
+			data.ranges.reserve(group.size());
+
+			Buffer<size_t> firstVertices;
+			firstVertices.reserve(group.size() + 1);
+
+			for (const Source* source : group) {
+				const Mesh& mesh{ *source->mesh };
+				const Transform& transform{ *source->transform };
+
+				size_t firstVertex{ data.vertices.size() / stride };
+				firstVertices.push_back(firstVertex);
+
+				data.ranges.push_back(MeshRange{
+					static_cast<uint32_t>(data.indices.size()),
+					static_cast<uint32_t>(mesh.indices().size()) });
+
+				data.vertices.insert(data.vertices.end(), mesh.vertices().begin(), mesh.vertices().end());
+
+				for (size_t i{ firstVertex * stride }; i < data.vertices.size(); i += stride) {
+					float* vertex{ data.vertices.data() + i };
+
+					Vec3 position{ transform.rotation() * (Vec3{ vertex[0], vertex[1], vertex[2] } * transform.scale()) };
+					position += transform.position();
+					write(vertex, position);
+
+					if (normals) {
+						Vec3 normal{ transform.rotation() * (Vec3{ vertex[3], vertex[4], vertex[5] } / transform.scale()) };
+						write(vertex + 3, normal.normalized());
+					}
+				}
+
+				for (uint32_t index : mesh.indices()) {
+					data.indices.push_back(index + static_cast<uint32_t>(firstVertex));
+				}
+			}
+
+			firstVertices.push_back(data.vertices.size() / stride);
+
+			Vec3 center{ MeshBounds::computeBox(data.vertices.data(), firstVertices.back(), stride).center() };
+
+			for (size_t i{}; i < data.vertices.size(); i += stride) {
+				float* vertex{ data.vertices.data() + i };
+				write(vertex, Vec3{ vertex[0], vertex[1], vertex[2] } - center);
+			}
+
+			for (size_t i{}; i < data.ranges.size(); ++i) {
+				MeshRange& range{ data.ranges[i] };
+
+				BoundingSphere sphere{ MeshBounds::compute(
+					data.vertices.data() + firstVertices[i] * stride,
+					firstVertices[i + 1] - firstVertices[i],
+					stride).sphere };
+
+				range.center = sphere.center;
+				range.radius = sphere.radius;
+			}
+
+			StaticBatch batch{ Mesh{ std::move(data) }, Material{ MaterialData{ first.material->data() } } };
+			batch.transform.position(center);
+
+			return batch;
+		}
+
+		static void write(float* vertex, const Vec3& value) {
+			vertex[0] = value.x;
+			vertex[1] = value.y;
+			vertex[2] = value.z;
+		}
+
+		static size_t vertexSize(const Buffer<uint8_t>& layout) {
+			size_t size{};
+			for (uint8_t count : layout) {
+				size += count;
+			}
+
+			return size;
+		}
+	};
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "math/vec.h"
+#include "core/core_types.h"
+#include "core/vertex_format.h"
+
+namespace Byte {
+
+	// One attribute of a typed vertex: how it is stored and how many floats it stands for.
+	// Sizes follow the padding of VertexFormat, so typed vertices upload as they are.
+	template<VertexType Type, uint8_t Count>
+	struct VertexElement {
+		static_assert(Count >= 2 && Count <= 4, "Vertex elements hold two to four components");
+		static_assert(Type != VertexType::OCTAHEDRAL || Count == 3, "Octahedral elements encode normals");
+
+		using Value = std::conditional_t<Count == 2, Vec2, std::conditional_t<Count == 3, Vec3, Vec4>>;
+
+		static constexpr VertexType type{ Type };
+		static constexpr uint8_t components{ Count };
+		static constexpr size_t size{ VertexFormat::componentSize(Type) * VertexFormat::components(Type, Count) };
+
+		static void write(uint8_t* target, const Value& value) {
+			float values[4]{ value.x, value.y };
+			if constexpr (Count > 2) {
+				values[2] = value.z;
+			}
+			if constexpr (Count > 3) {
+				values[3] = value.w;
+			}
+
+			VertexFormat::encode(target, Type, values, Count);
+		}
+
+		static Value read(const uint8_t* source) {
+			float values[4]{};
+			VertexFormat::decode(source, Type, values, Count);
+
+			if constexpr (Count == 2) {
+				return Value{ values[0], values[1] };
+			}
+			else if constexpr (Count == 3) {
+				return Value{ values[0], values[1], values[2] };
+			}
+			else {
+				return Value{ values[0], values[1], values[2], values[3] };
+			}
+		}
+	};
+
+	// Position16 stores coordinates within [-1, 1]; the mesh's position scale brings them back.
+	using Position3f = VertexElement<VertexType::FLOAT, 3>;
+	using Position16 = VertexElement<VertexType::SNORM16, 3>;
+	using Normal3f = VertexElement<VertexType::FLOAT, 3>;
+	using NormalOct16 = VertexElement<VertexType::OCTAHEDRAL, 3>;
+	using UV2f = VertexElement<VertexType::FLOAT, 2>;
+	using UV2h = VertexElement<VertexType::HALF_FLOAT, 2>;
+	using UV16 = VertexElement<VertexType::UNORM16, 2>;
+	using Color8 = VertexElement<VertexType::UNORM8, 4>;
+
+	// A tightly packed vertex whose attribute offsets, stride and layout are known at compile
+	// time. Buffers of it upload without repacking, and its layout and types describe it to
+	// MeshData, RenderAPI and Shader.
+	template<typename... Elements>
+	struct Vertex {
+		static_assert(sizeof...(Elements) > 0, "A vertex needs at least one element");
+
+		static constexpr size_t count{ sizeof...(Elements) };
+		static constexpr size_t stride{ (Elements::size + ...) };
+		static constexpr std::array<uint8_t, count> layout{ Elements::components... };
+		static constexpr std::array<VertexType, count> types{ Elements::type... };
+
+		static constexpr std::array<size_t, count> offsets{ [] {
+			std::array<size_t, count> result{};
+			size_t sizes[]{ Elements::size... };
+
+			for (size_t i{ 1 }; i < count; ++i) {
+				result[i] = result[i - 1] + sizes[i - 1];
+			}
+
+			return result;
+		}() };
+
+		// Whether any element is stored as something other than floats.
+		static constexpr bool packed{ ((Elements::type != VertexType::FLOAT) || ...) };
+
+		static constexpr size_t floats{ (Elements::components + ...) };
+
+		template<size_t Index>
+		using Element = std::tuple_element_t<Index, std::tuple<Elements...>>;
+
+		alignas(4) uint8_t bytes[stride]{};
+
+		Vertex() = default;
+
+		Vertex(const typename Elements::Value&... values) {
+			assign(std::index_sequence_for<Elements...>{}, values...);
+		}
+
+		template<size_t Index>
+		void set(const typename Element<Index>::Value& value) {
+			Element<Index>::write(bytes + offsets[Index], value);
+		}
+
+		template<size_t Index>
+		typename Element<Index>::Value get() const {
+			return Element<Index>::read(bytes + offsets[Index]);
+		}
+
+		// Writes the elements back as floats in the order of the layout.
+		void unpack(float* target) const {
+			const uint8_t* source{ bytes };
+			((source = VertexFormat::decode(source, Elements::type, target, Elements::components),
+				target += Elements::components), ...);
+		}
+
+		static Buffer<uint8_t> vertexLayout() {
+			return Buffer<uint8_t>{ layout.begin(), layout.end() };
+		}
+
+		// Empty when every element is a float, which is how MeshData marks unpacked vertices.
+		static Buffer<VertexType> vertexTypes() {
+			return packed ? Buffer<VertexType>{ types.begin(), types.end() } : Buffer<VertexType>{};
+		}
+
+	private:
+		template<size_t... Indices>
+		void assign(std::index_sequence<Indices...>, const typename Elements::Value&... values) {
+			(set<Indices>(values), ...);
+		}
+	};
+
+	using StandardVertex = Vertex<Position3f, Normal3f, UV2f>;
+
+}
@@ -0,0 +1,395 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <span>
+
+#include "math/vec.h"
+#include "core/core_types.h"
+
+namespace Byte {
+
+	// How an attribute is stored on the GPU. Normalized types are read back as floats; SNORM16
+	// positions are relative to the mesh bounds and OCTAHEDRAL normals take two components.
+	enum class VertexType : uint8_t {
+		FLOAT,
+		HALF_FLOAT,
+		SNORM16,
+		UNORM16,
+		UNORM8,
+		OCTAHEDRAL,
+	};
+
+	// Owns its bytes, or views bytes that owner keeps alive, such as a mapped mesh file.
+	struct PackedVertices {
+		Buffer<uint8_t> vertices;
+		size_t stride{};
+		float positionScale{ 1.0f };
+		Vec3 positionOffset;
+
+		std::span<const uint8_t> view;
+		std::shared_ptr<const void> owner;
+
+		std::span<const uint8_t> bytes() const {
+			return owner ? view : std::span<const uint8_t>{ vertices };
+		}
+
+		bool empty() const {
+			return bytes().empty();
+		}
+	};
+
+	// Sizes and packing of typed vertex attributes. Components are padded so every attribute
+	// starts on four bytes. A SNORM16 first attribute is stored relative to the center of its
+	// bounds and divided by the largest distance from it; the draw multiplies the position scale
+	// back in and adds the position offset.
+	struct VertexFormat {
+		static VertexType type(const Buffer<VertexType>& types, size_t attribute) {
+			return attribute < types.size() ? types[attribute] : VertexType::FLOAT;
+		}
+
+		static constexpr size_t componentSize(VertexType type) {
+			switch (type) {
+			case VertexType::FLOAT:
+				return sizeof(float);
+			case VertexType::UNORM8:
+				return sizeof(uint8_t);
+			default:
+				return sizeof(uint16_t);
+			}
+		}
+
+		static constexpr size_t components(VertexType type, uint8_t count) {
+			switch (type) {
+			case VertexType::FLOAT:
+				return count;
+			case VertexType::OCTAHEDRAL:
+				return 2;
+			case VertexType::UNORM8:
+				return (count + 3) & ~size_t{ 3 };
+			default:
+				return (count + 1) & ~size_t{ 1 };
+			}
+		}
+
+		static constexpr bool normalized(VertexType type) {
+			return type != VertexType::FLOAT && type != VertexType::HALF_FLOAT;
+		}
+
+		static size_t stride(const Buffer<uint8_t>& layout, const Buffer<VertexType>& types) {
+			size_t size{};
+			for (size_t i{}; i < layout.size(); ++i) {
+				VertexType attribute{ type(types, i) };
+				size += componentSize(attribute) * components(attribute, layout[i]);
+			}
+
+			return size;
+		}
+
+		static PackedVertices pack(
+			const Buffer<float>& vertices,
+			const Buffer<uint8_t>& layout,
+			const Buffer<VertexType>& types) {
+			PackedVertices packed{};
+			packed.stride = stride(layout, types);
+
+			size_t floats{};
+			for (uint8_t count : layout) {
+				floats += count;
+			}
+
+			size_t count{ floats ? vertices.size() / floats : 0 };
+
+			bool centered{ !layout.empty() && type(types, 0) == VertexType::SNORM16 };
+			float center[3]{};
+
+			if (centered && count) {
+				size_t axes{ std::min<size_t>(layout[0], 3) };
+
+				for (size_t c{}; c < axes; ++c) {
+					float low{ vertices[c] };
+					float high{ vertices[c] };
+
+					for (size_t v{ 1 }; v < count; ++v) {
+						low = std::min(low, vertices[v * floats + c]);
+						high = std::max(high, vertices[v * floats + c]);
+					}
+
+					center[c] = (low + high) * 0.5f;
+				}
+
+				float extent{};
+				for (size_t v{}; v < count; ++v) {
+					for (size_t c{}; c < layout[0]; ++c) {
+						extent = std::max(extent, std::abs(vertices[v * floats + c] - (c < axes ? center[c] : 0.0f)));
+					}
+				}
+
+				packed.positionScale = extent > 0.0f ? extent : 1.0f;
+				packed.positionOffset = Vec3{ center[0], center[1], center[2] };
+			}
+
+			packed.vertices.resize(count * packed.stride);
+
+			for (size_t v{}; v < count; ++v) {
+				const float* source{ vertices.data() + v * floats };
+				uint8_t* target{ packed.vertices.data() + v * packed.stride };
+
+				for (size_t i{}; i < layout.size(); ++i) {
+					VertexType attribute{ type(types, i) };
+
+					if (i == 0 && centered) {
+						float position[4]{};
+						for (size_t c{}; c < std::min<size_t>(layout[0], 4); ++c) {
+							position[c] = source[c] - (c < 3 ? center[c] : 0.0f);
+						}
+
+						target = encode(target, attribute, position, layout[i], 1.0f / packed.positionScale);
+					}
+					else {
+						target = encode(target, attribute, source, layout[i]);
+					}
+
+					source += layout[i];
+				}
+			}
+
+			return packed;
+		}
+
+		// Inverse of pack: positions come back multiplied by the position scale and moved by
+		// the position offset.
+		static Buffer<float> unpack(
+			std::span<const uint8_t> vertices,
+			size_t vertexStride,
+			const Buffer<uint8_t>& layout,
+			const Buffer<VertexType>& types,
+			float positionScale = 1.0f,
+			const Vec3& positionOffset = Vec3{}) {
+			size_t floats{};
+			for (uint8_t count : layout) {
+				floats += count;
+			}
+
+			size_t count{ vertexStride ? vertices.size() / vertexStride : 0 };
+			bool scaled{ !layout.empty() && type(types, 0) == VertexType::SNORM16 };
+			float offset[3]{ positionOffset.x, positionOffset.y, positionOffset.z };
+
+			Buffer<float> result(count * floats);
+
+			for (size_t v{}; v < count; ++v) {
+				const uint8_t* source{ vertices.data() + v * vertexStride };
+				float* target{ result.data() + v * floats };
+
+				for (size_t i{}; i < layout.size(); ++i) {
+					source = decode(source, type(types, i), target, layout[i]);
+					target += layout[i];
+				}
+
+				if (scaled) {
+					for (size_t c{}; c < layout[0]; ++c) {
+						result[v * floats + c] = result[v * floats + c] * positionScale + (c < 3 ? offset[c] : 0.0f);
+					}
+				}
+			}
+
+			return result;
+		}
+
+		static uint16_t half(float value) {
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			uint32_t sign{ (bits >> 16) & 0x8000u };
+			int32_t exponent{ static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15 };
+			uint32_t mantissa{ bits & 0x7FFFFFu };
+
+			if (exponent <= 0) {
+				if (exponent < -10) {
+					return static_cast<uint16_t>(sign);
+				}
+
+				mantissa |= 0x800000u;
+				uint32_t shift{ static_cast<uint32_t>(14 - exponent) };
+				uint32_t rounded{ (mantissa + (1u << (shift - 1))) >> shift };
+
+				return static_cast<uint16_t>(sign | rounded);
+			}
+
+			if (exponent >= 31) {
+				return static_cast<uint16_t>(sign | 0x7C00u);
+			}
+
+			uint32_t result{ sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13) };
+			if (mantissa & 0x1000u) {
+				++result;
+			}
+
+			return static_cast<uint16_t>(result);
+		}
+
+		// Maps a unit vector onto the octahedron unfolded into [-1, 1]^2.
+		static Vec2 octahedral(const Vec3& normal) {
+			float sum{ std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z) };
+			if (sum == 0.0f) {
+				return Vec2{ 0.0f, 0.0f };
+			}
+
+			float x{ normal.x / sum };
+			float y{ normal.y / sum };
+
+			if (normal.z < 0.0f) {
+				float foldedX{ (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f) };
+				float foldedY{ (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f) };
+
+				x = foldedX;
+				y = foldedY;
+			}
+
+			return Vec2{ x, y };
+		}
+
+		// Writes count floats as one attribute and returns the start of the next one.
+		static uint8_t* encode(uint8_t* target, VertexType type, const float* source, uint8_t count, float scale = 1.0f) {
+			size_t padded{ components(type, count) };
+
+			switch (type) {
+			case VertexType::FLOAT:
+				std::memcpy(target, source, count * sizeof(float));
+				break;
+			case VertexType::HALF_FLOAT:
+				for (size_t c{}; c < padded; ++c) {
+					store<uint16_t>(target, c, c < count ? half(source[c]) : 0);
+				}
+				break;
+			case VertexType::SNORM16:
+				for (size_t c{}; c < padded; ++c) {
+					store<int16_t>(target, c, c < count ? snorm16(source[c] * scale) : 0);
+				}
+				break;
+			case VertexType::UNORM16:
+				for (size_t c{}; c < padded; ++c) {
+					store<uint16_t>(target, c, c < count ? unorm<uint16_t>(source[c]) : 0);
+				}
+				break;
+			case VertexType::UNORM8:
+				for (size_t c{}; c < padded; ++c) {
+					target[c] = c < count ? unorm<uint8_t>(source[c]) : 0;
+				}
+				break;
+			case VertexType::OCTAHEDRAL: {
+				Vec3 normal{ source[0], count > 1 ? source[1] : 0.0f, count > 2 ? source[2] : 0.0f };
+				Vec2 encoded{ octahedral(normal) };
+
+				store<int16_t>(target, 0, snorm16(encoded.x));
+				store<int16_t>(target, 1, snorm16(encoded.y));
+				break;
+			}
+			}
+
+			return target + padded * componentSize(type);
+		}
+
+		// Reads one attribute back into count floats and returns the start of the next one.
+		static const uint8_t* decode(const uint8_t* source, VertexType type, float* target, uint8_t count) {
+			size_t padded{ components(type, count) };
+
+			switch (type) {
+			case VertexType::FLOAT:
+				std::memcpy(target, source, count * sizeof(float));
+				break;
+			case VertexType::HALF_FLOAT:
+				for (size_t c{}; c < count; ++c) {
+					target[c] = single(load<uint16_t>(source, c));
+				}
+				break;
+			case VertexType::SNORM16:
+				for (size_t c{}; c < count; ++c) {
+					target[c] = std::max(load<int16_t>(source, c) / 32767.0f, -1.0f);
+				}
+				break;
+			case VertexType::UNORM16:
+				for (size_t c{}; c < count; ++c) {
+					target[c] = load<uint16_t>(source, c) / 65535.0f;
+				}
+				break;
+			case VertexType::UNORM8:
+				for (size_t c{}; c < count; ++c) {
+					target[c] = source[c] / 255.0f;
+				}
+				break;
+			case VertexType::OCTAHEDRAL: {
+				Vec3 normal{ unfold(Vec2{
+					std::max(load<int16_t>(source, 0) / 32767.0f, -1.0f),
+					std::max(load<int16_t>(source, 1) / 32767.0f, -1.0f) }) };
+
+				float values[3]{ normal.x, normal.y, normal.z };
+				std::memcpy(target, values, std::min<size_t>(count, 3) * sizeof(float));
+				break;
+			}
+			}
+
+			return source + padded * componentSize(type);
+		}
+
+		static float single(uint16_t value) {
+			uint32_t sign{ static_cast<uint32_t>(value & 0x8000u) << 16 };
+			uint32_t exponent{ (value >> 10) & 0x1Fu };
+			uint32_t mantissa{ value & 0x3FFu };
+
+			if (exponent == 0) {
+				float result{ std::ldexp(static_cast<float>(mantissa), -24) };
+				return sign ? -result : result;
+			}
+
+			uint32_t bits{ sign | (exponent == 31 ? 0x7F800000u : (exponent + 127 - 15) << 23) | (mantissa << 13) };
+
+			float result;
+			std::memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		// Inverse of octahedral, normalized.
+		static Vec3 unfold(const Vec2& encoded) {
+			Vec3 normal{ encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y) };
+
+			if (normal.z < 0.0f) {
+				float x{ (1.0f - std::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f) };
+				float y{ (1.0f - std::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f) };
+
+				normal.x = x;
+				normal.y = y;
+			}
+
+			return normal.normalized();
+		}
+
+	private:
+		template<typename Type>
+		static void store(uint8_t* target, size_t component, Type value) {
+			std::memcpy(target + component * sizeof(Type), &value, sizeof(Type));
+		}
+
+		template<typename Type>
+		static Type load(const uint8_t* source, size_t component) {
+			Type value;
+			std::memcpy(&value, source + component * sizeof(Type), sizeof(Type));
+			return value;
+		}
+
+		static int16_t snorm16(float value) {
+			return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+		}
+
+		template<typename Type>
+		static Type unorm(float value) {
+			constexpr float limit{ static_cast<float>(std::numeric_limits<Type>::max()) };
+			return static_cast<Type>(std::lround(std::clamp(value, 0.0f, 1.0f) * limit));
+		}
+	};
+
+}
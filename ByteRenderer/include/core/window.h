@@ -9,28 +9,61 @@
 
 namespace Byte {
 
+	enum class WindowMode : uint8_t {
+		WINDOWED,
+		HEADLESS,
+	};
+
 	struct Window {
 		GLFWwindow* glfwWindow = nullptr;
 
 		Window() = default;
 
-		Window(size_t width, size_t height, const std::string& title) {
-			glfwWindow = glfwCreateWindow(
-				static_cast<int>(width),
-				static_cast<int>(height),
-				title.c_str(),
-				nullptr,
-				nullptr);
+		// Window without a GL context for the null backends; keeps only its size.
+		Window(size_t width, size_t height)
+			: _width{ width }, _height{ height } {
+		}
+
+		// HEADLESS creates an invisible window with an EGL context, or OSMesa when EGL is
+		// unavailable, so GLFW must have been initialized through initialize(WindowMode::HEADLESS).
+		Window(size_t width, size_t height, const std::string& title, WindowMode mode = WindowMode::WINDOWED)
+			: _mode{ mode } {
+			if (mode == WindowMode::HEADLESS) {
+				glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+				glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+				glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+				glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+				glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+				glfwWindow = create(width, height, title);
+
+				if (glfwWindow == nullptr) {
+					glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+					glfwWindow = create(width, height, title);
+				}
+
+				glfwDefaultWindowHints();
+			}
+			else {
+				glfwWindow = create(width, height, title);
+			}
+
 			if (glfwWindow == nullptr) {
 				throw std::exception("Failed to create GLFW window");
 			}
 		}
 
 		~Window() {
-			glfwDestroyWindow(glfwWindow);
+			if (glfwWindow) {
+				glfwDestroyWindow(glfwWindow);
+			}
 		}
 
 		size_t width() const {
+			if (!glfwWindow) {
+				return _width;
+			}
+
 			int width, height;
 			glfwGetWindowSize(glfwWindow, &width, &height);
 
@@ -38,11 +71,43 @@ namespace Byte {
 		}
 
 		size_t height() const {
+			if (!glfwWindow) {
+				return _height;
+			}
+
 			int width, height;
 			glfwGetWindowSize(glfwWindow, &width, &height);
 
 			return static_cast<size_t>(height);
 		}
+
+		bool headless() const {
+			return _mode == WindowMode::HEADLESS;
+		}
+
+		// Initializes GLFW; HEADLESS selects the null platform so no display server is needed.
+		static bool initialize(WindowMode mode = WindowMode::WINDOWED) {
+			if (mode == WindowMode::HEADLESS) {
+				glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+			}
+
+			return glfwInit() == GLFW_TRUE;
+		}
+
+	private:
+		size_t _width{};
+		size_t _height{};
+
+		WindowMode _mode{ WindowMode::WINDOWED };
+
+		static GLFWwindow* create(size_t width, size_t height, const std::string& title) {
+			return glfwCreateWindow(
+				static_cast<int>(width),
+				static_cast<int>(height),
+				title.c_str(),
+				nullptr,
+				nullptr);
+		}
 	};
 
 }
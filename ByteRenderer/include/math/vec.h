@@ -21,6 +21,8 @@ namespace Byte {
 			:x{ other.x }, y{ other.y } {
 		}
 
+		_Vec2& operator=(const _Vec2&) = default;
+
 		_Vec2 operator+(const _Vec2& other) const {
 			_Vec2 out{ *this };
 			out += other;
@@ -108,7 +110,7 @@ namespace Byte {
 		}
 
 		bool operator==(const _Vec2& other) const {
-			return x == other.x && y = other.y;
+			return x == other.x && y == other.y;
 		}
 
 		bool operator!=(const _Vec2& other) const {
@@ -155,6 +157,8 @@ namespace Byte {
 			:x{ other.x }, y{ other.y }, z{ other.z } {
 		}
 
+		_Vec3& operator=(const _Vec3&) = default;
+
 		_Vec3 operator+(const _Vec3& other) const {
 			_Vec3 out{ *this };
 			out += other;
@@ -248,7 +252,7 @@ namespace Byte {
 		}
 
 		bool operator==(const _Vec3& other) const {
-			return x == other.x && y = other.y && z == other.z;
+			return x == other.x && y == other.y && z == other.z;
 		}
 
 		bool operator!=(const _Vec3& other) const {
@@ -303,6 +307,8 @@ namespace Byte {
 			:x{ other.x }, y{ other.y }, z{ other.z }, w{ other.w } {
 		}
 
+		_Vec4& operator=(const _Vec4&) = default;
+
 		_Vec4 operator+(const _Vec4& other) const {
 			_Vec4 out{ *this };
 			out += other;
@@ -402,7 +408,7 @@ namespace Byte {
 		}
 
 		bool operator==(const _Vec4& other) const {
-			return x == other.x && y = other.y && z == other.z && w == other.w;
+			return x == other.x && y == other.y && z == other.z && w == other.w;
 		}
 
 		bool operator!=(const _Vec4& other) const {
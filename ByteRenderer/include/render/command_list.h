@@ -0,0 +1,422 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <variant>
+#include <type_traits>
+#include <algorithm>
+
+#include "core/job_system.h"
+#include "math/vec.h"
+#include "math/mat.h"
+#include "math/quaternion.h"
+#include "render_type.h"
+#include "render_api.h"
+#include "shader.h"
+#include "texture.h"
+#include "mesh_renderer.h"
+
+namespace Byte {
+
+	enum class CommandType : uint8_t {
+		SHADER,
+		UNIFORM,
+		TEXTURE,
+		RENDER_ARRAY,
+		UNIFORM_BUFFER,
+		DRAW,
+		DRAW_INSTANCED,
+		DRAW_INDIRECT,
+	};
+
+	// SHADER: first = shader index.
+	// UNIFORM: key, format = UniformType, count = elements, first = payload offset in words.
+	// TEXTURE: first = id, second = TextureType, format = unit.
+	// RENDER_ARRAY: first = id.
+	// UNIFORM_BUFFER: first = id, second = binding.
+	// DRAW: first = index count, second = first index, format = PrimitiveType, count = IndexType.
+	// DRAW_INSTANCED: first = index count, second = instance count, format = PrimitiveType, count = IndexType.
+	// DRAW_INDIRECT: first = offset into the indirect commands, second = command count, format = PrimitiveType,
+	// count = IndexType.
+	struct Command {
+		CommandType type{};
+		uint8_t format{};
+		uint16_t count{};
+		uint32_t first{};
+		uint32_t second{};
+		uint64_t key{};
+	};
+
+	static_assert(std::is_trivially_copyable_v<Command>);
+	static_assert(sizeof(Command) == 24);
+
+	class CommandList {
+	private:
+		Buffer<Command> _commands;
+		Buffer<uint32_t> _payload;
+		Buffer<const Shader*> _shaders;
+		Buffer<IndirectCommand> _indirect;
+
+		const Shader* _current{};
+
+		static constexpr UniformKey drawBase{ "uDrawBase" };
+
+	public:
+		CommandList() = default;
+
+		void shader(const Shader& shader) {
+			if (_current == &shader) {
+				return;
+			}
+
+			Command command{ CommandType::SHADER };
+			command.first = static_cast<uint32_t>(_shaders.size());
+
+			_shaders.push_back(&shader);
+			_commands.push_back(command);
+			_current = &shader;
+		}
+
+		template<typename Type>
+		void uniform(UniformKey key, const Type& value) {
+			if constexpr (std::is_same_v<Type, bool> || std::is_same_v<Type, size_t>) {
+				int converted{ static_cast<int>(value) };
+				push(key, &converted, 1);
+			}
+			else if constexpr (std::is_same_v<Type, Quaternion>) {
+				Vec4 converted{ value.x, value.y, value.z, value.w };
+				push(key, &converted, 1);
+			}
+			else {
+				push(key, &value, 1);
+			}
+		}
+
+		template<typename Type>
+		void uniform(UniformKey key, const Buffer<Type>& values) {
+			push(key, values.data(), values.size());
+		}
+
+		void uniform(const ShaderInputMap& inputs) {
+			for (const auto& [tag, input] : inputs) {
+				std::visit([this, &tag](const auto& inputValue) {
+					uniform(tag, inputValue.value);
+				}, input);
+			}
+		}
+
+		void material(const MaterialRecord& record) {
+			if (_current) {
+				_current->material(record, *this);
+			}
+		}
+
+		void texture(const Texture& source, TextureUnit unit = TextureUnit::T0) {
+			texture(source.id(), unit, source.data().type);
+		}
+
+		void texture(TextureID id, TextureUnit unit, TextureType type) {
+			Command command{ CommandType::TEXTURE };
+			command.format = static_cast<uint8_t>(unit);
+			command.first = id;
+			command.second = static_cast<uint32_t>(type);
+
+			_commands.push_back(command);
+		}
+
+		void renderArray(const MeshRenderer& meshRenderer) {
+			renderArray(meshRenderer.renderArray().data().VAO);
+		}
+
+		void renderArray(RenderArrayID id) {
+			Command command{ CommandType::RENDER_ARRAY };
+			command.first = id;
+
+			_commands.push_back(command);
+		}
+
+		void uniformBuffer(uint32_t id, uint32_t binding) {
+			Command command{ CommandType::UNIFORM_BUFFER };
+			command.first = id;
+			command.second = binding;
+
+			_commands.push_back(command);
+		}
+
+		void draw(
+			size_t count,
+			PrimitiveType type = PrimitiveType::TRIANGLES,
+			IndexType index = IndexType::UINT32,
+			size_t firstIndex = 0) {
+			Command command{ CommandType::DRAW };
+			command.format = static_cast<uint8_t>(type);
+			command.count = static_cast<uint16_t>(index);
+			command.first = static_cast<uint32_t>(count);
+			command.second = static_cast<uint32_t>(firstIndex);
+
+			_commands.push_back(command);
+		}
+
+		void drawInstanced(
+			size_t count,
+			size_t instanceCount,
+			PrimitiveType type = PrimitiveType::TRIANGLES,
+			IndexType index = IndexType::UINT32) {
+			if (!instanceCount) {
+				return;
+			}
+
+			Command command{ CommandType::DRAW_INSTANCED };
+			command.format = static_cast<uint8_t>(type);
+			command.count = static_cast<uint16_t>(index);
+			command.first = static_cast<uint32_t>(count);
+			command.second = static_cast<uint32_t>(instanceCount);
+
+			_commands.push_back(command);
+		}
+
+		void drawIndirect(
+			const IndirectCommand* commands,
+			size_t count,
+			PrimitiveType type = PrimitiveType::TRIANGLES,
+			IndexType index = IndexType::UINT32) {
+			if (!count) {
+				return;
+			}
+
+			Command command{ CommandType::DRAW_INDIRECT };
+			command.format = static_cast<uint8_t>(type);
+			command.count = static_cast<uint16_t>(index);
+			command.first = static_cast<uint32_t>(_indirect.size());
+			command.second = static_cast<uint32_t>(count);
+
+			_indirect.insert(_indirect.end(), commands, commands + count);
+			_commands.push_back(command);
+		}
+
+		void append(const CommandList& list) {
+			uint32_t shaderOffset{ static_cast<uint32_t>(_shaders.size()) };
+			uint32_t payloadOffset{ static_cast<uint32_t>(_payload.size()) };
+			uint32_t indirectOffset{ static_cast<uint32_t>(_indirect.size()) };
+
+			for (Command command : list._commands) {
+				if (command.type == CommandType::SHADER) {
+					command.first += shaderOffset;
+				}
+				else if (command.type == CommandType::UNIFORM) {
+					command.first += payloadOffset;
+				}
+				else if (command.type == CommandType::DRAW_INDIRECT) {
+					command.first += indirectOffset;
+				}
+
+				_commands.push_back(command);
+			}
+
+			_shaders.insert(_shaders.end(), list._shaders.begin(), list._shaders.end());
+			_payload.insert(_payload.end(), list._payload.begin(), list._payload.end());
+			_indirect.insert(_indirect.end(), list._indirect.begin(), list._indirect.end());
+
+			_current = list._current ? list._current : _current;
+		}
+
+		void execute() const {
+			const Shader* shader{};
+
+			for (const Command& command : _commands) {
+				switch (command.type) {
+				case CommandType::SHADER:
+					shader = _shaders[command.first];
+					shader->bind();
+					break;
+
+				case CommandType::UNIFORM:
+					if (shader) {
+						dispatch(*shader, command);
+					}
+					break;
+
+				case CommandType::TEXTURE:
+					RenderAPI::Texture::bind(
+						command.first,
+						static_cast<TextureUnit>(command.format),
+						static_cast<TextureType>(command.second));
+					break;
+
+				case CommandType::RENDER_ARRAY:
+					RenderAPI::RenderArray::bind(command.first);
+					break;
+
+				case CommandType::UNIFORM_BUFFER:
+					RenderAPI::UniformBuffer::bind(command.first, command.second);
+					break;
+
+				case CommandType::DRAW:
+					RenderAPI::Draw::elements(
+						command.first,
+						static_cast<PrimitiveType>(command.format),
+						static_cast<IndexType>(command.count),
+						command.second);
+					break;
+
+				case CommandType::DRAW_INSTANCED:
+					RenderAPI::Draw::instancedElements(
+						command.first,
+						command.second,
+						static_cast<PrimitiveType>(command.format),
+						static_cast<IndexType>(command.count));
+					break;
+
+				case CommandType::DRAW_INDIRECT:
+					if (shader) {
+						submitIndirect(*shader, command);
+					}
+					break;
+				}
+			}
+		}
+
+		void clear() {
+			_commands.clear();
+			_payload.clear();
+			_shaders.clear();
+			_indirect.clear();
+
+			_current = nullptr;
+		}
+
+		const Buffer<Command>& commands() const {
+			return _commands;
+		}
+
+		size_t size() const {
+			return _commands.size();
+		}
+
+		bool empty() const {
+			return _commands.empty();
+		}
+
+	private:
+		template<typename Type>
+		static constexpr UniformType uniformType() {
+			if constexpr (std::is_same_v<Type, int>) return UniformType::INT;
+			else if constexpr (std::is_same_v<Type, uint32_t>) return UniformType::UINT32_T;
+			else if constexpr (std::is_same_v<Type, float>) return UniformType::FLOAT;
+			else if constexpr (std::is_same_v<Type, Vec2>) return UniformType::VEC2;
+			else if constexpr (std::is_same_v<Type, Vec3>) return UniformType::VEC3;
+			else if constexpr (std::is_same_v<Type, Vec4>) return UniformType::VEC4;
+			else if constexpr (std::is_same_v<Type, Mat2>) return UniformType::MAT2;
+			else if constexpr (std::is_same_v<Type, Mat3>) return UniformType::MAT3;
+			else {
+				static_assert(std::is_same_v<Type, Mat4>, "Unsupported uniform type");
+				return UniformType::MAT4;
+			}
+		}
+
+		template<typename Type>
+		void push(UniformKey key, const Type* values, size_t count) {
+			static_assert(sizeof(Type) % sizeof(uint32_t) == 0);
+
+			if (!_current || !count || !_current->active(key)) {
+				return;
+			}
+
+			Command command{ CommandType::UNIFORM };
+			command.format = static_cast<uint8_t>(uniformType<Type>());
+			command.count = static_cast<uint16_t>(count);
+			command.first = static_cast<uint32_t>(_payload.size());
+			command.key = key.hash;
+
+			_payload.resize(_payload.size() + count * sizeof(Type) / sizeof(uint32_t));
+			std::memcpy(_payload.data() + command.first, values, count * sizeof(Type));
+
+			_commands.push_back(command);
+		}
+
+		template<typename Type>
+		void upload(const Shader& shader, const Command& command) const {
+			const Type* values{ reinterpret_cast<const Type*>(_payload.data() + command.first) };
+
+			UniformKey key{};
+			key.hash = command.key;
+
+			shader.uniform(key, values, command.count);
+		}
+
+		// Without multi-draw support each command is drawn on its own; its draw index attribute
+		// then starts at zero, so the command's first draw is passed through uDrawBase instead.
+		void submitIndirect(const Shader& shader, const Command& command) const {
+			const IndirectCommand* commands{ _indirect.data() + command.first };
+			PrimitiveType type{ static_cast<PrimitiveType>(command.format) };
+			IndexType index{ static_cast<IndexType>(command.count) };
+
+			if (RenderAPI::Draw::indirectSupported()) {
+				shader.uniform(drawBase, 0);
+				RenderAPI::Draw::indirectElements(commands, command.second, type, index);
+				return;
+			}
+
+			for (uint32_t i{}; i < command.second; ++i) {
+				shader.uniform(drawBase, static_cast<int>(commands[i].baseInstance));
+				RenderAPI::Draw::elements(commands[i], type, index);
+			}
+		}
+
+		void dispatch(const Shader& shader, const Command& command) const {
+			switch (static_cast<UniformType>(command.format)) {
+			case UniformType::INT: upload<int>(shader, command); break;
+			case UniformType::UINT32_T: upload<uint32_t>(shader, command); break;
+			case UniformType::FLOAT: upload<float>(shader, command); break;
+			case UniformType::VEC2: upload<Vec2>(shader, command); break;
+			case UniformType::VEC3: upload<Vec3>(shader, command); break;
+			case UniformType::VEC4: upload<Vec4>(shader, command); break;
+			case UniformType::MAT2: upload<Mat2>(shader, command); break;
+			case UniformType::MAT3: upload<Mat3>(shader, command); break;
+			case UniformType::MAT4: upload<Mat4>(shader, command); break;
+			default: break;
+			}
+		}
+	};
+
+	// Splits a range into chunks recorded on the job system, then appends them in order.
+	class CommandRecorder {
+	private:
+		Buffer<CommandList> _lists;
+
+	public:
+		static constexpr size_t minimumChunk{ 256 };
+		static constexpr size_t chunksPerThread{ 4 };
+
+		template<typename Record>
+		void record(size_t count, CommandList& target, const Record& record) {
+			JobSystem& jobs{ JobSystem::shared() };
+
+			size_t threads{ jobs.workerCount() + 1 };
+			size_t chunkCount{ std::min((count + minimumChunk - 1) / minimumChunk, threads * chunksPerThread) };
+
+			if (chunkCount <= 1) {
+				record(target, 0, count);
+				return;
+			}
+
+			size_t chunkSize{ (count + chunkCount - 1) / chunkCount };
+			if (_lists.size() < chunkCount) {
+				_lists.resize(chunkCount);
+			}
+
+			jobs.parallelFor(chunkCount, [this, &record, count, chunkSize](size_t chunk) {
+				CommandList& list{ _lists[chunk] };
+				list.clear();
+
+				size_t begin{ std::min(chunk * chunkSize, count) };
+				record(list, begin, std::min(begin + chunkSize, count));
+			});
+
+			for (size_t i{}; i < chunkCount; ++i) {
+				target.append(_lists[i]);
+			}
+		}
+	};
+
+}
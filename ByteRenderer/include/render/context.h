@@ -27,6 +27,10 @@ namespace Byte {
             Transform* transform;
             MeshRenderer* meshRenderer;
             RenderMode mode{ RenderMode::ENABLED };
+
+            // Levels of detail picked by culling, kept between frames for hysteresis.
+            uint8_t lod{};
+            uint8_t shadowLod{};
         };
 
         template<typename Type>
@@ -53,6 +57,9 @@ namespace Byte {
 
         ShaderInputMap _inputMap;
 
+        float _time{};
+        Vec3 _wind{};
+
     public:
         RenderID submit(Mesh& mesh, Material& material, Transform& transform, MeshRenderer& meshRenderer) {
             RenderID id{ RenderIDGenerator::generate() };
@@ -60,6 +67,12 @@ namespace Byte {
             return id;
         }
 
+        // Keeps a known id, e.g. when rebuilding a captured frame in its original order.
+        RenderID submit(RenderID id, Mesh& mesh, Material& material, Transform& transform, MeshRenderer& meshRenderer) {
+            _renderEntities.emplace(id, RenderEntity{ &mesh, &material, &transform, &meshRenderer });
+            return id;
+        }
+
         RenderID submit(
             const InstanceTag& tag,
             Mesh& mesh,
@@ -104,6 +117,11 @@ namespace Byte {
             return id;
         }
 
+        RenderID submit(RenderID id, PointLight& light, Transform& lightTransform) {
+            _pointLights.emplace(id, RenderItem<PointLight>{ &light, &lightTransform });
+            return id;
+        }
+
         template<typename Type>
         Type& input(const UniformTag& tag) {
             return std::get<ShaderInput<Type>>(_inputMap.at(tag)).value;
@@ -119,6 +137,22 @@ namespace Byte {
             _inputMap.emplace(tag, std::forward<ShaderInput<Type>>(shaderInput));
         }
 
+        float time() const {
+            return _time;
+        }
+
+        void time(float value) {
+            _time = value;
+        }
+
+        const Vec3& wind() const {
+            return _wind;
+        }
+
+        void wind(const Vec3& value) {
+            _wind = value;
+        }
+
         ShaderInputMap& shaderInputMap() {
             return _inputMap;
         }
@@ -167,6 +201,10 @@ namespace Byte {
             return _directionalLight;
         }
 
+        const RenderItem<DirectionalLight>& directionalLight() const {
+            return _directionalLight;
+        }
+
         const RenderItem<PointLight>& pointLight(RenderID id) const {
             return _pointLights.at(id);
         }
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "core/transform.h"
+#include "render_type.h"
+#include "render_api.h"
+#include "mesh_arena.h"
+
+namespace Byte {
+
+	// Per-draw data of indirect draws in a texture buffer, three RGBA32F texels per draw:
+	// position and material index; scale times the slice's position scale; rotation.
+	// Refilled by the pass every frame.
+	// Queued draws of the same group and arena slice are written next to each other, so
+	// each run becomes one instanced command.
+	class DrawBuffer {
+	public:
+		static constexpr size_t texels{ 3 };
+		static constexpr size_t stride{ texels * 4 };
+
+	private:
+		struct Queued {
+			uint32_t group{};
+			uint32_t order{};
+			const MeshArena::Slice* slice{};
+			const Transform* transform{};
+			uint32_t material{};
+		};
+
+		Buffer<float> _values;
+		Buffer<Queued> _queued;
+
+		uint32_t _buffer{};
+		TextureID _texture{};
+		size_t _capacity{};
+
+	public:
+		DrawBuffer() = default;
+
+		DrawBuffer(const DrawBuffer&) = delete;
+
+		DrawBuffer(DrawBuffer&& right) noexcept
+			:_values{ std::move(right._values) },
+			_queued{ std::move(right._queued) },
+			_buffer{ right._buffer },
+			_texture{ right._texture },
+			_capacity{ right._capacity } {
+			right._buffer = 0;
+			right._texture = 0;
+			right._capacity = 0;
+		}
+
+		DrawBuffer& operator=(const DrawBuffer&) = delete;
+
+		DrawBuffer& operator=(DrawBuffer&& right) noexcept {
+			release();
+
+			_values = std::move(right._values);
+			_queued = std::move(right._queued);
+			_buffer = right._buffer;
+			_texture = right._texture;
+			_capacity = right._capacity;
+
+			right._buffer = 0;
+			right._texture = 0;
+			right._capacity = 0;
+
+			return *this;
+		}
+
+		~DrawBuffer() {
+			release();
+		}
+
+		uint32_t push(
+			const Transform& transform,
+			uint32_t material = 0,
+			float positionScale = 1.0f,
+			const Vec3& positionOffset = Vec3{}) {
+			const Quaternion& rotation{ transform.rotation() };
+			Vec3 position{ transform.position() + rotation * (transform.scale() * positionOffset) };
+			Vec3 scale{ transform.scale() * positionScale };
+
+			float values[stride]{
+				position.x, position.y, position.z, static_cast<float>(material),
+				scale.x, scale.y, scale.z, 0.0f,
+				rotation.x, rotation.y, rotation.z, rotation.w
+			};
+
+			uint32_t index{ static_cast<uint32_t>(size()) };
+			_values.insert(_values.end(), values, values + stride);
+
+			return index;
+		}
+
+		void queue(uint32_t group, const MeshArena::Slice& slice, const Transform& transform, uint32_t material = 0) {
+			uint32_t order{ static_cast<uint32_t>(_queued.size()) };
+			_queued.push_back(Queued{ group, order, &slice, &transform, material });
+		}
+
+		// Writes the queued draws ordered by group and slice and emits one command per run.
+		template<typename Emit>
+		void flush(const Emit& emit) {
+			std::sort(_queued.begin(), _queued.end(), [](const Queued& left, const Queued& right) {
+				if (left.group != right.group) {
+					return left.group < right.group;
+				}
+
+				if (left.slice->firstIndex != right.slice->firstIndex) {
+					return left.slice->firstIndex < right.slice->firstIndex;
+				}
+
+				return left.order < right.order;
+			});
+
+			for (size_t first{}; first < _queued.size();) {
+				const Queued& run{ _queued[first] };
+				uint32_t firstDraw{ static_cast<uint32_t>(size()) };
+
+				size_t last{ first };
+				for (; last < _queued.size() && _queued[last].group == run.group && _queued[last].slice == run.slice; ++last) {
+					push(*_queued[last].transform, _queued[last].material, run.slice->positionScale, run.slice->positionOffset);
+				}
+
+				emit(run.group, MeshArena::command(*run.slice, firstDraw, static_cast<uint32_t>(last - first)));
+				first = last;
+			}
+
+			_queued.clear();
+		}
+
+		void upload() {
+			size_t draws{ size() };
+			if (!draws) {
+				return;
+			}
+
+			if (draws > _capacity) {
+				size_t capacity{ std::max(draws, _capacity * 2) };
+				release();
+
+				_capacity = capacity;
+				RenderAPI::TextureBuffer::build(_buffer, _texture, _capacity * stride * sizeof(float));
+			}
+
+			RenderAPI::TextureBuffer::upload(_buffer, _values.data(), 0, _values.size() * sizeof(float));
+		}
+
+		void clear() {
+			_values.clear();
+			_queued.clear();
+		}
+
+		size_t queued() const {
+			return _queued.size();
+		}
+
+		size_t size() const {
+			return _values.size() / stride;
+		}
+
+		bool empty() const {
+			return _values.empty();
+		}
+
+		TextureID texture() const {
+			return _texture;
+		}
+
+		void release() {
+			if (_buffer) {
+				RenderAPI::TextureBuffer::release(_buffer, _texture);
+				_buffer = 0;
+				_texture = 0;
+				_capacity = 0;
+			}
+		}
+	};
+
+}
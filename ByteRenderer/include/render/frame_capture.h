@@ -0,0 +1,809 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <variant>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "core/mesh.h"
+#include "core/material.h"
+#include "core/transform.h"
+#include "renderer.h"
+
+namespace Byte {
+
+	enum class CaptureRecord : uint8_t {
+		MESH,
+		TEXTURE,
+		MATERIAL,
+		SHADER,
+		FRAME,
+		END,
+	};
+
+	// Little-endian blob: a header, then resource records, each written once before the first
+	// frame that references it, and one FRAME record per captured frame.
+	struct CaptureFormat {
+		static constexpr char magic[8]{ 'B', 'Y', 'T', 'E', 'C', 'A', 'P', '\0' };
+		static constexpr uint32_t version{ 8 };
+
+		// Plain values are stored as their bytes; math types are flat float layouts.
+		template<typename Type>
+		static constexpr bool raw{ std::is_standard_layout_v<Type> && std::is_trivially_destructible_v<Type> };
+
+		template<typename Type>
+		static void write(std::ostream& stream, const Type& value) {
+			static_assert(raw<Type>);
+			stream.write(reinterpret_cast<const char*>(&value), sizeof(Type));
+		}
+
+		static void write(std::ostream& stream, const std::string& value) {
+			write(stream, static_cast<uint32_t>(value.size()));
+			stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+		}
+
+		template<typename Type>
+		static void write(std::ostream& stream, std::span<const Type> values) {
+			static_assert(raw<Type>);
+			write(stream, static_cast<uint32_t>(values.size()));
+			stream.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(Type)));
+		}
+
+		template<typename Type>
+		static void write(std::ostream& stream, const Buffer<Type>& values) {
+			write(stream, std::span<const Type>{ values });
+		}
+
+		static void write(std::ostream& stream, const Transform& transform) {
+			write(stream, transform.position());
+			write(stream, transform.scale());
+			write(stream, transform.rotation());
+		}
+
+		template<typename... Types>
+		static void write(std::ostream& stream, const std::variant<Types...>& value) {
+			write(stream, static_cast<uint8_t>(value.index()));
+			std::visit([&stream](const auto& alternative) {
+				write(stream, alternative);
+			}, value);
+		}
+
+		template<typename Type>
+		static void read(std::istream& stream, Type& value) {
+			static_assert(raw<Type>);
+			if (!stream.read(reinterpret_cast<char*>(&value), sizeof(Type))) {
+				throw std::exception("Truncated frame capture");
+			}
+		}
+
+		template<typename Type>
+		static Type read(std::istream& stream) {
+			Type value{};
+			read(stream, value);
+
+			return value;
+		}
+
+		static void read(std::istream& stream, std::string& value) {
+			value.resize(read<uint32_t>(stream));
+			if (!stream.read(value.data(), static_cast<std::streamsize>(value.size()))) {
+				throw std::exception("Truncated frame capture");
+			}
+		}
+
+		template<typename Type>
+		static void read(std::istream& stream, Buffer<Type>& values) {
+			values.resize(read<uint32_t>(stream));
+			if (!stream.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(Type)))) {
+				throw std::exception("Truncated frame capture");
+			}
+		}
+
+		static void read(std::istream& stream, Transform& transform) {
+			Vec3 position{ read<Vec3>(stream) };
+			Vec3 scale{ read<Vec3>(stream) };
+			Quaternion rotation{ read<Quaternion>(stream) };
+
+			transform.position(position);
+			transform.scale(scale);
+			transform.rotation(rotation);
+		}
+
+		template<typename... Types>
+		static void read(std::istream& stream, std::variant<Types...>& value) {
+			readAlternative(stream, read<uint8_t>(stream), value);
+		}
+
+	private:
+		template<size_t Index = 0, typename Variant>
+		static void readAlternative(std::istream& stream, size_t index, Variant& value) {
+			if constexpr (Index < std::variant_size_v<Variant>) {
+				if (index == Index) {
+					std::variant_alternative_t<Index, Variant> alternative{};
+					read(stream, alternative);
+					value = std::move(alternative);
+					return;
+				}
+
+				readAlternative<Index + 1>(stream, index, value);
+			}
+			else {
+				throw std::exception("Unknown value type in frame capture");
+			}
+		}
+	};
+
+	// Records what the renderer is given each frame. Meshes, textures and shader paths are written
+	// once; materials again when their revision changes, and instance data only when it differs
+	// from the previous frame.
+	class FrameCapture {
+	private:
+		std::ofstream _file;
+
+		std::unordered_map<const Mesh*, uint32_t> _meshes;
+		std::unordered_map<const Texture*, uint32_t> _textures;
+		std::unordered_map<const Material*, uint32_t> _materials;
+		std::unordered_map<const Material*, uint64_t> _revisions;
+		std::unordered_set<ShaderTag> _shaders;
+		std::unordered_map<InstanceTag, Buffer<float>> _instanceData;
+
+		size_t _frames{};
+
+	public:
+		FrameCapture() = default;
+
+		explicit FrameCapture(const Path& path) {
+			open(path);
+		}
+
+		FrameCapture(const FrameCapture&) = delete;
+
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		~FrameCapture() {
+			close();
+		}
+
+		void open(const Path& path) {
+			close();
+
+			_file.open(path, std::ios::binary | std::ios::trunc);
+			if (!_file) {
+				throw std::exception("Cannot open frame capture file");
+			}
+
+			_file.write(CaptureFormat::magic, sizeof(CaptureFormat::magic));
+			CaptureFormat::write(_file, CaptureFormat::version);
+
+			_meshes.clear();
+			_textures.clear();
+			_materials.clear();
+			_revisions.clear();
+			_shaders.clear();
+			_instanceData.clear();
+			_frames = 0;
+		}
+
+		void close() {
+			if (_file.is_open()) {
+				CaptureFormat::write(_file, CaptureRecord::END);
+				_file.close();
+			}
+		}
+
+		bool recording() const {
+			return _file.is_open();
+		}
+
+		size_t frames() const {
+			return _frames;
+		}
+
+		// Call after the context is set up for the frame and before Renderer::render.
+		void capture(const Renderer& renderer, float deltaTime) {
+			if (!recording()) {
+				return;
+			}
+
+			const RenderContext& context{ renderer.context() };
+			const RenderData& data{ renderer.data() };
+
+			for (const auto& [id, entity] : context.renderEntities()) {
+				mesh(*entity.mesh);
+				material(*entity.material, data);
+			}
+
+			for (const auto& [tag, instance] : context.instances()) {
+				mesh(instance.mesh());
+				material(instance.material(), data);
+			}
+
+			CaptureFormat::write(_file, CaptureRecord::FRAME);
+			CaptureFormat::write(_file, deltaTime);
+			CaptureFormat::write(_file, static_cast<uint32_t>(data.width));
+			CaptureFormat::write(_file, static_cast<uint32_t>(data.height));
+			CaptureFormat::write(_file, context.time());
+			CaptureFormat::write(_file, context.wind());
+
+			CaptureFormat::write(_file, static_cast<uint32_t>(context.shaderInputMap().size()));
+			for (const auto& [tag, input] : context.shaderInputMap()) {
+				CaptureFormat::write(_file, tag);
+				CaptureFormat::write(_file, input);
+			}
+
+			CaptureFormat::write(_file, static_cast<uint32_t>(data.parameters.size()));
+			for (const auto& [tag, parameter] : data.parameters) {
+				CaptureFormat::write(_file, tag);
+				CaptureFormat::write(_file, parameter);
+			}
+
+			const auto& camera{ context.camera() };
+			CaptureFormat::write(_file, static_cast<uint8_t>(camera.item != nullptr));
+			if (camera.item) {
+				CaptureFormat::write(_file, camera.item->fov());
+				CaptureFormat::write(_file, camera.item->nearPlane());
+				CaptureFormat::write(_file, camera.item->farPlane());
+				CaptureFormat::write(_file, *camera.transform);
+			}
+
+			const auto& light{ context.directionalLight() };
+			CaptureFormat::write(_file, static_cast<uint8_t>(light.item != nullptr));
+			if (light.item) {
+				CaptureFormat::write(_file, *light.item);
+				CaptureFormat::write(_file, *light.transform);
+			}
+
+			CaptureFormat::write(_file, static_cast<uint32_t>(context.pointLights().size()));
+			for (const auto& [id, pointLight] : context.pointLights()) {
+				CaptureFormat::write(_file, id);
+				CaptureFormat::write(_file, *pointLight.item);
+				CaptureFormat::write(_file, *pointLight.transform);
+			}
+
+			CaptureFormat::write(_file, static_cast<uint32_t>(context.renderEntities().size()));
+			for (const auto& [id, entity] : context.renderEntities()) {
+				CaptureFormat::write(_file, id);
+				CaptureFormat::write(_file, _meshes.at(entity.mesh));
+				CaptureFormat::write(_file, _materials.at(entity.material));
+				CaptureFormat::write(_file, entity.meshRenderer->primitive());
+				CaptureFormat::write(_file, entity.mode);
+				CaptureFormat::write(_file, *entity.transform);
+			}
+
+			CaptureFormat::write(_file, static_cast<uint32_t>(context.instances().size()));
+			for (const auto& [tag, instance] : context.instances()) {
+				CaptureFormat::write(_file, tag);
+				CaptureFormat::write(_file, _meshes.at(&instance.mesh()));
+				CaptureFormat::write(_file, _materials.at(&instance.material()));
+				CaptureFormat::write(_file, instance.meshRenderer().primitive());
+				CaptureFormat::write(_file, instance.renderMode());
+				CaptureFormat::write(_file, instance.layout());
+
+				Buffer<float>& previous{ _instanceData[tag] };
+				bool changed{ previous.size() != instance.data().size() ||
+					std::memcmp(previous.data(), instance.data().data(), previous.size() * sizeof(float)) != 0 };
+
+				CaptureFormat::write(_file, static_cast<uint8_t>(changed || _frames == 0));
+				if (changed || _frames == 0) {
+					CaptureFormat::write(_file, instance.data());
+					previous = instance.data();
+				}
+			}
+
+			++_frames;
+		}
+
+	private:
+		void mesh(const Mesh& source) {
+			if (_meshes.count(&source)) {
+				return;
+			}
+
+			uint32_t index{ static_cast<uint32_t>(_meshes.size()) };
+			_meshes.emplace(&source, index);
+
+			const MeshData& data{ source.data() };
+
+			CaptureFormat::write(_file, CaptureRecord::MESH);
+			CaptureFormat::write(_file, index);
+			CaptureFormat::write(_file, data.vertices);
+			CaptureFormat::write(_file, data.indices);
+			CaptureFormat::write(_file, data.mode);
+			CaptureFormat::write(_file, data.bounds);
+			CaptureFormat::write(_file, data.vertexLayout);
+			CaptureFormat::write(_file, data.vertexTypes);
+			CaptureFormat::write(_file, data.ranges);
+
+			CaptureFormat::write(_file, static_cast<uint32_t>(data.lods.size()));
+			for (const MeshLod& lod : data.lods) {
+				CaptureFormat::write(_file, lod.indices);
+				CaptureFormat::write(_file, lod.error);
+			}
+
+			CaptureFormat::write(_file, data.packed.bytes());
+			CaptureFormat::write(_file, static_cast<uint32_t>(data.packed.stride));
+			CaptureFormat::write(_file, data.packed.positionScale);
+			CaptureFormat::write(_file, data.packed.positionOffset);
+		}
+
+		void texture(const Texture& source) {
+			if (_textures.count(&source)) {
+				return;
+			}
+
+			uint32_t index{ static_cast<uint32_t>(_textures.size()) };
+			_textures.emplace(&source, index);
+
+			const TextureData& data{ source.data() };
+
+			CaptureFormat::write(_file, CaptureRecord::TEXTURE);
+			CaptureFormat::write(_file, index);
+			CaptureFormat::write(_file, data.attachment);
+			CaptureFormat::write(_file, data.internalFormat);
+			CaptureFormat::write(_file, data.format);
+			CaptureFormat::write(_file, data.dataType);
+			CaptureFormat::write(_file, static_cast<uint32_t>(data.width));
+			CaptureFormat::write(_file, static_cast<uint32_t>(data.height));
+			CaptureFormat::write(_file, data.wrapS);
+			CaptureFormat::write(_file, data.wrapT);
+			CaptureFormat::write(_file, data.minFilter);
+			CaptureFormat::write(_file, data.magFilter);
+			CaptureFormat::write(_file, data.type);
+			CaptureFormat::write(_file, static_cast<uint32_t>(data.layerCount));
+			CaptureFormat::write(_file, data.path.string());
+			CaptureFormat::write(_file, data.data);
+		}
+
+		void shader(const ShaderTag& tag, const RenderData& data) {
+			auto result{ data.shaders.find(tag) };
+			if (result == data.shaders.end() || !_shaders.insert(tag).second) {
+				return;
+			}
+
+			const ShaderPath& path{ result->second.path() };
+
+			CaptureFormat::write(_file, CaptureRecord::SHADER);
+			CaptureFormat::write(_file, tag);
+			CaptureFormat::write(_file, path.vertex.string());
+			CaptureFormat::write(_file, path.fragment.string());
+			CaptureFormat::write(_file, path.geometry.string());
+			CaptureFormat::write(_file, path.tessellationControl.string());
+			CaptureFormat::write(_file, path.tessellationEvaluation.string());
+		}
+
+		void material(const Material& source, const RenderData& data) {
+			auto [revision, added] = _revisions.try_emplace(&source, source.revision());
+			if (!added && revision->second == source.revision()) {
+				return;
+			}
+
+			revision->second = source.revision();
+
+			for (const auto& [tag, texture] : source.textureMap()) {
+				this->texture(*texture);
+			}
+
+			for (const auto& [pass, shader] : source.shaderMap()) {
+				this->shader(shader, data);
+			}
+
+			auto result{ _materials.find(&source) };
+			uint32_t index{ result != _materials.end() ? result->second : static_cast<uint32_t>(_materials.size()) };
+			_materials.emplace(&source, index);
+
+			const MaterialData& material{ source.data() };
+
+			CaptureFormat::write(_file, CaptureRecord::MATERIAL);
+			CaptureFormat::write(_file, index);
+
+			CaptureFormat::write(_file, static_cast<uint32_t>(material.shaderMap.size()));
+			for (const auto& [pass, shader] : material.shaderMap) {
+				CaptureFormat::write(_file, pass);
+				CaptureFormat::write(_file, shader);
+			}
+
+			CaptureFormat::write(_file, material.albedo);
+			CaptureFormat::write(_file, material.metallic);
+			CaptureFormat::write(_file, material.roughness);
+			CaptureFormat::write(_file, material.ambientOcclusion);
+			CaptureFormat::write(_file, material.emission);
+
+			CaptureFormat::write(_file, static_cast<uint32_t>(material.textureMap.size()));
+			for (const auto& [tag, texture] : material.textureMap) {
+				CaptureFormat::write(_file, tag);
+				CaptureFormat::write(_file, _textures.at(texture));
+			}
+
+			CaptureFormat::write(_file, static_cast<uint32_t>(material.layers.size()));
+			for (const auto& [tag, layer] : material.layers) {
+				CaptureFormat::write(_file, tag);
+				CaptureFormat::write(_file, layer);
+			}
+
+			CaptureFormat::write(_file, material.shadow);
+			CaptureFormat::write(_file, material.transparency);
+		}
+	};
+
+	// Rebuilds captured frames into a renderer's context. Entities and point lights keep their
+	// captured ids so they are visited in the same order on every replay. Frames restore the
+	// recorded context time, so replay reproduces the recorded timing rather than a fixed step.
+	class FrameReplay {
+	private:
+		struct ReplayEntity {
+			Transform transform;
+			MeshRenderer renderer;
+		};
+
+		struct ReplayLight {
+			PointLight light;
+			Transform transform;
+		};
+
+		std::ifstream _file;
+
+		std::unordered_map<uint32_t, Mesh> _meshes;
+		std::unordered_map<uint32_t, Texture> _textures;
+		std::unordered_map<uint32_t, Material> _materials;
+
+		std::unordered_map<RenderID, ReplayEntity> _entities;
+		std::unordered_map<RenderID, ReplayLight> _pointLights;
+		std::unordered_map<InstanceTag, MeshRenderer> _instanceRenderers;
+
+		Camera _camera;
+		Transform _cameraTransform;
+		DirectionalLight _directionalLight;
+		Transform _directionalLightTransform;
+
+		float _deltaTime{};
+		size_t _frame{};
+
+	public:
+		explicit FrameReplay(const Path& path)
+			: _file{ path, std::ios::binary } {
+			char magic[sizeof(CaptureFormat::magic)]{};
+			if (!_file.read(magic, sizeof(magic)) || std::memcmp(magic, CaptureFormat::magic, sizeof(magic)) != 0) {
+				throw std::exception("Not a frame capture file");
+			}
+
+			if (CaptureFormat::read<uint32_t>(_file) != CaptureFormat::version) {
+				throw std::exception("Unsupported frame capture version");
+			}
+		}
+
+		FrameReplay(const FrameReplay&) = delete;
+
+		FrameReplay& operator=(const FrameReplay&) = delete;
+
+		// Loads the next frame into renderer; returns false once the capture is exhausted.
+		bool next(Renderer& renderer) {
+			while (true) {
+				CaptureRecord record{};
+				if (!_file.read(reinterpret_cast<char*>(&record), sizeof(record)) || record == CaptureRecord::END) {
+					return false;
+				}
+
+				switch (record) {
+				case CaptureRecord::MESH:
+					readMesh();
+					break;
+				case CaptureRecord::TEXTURE:
+					readTexture();
+					break;
+				case CaptureRecord::MATERIAL:
+					readMaterial();
+					break;
+				case CaptureRecord::SHADER:
+					readShader(renderer);
+					break;
+				case CaptureRecord::FRAME:
+					readFrame(renderer);
+					++_frame;
+					return true;
+				default:
+					throw std::exception("Corrupt frame capture");
+				}
+			}
+		}
+
+		// Frame time the capture was recorded with.
+		float deltaTime() const {
+			return _deltaTime;
+		}
+
+		size_t frame() const {
+			return _frame;
+		}
+
+	private:
+		void readMesh() {
+			uint32_t index{ CaptureFormat::read<uint32_t>(_file) };
+
+			MeshData data;
+			CaptureFormat::read(_file, data.vertices);
+			CaptureFormat::read(_file, data.indices);
+			CaptureFormat::read(_file, data.mode);
+			CaptureFormat::read(_file, data.bounds);
+			CaptureFormat::read(_file, data.vertexLayout);
+			CaptureFormat::read(_file, data.vertexTypes);
+			CaptureFormat::read(_file, data.ranges);
+
+			data.lods.resize(CaptureFormat::read<uint32_t>(_file));
+			for (MeshLod& lod : data.lods) {
+				CaptureFormat::read(_file, lod.indices);
+				CaptureFormat::read(_file, lod.error);
+			}
+
+			CaptureFormat::read(_file, data.packed.vertices);
+			data.packed.stride = CaptureFormat::read<uint32_t>(_file);
+			CaptureFormat::read(_file, data.packed.positionScale);
+			CaptureFormat::read(_file, data.packed.positionOffset);
+
+			_meshes.insert_or_assign(index, Mesh{ std::move(data) });
+		}
+
+		void readTexture() {
+			uint32_t index{ CaptureFormat::read<uint32_t>(_file) };
+
+			TextureData data;
+			CaptureFormat::read(_file, data.attachment);
+			CaptureFormat::read(_file, data.internalFormat);
+			CaptureFormat::read(_file, data.format);
+			CaptureFormat::read(_file, data.dataType);
+			data.width = CaptureFormat::read<uint32_t>(_file);
+			data.height = CaptureFormat::read<uint32_t>(_file);
+			CaptureFormat::read(_file, data.wrapS);
+			CaptureFormat::read(_file, data.wrapT);
+			CaptureFormat::read(_file, data.minFilter);
+			CaptureFormat::read(_file, data.magFilter);
+			CaptureFormat::read(_file, data.type);
+			data.layerCount = CaptureFormat::read<uint32_t>(_file);
+
+			std::string path;
+			CaptureFormat::read(_file, path);
+			data.path = path;
+
+			CaptureFormat::read(_file, data.data);
+
+			_textures.insert_or_assign(index, Texture{ std::move(data) });
+		}
+
+		void readMaterial() {
+			uint32_t index{ CaptureFormat::read<uint32_t>(_file) };
+
+			MaterialData data;
+
+			uint32_t shaderCount{ CaptureFormat::read<uint32_t>(_file) };
+			for (uint32_t i{}; i < shaderCount; ++i) {
+				std::string pass;
+				ShaderTag shader;
+				CaptureFormat::read(_file, pass);
+				CaptureFormat::read(_file, shader);
+				data.shaderMap.emplace(std::move(pass), std::move(shader));
+			}
+
+			CaptureFormat::read(_file, data.albedo);
+			CaptureFormat::read(_file, data.metallic);
+			CaptureFormat::read(_file, data.roughness);
+			CaptureFormat::read(_file, data.ambientOcclusion);
+			CaptureFormat::read(_file, data.emission);
+
+			uint32_t textureCount{ CaptureFormat::read<uint32_t>(_file) };
+			for (uint32_t i{}; i < textureCount; ++i) {
+				TextureTag tag;
+				CaptureFormat::read(_file, tag);
+				data.textureMap.emplace(std::move(tag), &_textures.at(CaptureFormat::read<uint32_t>(_file)));
+			}
+
+			uint32_t layerCount{ CaptureFormat::read<uint32_t>(_file) };
+			for (uint32_t i{}; i < layerCount; ++i) {
+				TextureTag tag;
+				CaptureFormat::read(_file, tag);
+				data.layers.emplace(std::move(tag), CaptureFormat::read<uint32_t>(_file));
+			}
+
+			CaptureFormat::read(_file, data.shadow);
+			CaptureFormat::read(_file, data.transparency);
+
+			_materials[index].data(data);
+		}
+
+		void readShader(Renderer& renderer) {
+			ShaderTag tag;
+			std::string paths[5];
+
+			CaptureFormat::read(_file, tag);
+			for (auto& path : paths) {
+				CaptureFormat::read(_file, path);
+			}
+
+			auto& shaders{ renderer.data().shaders };
+			if (!shaders.count(tag)) {
+				shaders.emplace(tag, Shader{ paths[0], paths[1], paths[2], paths[3], paths[4] });
+				renderer.compileShaders();
+			}
+		}
+
+		void readFrame(Renderer& renderer) {
+			RenderContext& context{ renderer.context() };
+			RenderData& data{ renderer.data() };
+
+			CaptureFormat::read(_file, _deltaTime);
+
+			size_t width{ CaptureFormat::read<uint32_t>(_file) };
+			size_t height{ CaptureFormat::read<uint32_t>(_file) };
+			if (width != data.width || height != data.height) {
+				renderer.resize(width, height);
+			}
+
+			context.time(CaptureFormat::read<float>(_file));
+			context.wind(CaptureFormat::read<Vec3>(_file));
+
+			uint32_t inputCount{ CaptureFormat::read<uint32_t>(_file) };
+			for (uint32_t i{}; i < inputCount; ++i) {
+				UniformTag tag;
+				CaptureFormat::read(_file, tag);
+				CaptureFormat::read(_file, context.shaderInputMap()[tag]);
+			}
+
+			uint32_t parameterCount{ CaptureFormat::read<uint32_t>(_file) };
+			for (uint32_t i{}; i < parameterCount; ++i) {
+				ParameterTag tag;
+				CaptureFormat::read(_file, tag);
+				CaptureFormat::read(_file, data.parameters[tag]);
+			}
+
+			if (CaptureFormat::read<uint8_t>(_file)) {
+				_camera.fov(CaptureFormat::read<float>(_file));
+				_camera.nearPlane(CaptureFormat::read<float>(_file));
+				_camera.farPlane(CaptureFormat::read<float>(_file));
+				CaptureFormat::read(_file, _cameraTransform);
+
+				context.submit(_camera, _cameraTransform);
+			}
+
+			if (CaptureFormat::read<uint8_t>(_file)) {
+				CaptureFormat::read(_file, _directionalLight);
+				CaptureFormat::read(_file, _directionalLightTransform);
+
+				context.submit(_directionalLight, _directionalLightTransform);
+			}
+
+			readPointLights(context);
+			readEntities(context);
+			readInstances(context);
+		}
+
+		void readPointLights(RenderContext& context) {
+			std::unordered_set<RenderID> seen;
+
+			uint32_t count{ CaptureFormat::read<uint32_t>(_file) };
+			for (uint32_t i{}; i < count; ++i) {
+				RenderID id{ CaptureFormat::read<RenderID>(_file) };
+				seen.insert(id);
+
+				ReplayLight& light{ _pointLights[id] };
+				CaptureFormat::read(_file, light.light);
+				CaptureFormat::read(_file, light.transform);
+
+				if (!context.pointLights().count(id)) {
+					context.submit(id, light.light, light.transform);
+				}
+			}
+
+			for (auto it{ _pointLights.begin() }; it != _pointLights.end();) {
+				if (!seen.count(it->first)) {
+					context.eraseItem(it->first);
+					it = _pointLights.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+		}
+
+		void readEntities(RenderContext& context) {
+			std::unordered_set<RenderID> seen;
+
+			uint32_t count{ CaptureFormat::read<uint32_t>(_file) };
+			for (uint32_t i{}; i < count; ++i) {
+				RenderID id{ CaptureFormat::read<RenderID>(_file) };
+				Mesh& mesh{ _meshes.at(CaptureFormat::read<uint32_t>(_file)) };
+				Material& material{ _materials.at(CaptureFormat::read<uint32_t>(_file)) };
+				PrimitiveType primitive{ CaptureFormat::read<PrimitiveType>(_file) };
+				RenderMode mode{ CaptureFormat::read<RenderMode>(_file) };
+
+				seen.insert(id);
+
+				ReplayEntity& entity{ _entities[id] };
+				CaptureFormat::read(_file, entity.transform);
+				entity.renderer.primitive(primitive);
+
+				if (!context.renderEntities().count(id)) {
+					context.submit(id, mesh, material, entity.transform, entity.renderer);
+				}
+
+				RenderContext::RenderEntity& submitted{ context.entity(id) };
+				submitted.mesh = &mesh;
+				submitted.material = &material;
+				submitted.mode = mode;
+			}
+
+			for (auto it{ _entities.begin() }; it != _entities.end();) {
+				if (!seen.count(it->first)) {
+					context.eraseEntity(it->first);
+					it = _entities.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+		}
+
+		void readInstances(RenderContext& context) {
+			std::unordered_set<InstanceTag> seen;
+
+			uint32_t count{ CaptureFormat::read<uint32_t>(_file) };
+			for (uint32_t i{}; i < count; ++i) {
+				InstanceTag tag;
+				CaptureFormat::read(_file, tag);
+
+				Mesh& mesh{ _meshes.at(CaptureFormat::read<uint32_t>(_file)) };
+				Material& material{ _materials.at(CaptureFormat::read<uint32_t>(_file)) };
+				PrimitiveType primitive{ CaptureFormat::read<PrimitiveType>(_file) };
+				RenderMode mode{ CaptureFormat::read<RenderMode>(_file) };
+
+				Buffer<uint8_t> layout;
+				CaptureFormat::read(_file, layout);
+
+				seen.insert(tag);
+
+				MeshRenderer& renderer{ _instanceRenderers[tag] };
+				renderer.primitive(primitive);
+
+				auto& instances{ context.instances() };
+				auto result{ instances.find(tag) };
+				if (result == instances.end()) {
+					result = instances.emplace(tag, InstanceGroup{ mesh, material, renderer, std::move(layout) }).first;
+				}
+
+				InstanceGroup& instance{ result->second };
+				instance.mesh(mesh);
+				instance.material(material);
+				instance.renderMode(mode);
+
+				if (CaptureFormat::read<uint8_t>(_file)) {
+					Buffer<float> values;
+					CaptureFormat::read(_file, values);
+
+					size_t stride{ 0 };
+					for (uint8_t size : instance.layout()) {
+						stride += size;
+					}
+
+					instance.clearInstances();
+					for (size_t offset{}; stride && offset + stride <= values.size(); offset += stride) {
+						Buffer<float> element(values.begin() + offset, values.begin() + offset + stride);
+						instance.add(element, static_cast<RenderID>(offset / stride + 1));
+					}
+				}
+			}
+
+			for (auto it{ _instanceRenderers.begin() }; it != _instanceRenderers.end();) {
+				if (!seen.count(it->first)) {
+					context.eraseInstance(it->first);
+					it = _instanceRenderers.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+		}
+	};
+
+}
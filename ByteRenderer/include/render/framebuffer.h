@@ -9,6 +9,8 @@ namespace Byte {
 	private:
 		FramebufferData _data;
 
+		bool _aliased{ false };
+
 	public:
 		Framebuffer() = default;
 
@@ -17,16 +19,19 @@ namespace Byte {
 		}
 
 		Framebuffer(Framebuffer&& right) noexcept
-			: _data{ std::move(right._data) } {
+			: _data{ std::move(right._data) }, _aliased{ right._aliased } {
 			right._data.id = 0;
 			right._data.attachments.clear();
+			right._aliased = false;
 		}
 
 		Framebuffer& operator=(Framebuffer&& right) noexcept {
 			clear();
 			_data = std::move(right._data);
+			_aliased = right._aliased;
 			right._data.id = 0;
 			right._data.attachments.clear();
+			right._aliased = false;
 
 			return *this;
 		}
@@ -53,14 +58,52 @@ namespace Byte {
 
 		void resize(size_t width, size_t height) {
 			if (_data.resize) {
-				RenderAPI::Framebuffer::release(_data);
+				if (!_aliased) {
+					RenderAPI::Framebuffer::release(_data);
+				}
 				_data.attachments.clear();
 				_data.width = static_cast<size_t>(static_cast<float>(width) * _data.resizeFactor);
 				_data.height = static_cast<size_t>(static_cast<float>(height) * _data.resizeFactor);
+
+				if (!_aliased) {
+					RenderAPI::Framebuffer::build(_data);
+				}
+			}
+		}
+
+		void alias(const Framebuffer& target) {
+			if (!_aliased) {
+				RenderAPI::Framebuffer::release(_data);
+			}
+
+			_data.id = target._data.id;
+			_data.attachments = target._data.attachments;
+
+			for (auto& [tag, texture] : _data.textures) {
+				texture.id = target._data.textures.at(tag).id;
+			}
+
+			_aliased = true;
+		}
+
+		void unalias() {
+			if (_aliased) {
+				_aliased = false;
+				_data.id = 0;
+				_data.attachments.clear();
+
+				for (auto& [tag, texture] : _data.textures) {
+					texture.id = 0;
+				}
+
 				RenderAPI::Framebuffer::build(_data);
 			}
 		}
 
+		bool aliased() const {
+			return _aliased;
+		}
+
 		FramebufferData& data() {
 			return _data;
 		}
@@ -82,12 +125,19 @@ namespace Byte {
 		}
 
 		void clear() {
-			RenderAPI::Framebuffer::release(_data);
+			if (!_aliased) {
+				RenderAPI::Framebuffer::release(_data);
+			}
+			_aliased = false;
 
 			_data.textures.clear();
 			_data.attachments.clear();
 		}
 
+		TextureData& texture(const TextureTag& tag) {
+			return _data.textures.at(tag);
+		}
+
 		TextureID textureID(const TextureTag& tag) const {
 			return _data.textures.at(tag).id;
 		}
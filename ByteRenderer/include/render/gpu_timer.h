@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <algorithm>
+
+#include "core/profiler.h"
+#include "render_type.h"
+#include "render_api.h"
+
+namespace Byte {
+
+	class GPUTimer {
+	public:
+		static constexpr size_t frameCount{ 3 };
+		static constexpr size_t historySize{ 128 };
+		static constexpr size_t calibrationInterval{ 256 };
+
+		struct Sample {
+			uint64_t begin{};
+			uint64_t end{};
+		};
+
+		struct Zone {
+			std::string tag;
+			const char* name{};
+
+			QueryID begins[frameCount]{};
+			QueryID ends[frameCount]{};
+			bool pending[frameCount]{};
+
+			float history[historySize]{};
+			size_t head{};
+			size_t count{};
+
+			Sample last{};
+		};
+
+	private:
+		Buffer<Zone> _zones;
+		Buffer<QueryID> _queries;
+
+		size_t _frame{};
+		size_t _dropped{};
+		bool _enabled{ true };
+
+	public:
+		GPUTimer() = default;
+
+		GPUTimer(const GPUTimer&) = delete;
+
+		GPUTimer(GPUTimer&& right) noexcept
+			:_zones{ std::move(right._zones) },
+			_queries{ std::move(right._queries) },
+			_frame{ right._frame },
+			_dropped{ right._dropped },
+			_enabled{ right._enabled } {
+			right._queries.clear();
+		}
+
+		GPUTimer& operator=(const GPUTimer&) = delete;
+
+		GPUTimer& operator=(GPUTimer&& right) noexcept {
+			clear();
+
+			_zones = std::move(right._zones);
+			_queries = std::move(right._queries);
+			_frame = right._frame;
+			_dropped = right._dropped;
+			_enabled = right._enabled;
+
+			right._queries.clear();
+
+			return *this;
+		}
+
+		~GPUTimer() {
+			clear();
+		}
+
+		size_t zone(std::string_view tag) {
+			Zone zone{ std::string{ tag }, Profiler::intern(tag) };
+
+			Buffer<QueryID> ids(frameCount * 2);
+			RenderAPI::Query::build(ids);
+
+			for (size_t i{}; i < frameCount; ++i) {
+				zone.begins[i] = ids[i * 2];
+				zone.ends[i] = ids[i * 2 + 1];
+			}
+
+			_queries.insert(_queries.end(), ids.begin(), ids.end());
+			_zones.push_back(std::move(zone));
+
+			return _zones.size() - 1;
+		}
+
+		void beginFrame() {
+			if (!_enabled) {
+				return;
+			}
+
+			++_frame;
+			size_t slot{ _frame % frameCount };
+
+			if (_frame % calibrationInterval == 1) {
+				BYTE_PROFILE_CALIBRATE(RenderAPI::Query::time());
+			}
+
+			for (auto& zone : _zones) {
+				if (!zone.pending[slot]) {
+					continue;
+				}
+
+				if (!RenderAPI::Query::available(zone.ends[slot])) {
+					continue;
+				}
+
+				Sample sample{
+					RenderAPI::Query::result(zone.begins[slot]),
+					RenderAPI::Query::result(zone.ends[slot]) };
+
+				zone.last = sample;
+				BYTE_PROFILE_GPU(zone.name, sample.begin, sample.end);
+
+				zone.history[zone.head] = static_cast<float>(sample.end - sample.begin) * 1e-6f;
+				zone.head = (zone.head + 1) % historySize;
+				zone.count = std::min(zone.count + 1, historySize);
+
+				zone.pending[slot] = false;
+			}
+		}
+
+		void begin(size_t index) {
+			if (!_enabled) {
+				return;
+			}
+
+			Zone& zone{ _zones[index] };
+			size_t slot{ _frame % frameCount };
+
+			if (zone.pending[slot]) {
+				++_dropped;
+				return;
+			}
+
+			RenderAPI::Query::timestamp(zone.begins[slot]);
+		}
+
+		void end(size_t index) {
+			if (!_enabled) {
+				return;
+			}
+
+			Zone& zone{ _zones[index] };
+			size_t slot{ _frame % frameCount };
+
+			if (zone.pending[slot]) {
+				return;
+			}
+
+			RenderAPI::Query::timestamp(zone.ends[slot]);
+			zone.pending[slot] = true;
+		}
+
+		float latest(std::string_view tag) const {
+			const Zone* zone{ find(tag) };
+			if (!zone || !zone->count) {
+				return 0.0f;
+			}
+
+			return zone->history[(zone->head + historySize - 1) % historySize];
+		}
+
+		float average(std::string_view tag) const {
+			const Zone* zone{ find(tag) };
+			if (!zone || !zone->count) {
+				return 0.0f;
+			}
+
+			float total{};
+			for (size_t i{}; i < zone->count; ++i) {
+				total += zone->history[i];
+			}
+
+			return total / static_cast<float>(zone->count);
+		}
+
+		float percentile(std::string_view tag, float value) const {
+			const Zone* zone{ find(tag) };
+			if (!zone || !zone->count) {
+				return 0.0f;
+			}
+
+			Buffer<float> sorted(zone->history, zone->history + zone->count);
+
+			float position{ std::clamp(value, 0.0f, 1.0f) * static_cast<float>(sorted.size() - 1) };
+			size_t index{ static_cast<size_t>(position + 0.5f) };
+
+			std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+
+			return sorted[index];
+		}
+
+		float total() const {
+			float sum{};
+			for (const auto& zone : _zones) {
+				sum += average(zone.tag);
+			}
+
+			return sum;
+		}
+
+		const Buffer<Zone>& zones() const {
+			return _zones;
+		}
+
+		size_t dropped() const {
+			return _dropped;
+		}
+
+		bool enabled() const {
+			return _enabled;
+		}
+
+		void enabled(bool value) {
+			_enabled = value;
+		}
+
+		void clear() {
+			RenderAPI::Query::release(_queries);
+
+			_queries.clear();
+			_zones.clear();
+		}
+
+	private:
+		const Zone* find(std::string_view tag) const {
+			auto result{ std::find_if(_zones.begin(), _zones.end(), [tag](const Zone& zone) {
+				return zone.tag == tag;
+			}) };
+
+			return result != _zones.end() ? &*result : nullptr;
+		}
+	};
+
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+#include "core/material.h"
+#include "render_type.h"
+#include "render_api.h"
+#include "shader.h"
+#include "texture.h"
+
+namespace Byte {
+
+	// Keeps one record per material and its packed parameters in a texture buffer, three RGBA32F
+	// texels per record: albedo; metallic, roughness, AO, emission; data mode and texture layers.
+	class MaterialBuffer {
+	public:
+		using ShaderMap = std::unordered_map<ShaderTag, Shader>;
+
+		static constexpr size_t texels{ 3 };
+		static constexpr size_t stride{ texels * 4 };
+
+	private:
+		std::unordered_map<const Material*, MaterialRecord> _records;
+		Buffer<uint32_t> _free;
+		Buffer<float> _values;
+
+		uint64_t _frame{ 1 };
+		size_t _first{ SIZE_MAX };
+		size_t _last{};
+
+		uint32_t _buffer{};
+		TextureID _texture{};
+		size_t _capacity{};
+
+	public:
+		MaterialBuffer() = default;
+
+		MaterialBuffer(const MaterialBuffer&) = delete;
+
+		MaterialBuffer(MaterialBuffer&& right) noexcept
+			:_records{ std::move(right._records) },
+			_free{ std::move(right._free) },
+			_values{ std::move(right._values) },
+			_frame{ right._frame },
+			_first{ right._first },
+			_last{ right._last },
+			_buffer{ right._buffer },
+			_texture{ right._texture },
+			_capacity{ right._capacity } {
+			right._buffer = 0;
+			right._texture = 0;
+			right._capacity = 0;
+		}
+
+		MaterialBuffer& operator=(const MaterialBuffer&) = delete;
+
+		MaterialBuffer& operator=(MaterialBuffer&& right) noexcept {
+			release();
+
+			_records = std::move(right._records);
+			_free = std::move(right._free);
+			_values = std::move(right._values);
+			_frame = right._frame;
+			_first = right._first;
+			_last = right._last;
+			_buffer = right._buffer;
+			_texture = right._texture;
+			_capacity = right._capacity;
+
+			right._buffer = 0;
+			right._texture = 0;
+			right._capacity = 0;
+
+			return *this;
+		}
+
+		~MaterialBuffer() {
+			release();
+		}
+
+		// Marks the material as used this frame and rebuilds its record if it changed.
+		void update(const Material& material, const ShaderMap& shaders) {
+			auto [result, inserted] { _records.try_emplace(&material) };
+			MaterialRecord& record{ result->second };
+
+			record.frame = _frame;
+
+			if (inserted) {
+				record.index = allocate();
+			}
+			else if (record.revision == material.revision()) {
+				return;
+			}
+
+			record.revision = resolve(record, material, shaders) ? material.revision() : 0;
+			pack(record, material);
+		}
+
+		// Drops records not updated since the last upload and sends changed parameters.
+		void upload() {
+			for (auto it{ _records.begin() }; it != _records.end();) {
+				if (it->second.frame != _frame) {
+					_free.push_back(it->second.index);
+					it = _records.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+
+			++_frame;
+
+			if (_first > _last) {
+				return;
+			}
+
+			size_t slots{ _values.size() / stride };
+			if (slots > _capacity) {
+				release();
+
+				_capacity = std::max(slots, _capacity * 2);
+				RenderAPI::TextureBuffer::build(_buffer, _texture, _capacity * stride * sizeof(float));
+
+				_first = 0;
+				_last = slots - 1;
+			}
+
+			RenderAPI::TextureBuffer::upload(
+				_buffer,
+				_values.data() + _first * stride,
+				_first * stride * sizeof(float),
+				(_last - _first + 1) * stride * sizeof(float));
+
+			_first = SIZE_MAX;
+			_last = 0;
+		}
+
+		const MaterialRecord& record(const Material& material) const {
+			return _records.at(&material);
+		}
+
+		size_t size() const {
+			return _records.size();
+		}
+
+		TextureID texture() const {
+			return _texture;
+		}
+
+		void release() {
+			if (_buffer) {
+				RenderAPI::TextureBuffer::release(_buffer, _texture);
+				_buffer = 0;
+				_texture = 0;
+				_capacity = 0;
+			}
+		}
+
+	private:
+		uint32_t allocate() {
+			if (!_free.empty()) {
+				uint32_t index{ _free.back() };
+				_free.pop_back();
+				return index;
+			}
+
+			uint32_t index{ static_cast<uint32_t>(_values.size() / stride) };
+			_values.resize(_values.size() + stride);
+
+			return index;
+		}
+
+		// False while the material names a shader that does not exist yet, so it is retried.
+		static bool resolve(MaterialRecord& record, const Material& material, const ShaderMap& shaders) {
+			bool resolved{ true };
+
+			record.shader = nullptr;
+			auto tag{ material.shaderMap().find("geometry") };
+			if (tag != material.shaderMap().end()) {
+				auto shader{ shaders.find(tag->second) };
+				if (shader != shaders.end()) {
+					record.shader = &shader->second;
+				}
+				else {
+					resolved = false;
+				}
+			}
+
+			record.albedo = find(material, "albedo");
+			record.surface = find(material, "material");
+
+			record.albedoUnit = layered(record.albedo) ? Shader::albedoArrayUnit : Shader::albedoUnit;
+			record.surfaceUnit = layered(record.surface) ? Shader::surfaceArrayUnit : Shader::surfaceUnit;
+
+			record.bindings.clear();
+			if (record.shader) {
+				for (const auto& binding : record.shader->bindings()) {
+					record.bindings.push_back(&material.texture(binding.tag));
+				}
+			}
+
+			return resolved;
+		}
+
+		void pack(const MaterialRecord& record, const Material& material) {
+			Vec4 albedo{ material.albedo() };
+
+			int mode{ static_cast<int>(record.albedo != nullptr) + 2 * static_cast<int>(record.surface != nullptr) };
+			float albedoLayer{ layered(record.albedo) ? static_cast<float>(material.layer("albedo")) : -1.0f };
+			float surfaceLayer{ layered(record.surface) ? static_cast<float>(material.layer("material")) : -1.0f };
+
+			float values[stride]{
+				albedo.x, albedo.y, albedo.z, albedo.w,
+				material.metallic(), material.roughness(), material.ambientOcclusion(), material.emission(),
+				static_cast<float>(mode), albedoLayer, surfaceLayer, 0.0f
+			};
+
+			std::copy(values, values + stride, _values.begin() + record.index * stride);
+
+			_first = std::min<size_t>(_first, record.index);
+			_last = std::max<size_t>(_last, record.index);
+		}
+
+		static const Texture* find(const Material& material, const TextureTag& tag) {
+			auto result{ material.textureMap().find(tag) };
+			return result != material.textureMap().end() ? result->second : nullptr;
+		}
+
+		static bool layered(const Texture* texture) {
+			return texture && texture->data().type == TextureType::TEXTURE_ARRAY;
+		}
+	};
+
+}
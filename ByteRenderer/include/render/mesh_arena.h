@@ -0,0 +1,506 @@
+#pragma once
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "core/mesh.h"
+#include "core/vertex.h"
+#include "core/vertex_format.h"
+#include "render_type.h"
+#include "render_api.h"
+#include "render_array.h"
+
+namespace Byte {
+
+	// Suballocates static meshes of the default vertex layout out of one shared vertex and
+	// element buffer, so their draws need no array binds and can be submitted as indirect
+	// commands. A per-instance draw index attribute lets shaders look up each draw's data.
+	// Meshes with identical contents share one slice, so their draws can be instanced.
+	// Vertices are packed into 16 bytes; meshes with texture coordinates outside [0, 1] are
+	// left to their own arrays. Indices are relative to each slice's base vertex, so the element
+	// buffer is 16-bit until a slice with more than 65536 vertices is placed. A mesh's LOD indices
+	// follow its own and are drawn through one slice per level over the same vertices.
+	class MeshArena {
+	public:
+		using Format = Vertex<Position16, NormalOct16, UV16>;
+
+		static_assert(Format::stride == 16);
+
+		struct Slice {
+			uint32_t firstIndex{};
+			uint32_t indexCount{};
+			int32_t baseVertex{};
+			uint32_t vertexCount{};
+			float positionScale{ 1.0f };
+			Vec3 positionOffset;
+			uint64_t frame{};
+			uint32_t lodIndexCount{};
+		};
+
+		static constexpr uint8_t drawIndexLocation{ 3 };
+
+	private:
+		struct Entry {
+			Slice* slice{};
+			uint64_t frame{};
+		};
+
+		std::unordered_map<const Mesh*, Entry> _meshes;
+		std::unordered_multimap<uint64_t, Slice> _slices;
+		std::unordered_map<const Slice*, Buffer<Slice>> _lods;
+
+		Buffer<uint8_t> _layout{ Format::vertexLayout() };
+		Buffer<VertexType> _types{ Format::vertexTypes() };
+		size_t _vertexSize{ Format::stride };
+
+		Buffer<uint8_t> _vertices;
+		Buffer<uint32_t> _indices;
+		size_t _deadVertices{};
+		size_t _largestSlice{};
+
+		size_t _vertexOffset{ SIZE_MAX };
+		size_t _indexOffset{ SIZE_MAX };
+
+		RenderArray _renderArray;
+		size_t _vertexCapacity{};
+		size_t _indexCapacity{};
+		size_t _drawCapacity{};
+
+		uint64_t _frame{ 1 };
+
+	public:
+		MeshArena() = default;
+
+		MeshArena(const MeshArena&) = delete;
+
+		MeshArena(MeshArena&&) noexcept = default;
+
+		MeshArena& operator=(const MeshArena&) = delete;
+
+		MeshArena& operator=(MeshArena&&) noexcept = default;
+
+		bool accepts(const Mesh& mesh) const {
+			return mesh.mode() == MeshMode::STATIC &&
+				mesh.data().vertexLayout == _layout &&
+				!mesh.indices().empty() &&
+				vertexCount(mesh) > 0 &&
+				mesh.vertices().size() % floats() == 0;
+		}
+
+		// Marks the mesh as used this frame. Contents are only hashed the first time a mesh
+		// is seen; new contents are placed on the next upload.
+		void add(const Mesh& mesh) {
+			if (!accepts(mesh)) {
+				return;
+			}
+
+			auto [result, inserted] { _meshes.try_emplace(&mesh) };
+			Entry& entry{ result->second };
+
+			if (inserted || (entry.slice && !matches(*entry.slice, mesh))) {
+				entry.slice = place(mesh);
+			}
+
+			entry.frame = _frame;
+			if (entry.slice) {
+				entry.slice->frame = _frame;
+			}
+		}
+
+		// Drops meshes and slices not added since the last upload and sends new contents.
+		// Space left by dropped slices is reclaimed once it makes up half of the vertex buffer.
+		void upload() {
+			for (auto it{ _meshes.begin() }; it != _meshes.end();) {
+				if (it->second.frame != _frame) {
+					it = _meshes.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+
+			for (auto it{ _slices.begin() }; it != _slices.end();) {
+				if (it->second.frame != _frame) {
+					_deadVertices += it->second.vertexCount;
+					_lods.erase(&it->second);
+					it = _slices.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+
+			++_frame;
+
+			if (_deadVertices * 2 > _vertices.size() / _vertexSize) {
+				compact();
+				build();
+				return;
+			}
+
+			if (_vertexOffset == SIZE_MAX) {
+				return;
+			}
+
+			if (_vertices.size() > _vertexCapacity || _indices.size() > _indexCapacity || indexType() != requiredIndexType()) {
+				build();
+				return;
+			}
+
+			const RenderArrayData& data{ _renderArray.data() };
+
+			RenderAPI::RenderArray::subBufferData(
+				data.VBuffers[0].id,
+				_vertices.data() + _vertexOffset,
+				_vertexOffset,
+				_vertices.size() - _vertexOffset);
+
+			if (indexType() == IndexType::UINT16) {
+				Buffer<uint16_t> indices{ _indices.begin() + _indexOffset, _indices.end() };
+
+				RenderAPI::RenderArray::subBufferData(
+					data.EBO,
+					indices.data(),
+					_indexOffset * sizeof(uint16_t),
+					indices.size() * sizeof(uint16_t));
+			}
+			else {
+				RenderAPI::RenderArray::subBufferData(
+					data.EBO,
+					_indices.data() + _indexOffset,
+					_indexOffset * sizeof(uint32_t),
+					(_indices.size() - _indexOffset) * sizeof(uint32_t));
+			}
+
+			_vertexOffset = SIZE_MAX;
+			_indexOffset = SIZE_MAX;
+		}
+
+		// Grows the draw index attribute so indirect commands can address that many draws.
+		void reserve(size_t draws) {
+			if (draws <= _drawCapacity || !drawable()) {
+				return;
+			}
+
+			_drawCapacity = std::max(draws, _drawCapacity * 2);
+			fillDrawIndices();
+		}
+
+		const Slice* slice(const Mesh& mesh) const {
+			auto result{ _meshes.find(&mesh) };
+			return result != _meshes.end() ? result->second.slice : nullptr;
+		}
+
+		// Level 0 is the mesh's own slice; levels past its coarsest LOD draw the coarsest.
+		const Slice* slice(const Mesh& mesh, size_t level) const {
+			const Slice* base{ slice(mesh) };
+			if (!base || !level) {
+				return base;
+			}
+
+			auto lods{ _lods.find(base) };
+			if (lods == _lods.end() || lods->second.empty()) {
+				return base;
+			}
+
+			return &lods->second[std::min(level, lods->second.size()) - 1];
+		}
+
+		static IndirectCommand command(const Slice& slice, uint32_t firstDraw, uint32_t drawCount = 1) {
+			return IndirectCommand{ slice.indexCount, drawCount, slice.firstIndex, slice.baseVertex, firstDraw };
+		}
+
+		RenderArrayID renderArray() const {
+			return _renderArray.data().VAO;
+		}
+
+		IndexType indexType() const {
+			return _renderArray.data().indexType;
+		}
+
+		bool drawable() const {
+			return _renderArray.data().VAO != 0;
+		}
+
+		size_t size() const {
+			return _meshes.size();
+		}
+
+		size_t sliceCount() const {
+			return _slices.size();
+		}
+
+	private:
+		size_t floats() const {
+			size_t count{};
+			for (uint8_t size : _layout) {
+				count += size;
+			}
+
+			return count;
+		}
+
+		// Only a rebuild narrows the indices again, since slices are not tracked after removal.
+		IndexType requiredIndexType() const {
+			return _largestSlice > size_t{ UINT16_MAX } + 1 ? IndexType::UINT32 : IndexType::UINT16;
+		}
+
+		// Packed in the arena's format already, as typed or mapped meshes are.
+		bool direct(const Mesh& mesh) const {
+			const PackedVertices& packed{ mesh.data().packed };
+			return !packed.empty() && packed.stride == _vertexSize && mesh.data().vertexTypes == _types;
+		}
+
+		// Meshes loaded from a mesh file may only have packed vertices.
+		size_t vertexCount(const Mesh& mesh) const {
+			const PackedVertices& packed{ mesh.data().packed };
+
+			if (mesh.vertices().empty()) {
+				return packed.stride ? packed.bytes().size() / packed.stride : 0;
+			}
+
+			return mesh.vertices().size() / floats();
+		}
+
+		bool matches(const Slice& slice, const Mesh& mesh) const {
+			return slice.indexCount == mesh.indices().size() &&
+				slice.lodIndexCount == lodIndexCount(mesh) &&
+				slice.vertexCount == vertexCount(mesh);
+		}
+
+		static size_t lodIndexCount(const Mesh& mesh) {
+			size_t count{};
+			for (const MeshLod& lod : mesh.data().lods) {
+				count += lod.indices.size();
+			}
+
+			return count;
+		}
+
+		// Texture coordinates are stored as UNORM16, so they have to stay within [0, 1].
+		bool packable(const Buffer<float>& vertices) const {
+			size_t stride{ floats() };
+
+			for (size_t i{ stride - 2 }; i < vertices.size(); i += stride) {
+				if (vertices[i] < 0.0f || vertices[i] > 1.0f || vertices[i + 1] < 0.0f || vertices[i + 1] > 1.0f) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool equal(const Slice& slice, const PackedVertices& packed, const Mesh& mesh) const {
+			if (!matches(slice, mesh) || slice.positionScale != packed.positionScale ||
+				slice.positionOffset != packed.positionOffset) {
+				return false;
+			}
+
+			const uint8_t* vertices{ _vertices.data() + slice.baseVertex * _vertexSize };
+			const uint32_t* indices{ _indices.data() + slice.firstIndex };
+
+			if (std::memcmp(vertices, packed.bytes().data(), packed.bytes().size()) != 0 ||
+				std::memcmp(indices, mesh.indices().data(), mesh.indices().size() * sizeof(uint32_t)) != 0) {
+				return false;
+			}
+
+			indices += mesh.indices().size();
+			for (const MeshLod& lod : mesh.data().lods) {
+				if (std::memcmp(indices, lod.indices.data(), lod.indices.size() * sizeof(uint32_t)) != 0) {
+					return false;
+				}
+
+				indices += lod.indices.size();
+			}
+
+			return true;
+		}
+
+		// Meshes built with the arena's format are taken as they are; others are packed from
+		// their float vertices, decoded first if the mesh has none.
+		Slice* place(const Mesh& mesh) {
+			const MeshData& data{ mesh.data() };
+
+			if (direct(mesh)) {
+				return &find(mesh, data.packed);
+			}
+
+			Buffer<float> decoded;
+			if (data.vertices.empty()) {
+				decoded = VertexFormat::unpack(data.packed.bytes(), data.packed.stride, data.vertexLayout, data.vertexTypes, data.packed.positionScale, data.packed.positionOffset);
+			}
+
+			const Buffer<float>& vertices{ data.vertices.empty() ? decoded : data.vertices };
+			if (!packable(vertices)) {
+				return nullptr;
+			}
+
+			return &find(mesh, VertexFormat::pack(vertices, _layout, _types));
+		}
+
+		Slice& find(const Mesh& mesh, const PackedVertices& packed) {
+			uint64_t key{ hash(packed, mesh) };
+
+			auto [first, last] { _slices.equal_range(key) };
+			for (auto it{ first }; it != last; ++it) {
+				if (equal(it->second, packed, mesh)) {
+					return it->second;
+				}
+			}
+
+			Slice& slice{ _slices.emplace(key, Slice{})->second };
+			slice.positionScale = packed.positionScale;
+			slice.positionOffset = packed.positionOffset;
+
+			if (mesh.data().lods.empty()) {
+				append(slice, packed.bytes().data(), packed.bytes().size(), mesh.indices().data(), mesh.indices().size());
+				return slice;
+			}
+
+			Buffer<uint32_t> indices{ mesh.allIndices() };
+			append(slice, packed.bytes().data(), packed.bytes().size(), indices.data(), mesh.indices().size(), lodIndexCount(mesh));
+
+			Buffer<Slice>& lods{ _lods[&slice] };
+			lods.clear();
+
+			for (size_t level{ 1 }; level < mesh.lodCount(); ++level) {
+				Slice lod{ slice };
+				lod.firstIndex = slice.firstIndex + mesh.lodFirstIndex(level);
+				lod.indexCount = mesh.lodIndexCount(level);
+				lod.lodIndexCount = 0;
+				lods.push_back(lod);
+			}
+
+			return slice;
+		}
+
+		void append(
+			Slice& slice,
+			const uint8_t* vertices,
+			size_t vertexCount,
+			const uint32_t* indices,
+			size_t indexCount,
+			size_t lodIndexCount = 0) {
+			_vertexOffset = std::min(_vertexOffset, _vertices.size());
+			_indexOffset = std::min(_indexOffset, _indices.size());
+
+			slice.firstIndex = static_cast<uint32_t>(_indices.size());
+			slice.indexCount = static_cast<uint32_t>(indexCount);
+			slice.lodIndexCount = static_cast<uint32_t>(lodIndexCount);
+			slice.baseVertex = static_cast<int32_t>(_vertices.size() / _vertexSize);
+			slice.vertexCount = static_cast<uint32_t>(vertexCount / _vertexSize);
+
+			_largestSlice = std::max<size_t>(_largestSlice, slice.vertexCount);
+
+			_vertices.insert(_vertices.end(), vertices, vertices + vertexCount);
+			_indices.insert(_indices.end(), indices, indices + indexCount + lodIndexCount);
+		}
+
+		// Repacks the live slices from the current contents; meshes keep pointing at them.
+		void compact() {
+			Buffer<uint8_t> vertices{ std::move(_vertices) };
+			Buffer<uint32_t> indices{ std::move(_indices) };
+
+			_vertices.clear();
+			_indices.clear();
+			_largestSlice = 0;
+
+			for (auto& [key, slice] : _slices) {
+				uint32_t firstIndex{ slice.firstIndex };
+
+				append(
+					slice,
+					vertices.data() + slice.baseVertex * _vertexSize,
+					slice.vertexCount * _vertexSize,
+					indices.data() + slice.firstIndex,
+					slice.indexCount,
+					slice.lodIndexCount);
+
+				auto lods{ _lods.find(&slice) };
+				if (lods != _lods.end()) {
+					for (Slice& lod : lods->second) {
+						lod.firstIndex = lod.firstIndex - firstIndex + slice.firstIndex;
+						lod.baseVertex = slice.baseVertex;
+					}
+				}
+			}
+
+			_deadVertices = 0;
+			_vertexCapacity = 0;
+			_indexCapacity = 0;
+		}
+
+		// Reallocates both buffers with room to grow, since appends only fit within capacity.
+		void build() {
+			_vertexCapacity = std::max(_vertices.size(), _vertexCapacity * 2);
+			_indexCapacity = std::max(_indices.size(), _indexCapacity * 2);
+
+			_vertexOffset = SIZE_MAX;
+			_indexOffset = SIZE_MAX;
+
+			if (!_vertexCapacity) {
+				_renderArray = RenderArray{};
+				return;
+			}
+
+			size_t vertexCount{ _vertices.size() };
+			size_t indexCount{ _indices.size() };
+
+			_vertices.resize(_vertexCapacity);
+			_indices.resize(_indexCapacity);
+
+			auto atts{ RenderAPI::RenderArray::buildAttributes(_layout, _types) };
+			auto iAtts{ RenderAPI::RenderArray::buildAttributes({ 1 }, drawIndexLocation) };
+
+			if (requiredIndexType() == IndexType::UINT16) {
+				Buffer<uint16_t> indices{ _indices.begin(), _indices.end() };
+				_renderArray = RenderAPI::RenderArray::build(_vertices, indices, atts, iAtts, true);
+			}
+			else {
+				_renderArray = RenderAPI::RenderArray::build(_vertices, _indices, atts, iAtts, true);
+			}
+
+			_vertices.resize(vertexCount);
+			_indices.resize(indexCount);
+
+			if (_drawCapacity) {
+				fillDrawIndices();
+			}
+		}
+
+		void fillDrawIndices() {
+			Buffer<float> indices(_drawCapacity);
+			for (size_t i{}; i < indices.size(); ++i) {
+				indices[i] = static_cast<float>(i);
+			}
+
+			RenderAPI::RenderArray::bufferData(_renderArray.data().VBuffers[1].id, indices, indices.size(), true);
+		}
+
+		static uint64_t hash(const PackedVertices& packed, const Mesh& mesh) {
+			uint64_t value{ 14695981039346656037ULL };
+
+			auto mix = [&value](const void* data, size_t size) {
+				const uint8_t* bytes{ static_cast<const uint8_t*>(data) };
+				for (size_t i{}; i < size; ++i) {
+					value ^= bytes[i];
+					value *= 1099511628211ULL;
+				}
+			};
+
+			mix(packed.bytes().data(), packed.bytes().size());
+			mix(&packed.positionScale, sizeof(packed.positionScale));
+			mix(&packed.positionOffset, sizeof(packed.positionOffset));
+			mix(mesh.indices().data(), mesh.indices().size() * sizeof(uint32_t));
+
+			for (const MeshLod& lod : mesh.data().lods) {
+				mix(lod.indices.data(), lod.indices.size() * sizeof(uint32_t));
+			}
+
+			return value;
+		}
+	};
+
+}
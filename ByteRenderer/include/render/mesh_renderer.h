@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/mesh.h"
+#include "core/transform.h"
 #include "render_array.h"
 #include "render_type.h"
 
@@ -11,37 +12,56 @@ namespace Byte {
         RenderArray _renderArray;
         PrimitiveType _primitiveType{ PrimitiveType::TRIANGLES };
 
+        float _positionScale{ 1.0f };
+        Vec3 _positionOffset;
+        bool _octahedralNormals{ false };
+
     public:
         MeshRenderer() = default;
 
         void upload(const Mesh& mesh) {
-            if (_renderArray.data().VAO) {
-                _renderArray.clear();
+            const MeshData& data{ mesh.data() };
+
+            // LOD indices follow the mesh's own; draws pick a level by its first index.
+            Buffer<uint32_t> lodIndices;
+            if (!data.lods.empty()) {
+                lodIndices = mesh.allIndices();
             }
 
-            bool isStatic{ mesh.mode() == MeshMode::STATIC };
+            assign(mesh, data.lods.empty() ? mesh.indices() : lodIndices);
+        }
 
-            auto atts{ RenderAPI::RenderArray::buildAttributes(mesh.data().vertexLayout) };
+        // Instanced shaders take the position scale and offset as uniforms, since the
+        // per-instance transforms are the caller's data.
+        void uploadInstanced(const Mesh& mesh, const Buffer<uint8_t>& layout) {
+            auto iAtts{ RenderAPI::RenderArray::buildAttributes(
+                layout,
+                static_cast<uint8_t>(mesh.data().vertexLayout.size())) };
 
-            _renderArray = RenderAPI::RenderArray::build(mesh.vertices(), mesh.indices(), atts, isStatic);
+            assign(mesh, mesh.indices(), iAtts);
         }
 
-        void uploadInstanced(const Mesh& mesh, const Buffer<uint8_t>& layout) {
-            if (_renderArray.data().VAO) {
-                _renderArray.clear();
-            }
+        // Multiplies into the draw scale to undo SNORM16 positions being relative to the bounds.
+        float positionScale() const {
+            return _positionScale;
+        }
 
-            bool isStatic{ mesh.mode() == MeshMode::STATIC };
+        // Center of the bounds SNORM16 positions are relative to, in mesh space.
+        const Vec3& positionOffset() const {
+            return _positionOffset;
+        }
 
-            auto atts{ RenderAPI::RenderArray::buildAttributes(mesh.data().vertexLayout) };
+        // Where the draw has to place the decoded positions for the mesh to land at transform.
+        Vec3 position(const Transform& transform) const {
+            return transform.position() + transform.rotation() * (transform.scale() * _positionOffset);
+        }
 
-            auto iAtts{ RenderAPI::RenderArray::buildAttributes(
-                layout,
-                static_cast<uint8_t>(mesh.data().vertexLayout.size())) };
+        bool octahedralNormals() const {
+            return _octahedralNormals;
+        }
 
-            auto& vertices{ mesh.vertices() };
-            auto& indices{ mesh.indices() };
-            _renderArray = RenderAPI::RenderArray::build(vertices,indices,atts,iAtts,isStatic);
+        IndexType indexType() const {
+            return _renderArray.data().indexType;
         }
 
         PrimitiveType primitive() const {
@@ -68,6 +88,62 @@ namespace Byte {
             return _renderArray.data().VAO != 0; 
         }
 
+    private:
+        template<typename... Instances>
+        void assign(const Mesh& mesh, const Buffer<uint32_t>& indices, Instances&... instances) {
+            if (_renderArray.data().VAO) {
+                _renderArray.clear();
+            }
+
+            bool isStatic{ mesh.mode() == MeshMode::STATIC };
+
+            const MeshData& data{ mesh.data() };
+
+            _positionScale = 1.0f;
+            _positionOffset = Vec3{};
+            _octahedralNormals = data.vertexTypes.size() > 1 && data.vertexTypes[1] == VertexType::OCTAHEDRAL;
+
+            if (!data.packed.empty()) {
+                _positionScale = data.packed.positionScale;
+                _positionOffset = data.packed.positionOffset;
+
+                auto atts{ RenderAPI::RenderArray::buildAttributes(data.vertexLayout, data.vertexTypes) };
+
+                _renderArray = build(data.packed.bytes(), indices, isStatic, atts, instances...);
+                return;
+            }
+
+            if (data.vertexTypes.empty()) {
+                auto atts{ RenderAPI::RenderArray::buildAttributes(data.vertexLayout) };
+
+                _renderArray = build(mesh.vertices(), indices, isStatic, atts, instances...);
+                return;
+            }
+
+            PackedVertices packed{ VertexFormat::pack(data.vertices, data.vertexLayout, data.vertexTypes) };
+            _positionScale = packed.positionScale;
+            _positionOffset = packed.positionOffset;
+
+            auto atts{ RenderAPI::RenderArray::buildAttributes(data.vertexLayout, data.vertexTypes) };
+
+            _renderArray = build(packed.vertices, indices, isStatic, atts, instances...);
+        }
+
+        // Uploads 16-bit indices when the mesh has few enough vertices for them.
+        template<typename Vertices, typename... Attributes>
+        static RenderArrayData build(
+            const Vertices& vertices,
+            const Buffer<uint32_t>& indices,
+            bool isStatic,
+            Attributes&... attributes) {
+            if (RenderAPI::RenderArray::indexType(indices) == IndexType::UINT16) {
+                Buffer<uint16_t> narrow{ indices.begin(), indices.end() };
+                return RenderAPI::RenderArray::build(vertices, narrow, attributes..., isStatic);
+            }
+
+            return RenderAPI::RenderArray::build(vertices, indices, attributes..., isStatic);
+        }
+
 	};
 
 }
\ No newline at end of file
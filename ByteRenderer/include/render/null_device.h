@@ -0,0 +1,1362 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <ostream>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "glad/glad.h"
+
+#include "core/core_types.h"
+#include "render_type.h"
+
+namespace Byte {
+
+	// Stands in for the GL driver by filling glad's function pointers. Objects, bindings and
+	// reflected uniforms are tracked so misuse raises GL errors, but nothing is drawn.
+	class NullDevice {
+	public:
+		struct Counters {
+			size_t calls{};
+			size_t draws{};
+			size_t indices{};
+			size_t instances{};
+			size_t binds{};
+			size_t uniforms{};
+			size_t uploadedBytes{};
+			size_t errors{};
+		};
+
+	private:
+		struct UniformInfo {
+			std::string name;
+			GLenum type{};
+			GLint count{ 1 };
+			GLint location{};
+			bool array{ false };
+		};
+
+		struct AttributeInfo {
+			std::string name;
+			GLenum type{};
+			GLint location{};
+		};
+
+		struct ProgramObject {
+			Buffer<GLuint> shaders;
+			Buffer<UniformInfo> uniforms;
+			Buffer<AttributeInfo> attributes;
+			Buffer<std::string> blocks;
+			GLint locationCount{};
+		};
+
+		inline static GLuint _nextName{ 1 };
+
+		inline static std::unordered_set<GLuint> _textures;
+		inline static std::unordered_set<GLuint> _buffers;
+		inline static std::unordered_set<GLuint> _arrays;
+		inline static std::unordered_set<GLuint> _framebuffers;
+		inline static std::unordered_set<GLuint> _renderbuffers;
+		inline static std::unordered_map<GLuint, uint64_t> _queries;
+		inline static std::unordered_map<GLuint, std::string> _shaders;
+		inline static std::unordered_map<GLuint, ProgramObject> _programs;
+
+		inline static GLuint _program{};
+		inline static GLuint _array{};
+		inline static GLuint _drawFramebuffer{};
+		inline static GLuint _unit{};
+		inline static std::unordered_map<GLenum, GLuint> _boundBuffers;
+		inline static std::unordered_map<uint64_t, GLuint> _boundTextures;
+		inline static Buffer<uint8_t> _indirect;
+
+		inline static GLenum _error{ GL_NO_ERROR };
+		inline static Counters _counters{ 0, 0, 0, 0, 0, 0, 0, 0 };
+
+		inline static bool _recording{ false };
+		inline static Buffer<std::string> _log;
+
+		static constexpr GLuint unitCount{ 32 };
+
+	public:
+		static void install(bool recording = false) {
+			reset();
+			_recording = recording;
+
+			glad_glActiveTexture = activeTexture;
+			glad_glAttachShader = attachShader;
+			glad_glBindBuffer = bindBuffer;
+			glad_glBindBufferBase = bindBufferBase;
+			glad_glBindFramebuffer = bindFramebuffer;
+			glad_glBindRenderbuffer = bindRenderbuffer;
+			glad_glBindTexture = bindTexture;
+			glad_glBindVertexArray = bindVertexArray;
+			glad_glBlendColor = blendColor;
+			glad_glBlendEquation = blendEquation;
+			glad_glBlendFunc = blendFunc;
+			glad_glBlitFramebuffer = blitFramebuffer;
+			glad_glBufferData = bufferData;
+			glad_glBufferSubData = bufferSubData;
+			glad_glCheckFramebufferStatus = checkFramebufferStatus;
+			glad_glClear = clear;
+			glad_glClearColor = clearColor;
+			glad_glCompileShader = compileShader;
+			glad_glCreateProgram = createProgram;
+			glad_glCreateShader = createShader;
+			glad_glCullFace = cullFace;
+			glad_glDeleteBuffers = deleteBuffers;
+			glad_glDeleteFramebuffers = deleteFramebuffers;
+			glad_glDeleteProgram = deleteProgram;
+			glad_glDeleteQueries = deleteQueries;
+			glad_glDeleteRenderbuffers = deleteRenderbuffers;
+			glad_glDeleteShader = deleteShader;
+			glad_glDeleteTextures = deleteTextures;
+			glad_glDeleteVertexArrays = deleteVertexArrays;
+			glad_glDepthMask = depthMask;
+			glad_glDisable = disable;
+			glad_glDrawArrays = drawArrays;
+			glad_glDrawBuffers = drawBuffers;
+			glad_glDrawElements = drawElements;
+			glad_glDrawElementsInstanced = drawElementsInstanced;
+			glad_glDrawElementsInstancedBaseVertex = drawElementsInstancedBaseVertex;
+			glad_glEnable = enable;
+			glad_glEnableVertexAttribArray = enableVertexAttribArray;
+			glad_glFramebufferRenderbuffer = framebufferRenderbuffer;
+			glad_glFramebufferTexture = framebufferTexture;
+			glad_glFramebufferTexture2D = framebufferTexture2D;
+			glad_glGenBuffers = genBuffers;
+			glad_glGenFramebuffers = genFramebuffers;
+			glad_glGenQueries = genQueries;
+			glad_glGenRenderbuffers = genRenderbuffers;
+			glad_glGenTextures = genTextures;
+			glad_glGenVertexArrays = genVertexArrays;
+			glad_glGenerateMipmap = generateMipmap;
+			glad_glGetActiveAttrib = getActiveAttrib;
+			glad_glGetActiveUniform = getActiveUniform;
+			glad_glGetAttribLocation = getAttribLocation;
+			glad_glGetError = getError;
+			glad_glGetInteger64v = getInteger64v;
+			glad_glGetIntegerv = getIntegerv;
+			glad_glGetProgramInfoLog = getProgramInfoLog;
+			glad_glGetProgramiv = getProgramiv;
+			glad_glGetQueryObjectiv = getQueryObjectiv;
+			glad_glGetQueryObjectui64v = getQueryObjectui64v;
+			glad_glGetShaderInfoLog = getShaderInfoLog;
+			glad_glGetShaderiv = getShaderiv;
+			glad_glGetString = getString;
+			glad_glGetUniformBlockIndex = getUniformBlockIndex;
+			glad_glGetUniformLocation = getUniformLocation;
+			glad_glLinkProgram = linkProgram;
+			glad_glPatchParameteri = patchParameteri;
+			glad_glPixelStorei = pixelStorei;
+			glad_glQueryCounter = queryCounter;
+			glad_glReadPixels = readPixels;
+			glad_glRenderbufferStorage = renderbufferStorage;
+			glad_glShaderSource = shaderSource;
+			glad_glTexBuffer = texBuffer;
+			glad_glTexImage2D = texImage2D;
+			glad_glTexImage3D = texImage3D;
+			glad_glTexParameteri = texParameteri;
+			glad_glUniform1fv = uniform1fv;
+			glad_glUniform1iv = uniform1iv;
+			glad_glUniform1uiv = uniform1uiv;
+			glad_glUniform2fv = uniform2fv;
+			glad_glUniform3fv = uniform3fv;
+			glad_glUniform4fv = uniform4fv;
+			glad_glUniformBlockBinding = uniformBlockBinding;
+			glad_glUniformMatrix2fv = uniformMatrix2fv;
+			glad_glUniformMatrix3fv = uniformMatrix3fv;
+			glad_glUniformMatrix4fv = uniformMatrix4fv;
+			glad_glUseProgram = useProgram;
+			glad_glVertexAttribDivisor = vertexAttribDivisor;
+			glad_glVertexAttribPointer = vertexAttribPointer;
+			glad_glViewport = viewport;
+		}
+
+		static const Counters& counters() {
+			return _counters;
+		}
+
+		static void resetCounters() {
+			_counters = Counters{};
+		}
+
+		static bool recording() {
+			return _recording;
+		}
+
+		static const Buffer<std::string>& log() {
+			return _log;
+		}
+
+		static void writeLog(std::ostream& stream) {
+			for (const auto& line : _log) {
+				stream << line << "\n";
+			}
+		}
+
+		static void clearLog() {
+			_log.clear();
+		}
+
+		// glad's 4.1 loader has no slot for this entry point, so RenderAPI takes it from here.
+		static void APIENTRY multiDrawElementsIndirect(
+			GLenum mode, GLenum type, [[maybe_unused]] const void* indirect, GLsizei drawcount, GLsizei stride) {
+			record("glMultiDrawElementsIndirect", mode, type, drawcount, stride);
+
+			if (!_boundBuffers[GL_DRAW_INDIRECT_BUFFER] || _indirect.size() < drawcount * sizeof(IndirectCommand)) {
+				raise(GL_INVALID_OPERATION);
+				return;
+			}
+
+			if (drawable(type)) {
+				const IndirectCommand* commands{ reinterpret_cast<const IndirectCommand*>(_indirect.data()) };
+
+				++_counters.draws;
+				for (GLsizei i{}; i < drawcount; ++i) {
+					_counters.indices += static_cast<size_t>(commands[i].count) * commands[i].instanceCount;
+					_counters.instances += commands[i].instanceCount;
+				}
+			}
+		}
+
+	private:
+		static void reset() {
+			_nextName = 1;
+
+			_textures.clear();
+			_buffers.clear();
+			_arrays.clear();
+			_framebuffers.clear();
+			_renderbuffers.clear();
+			_queries.clear();
+			_shaders.clear();
+			_programs.clear();
+
+			_program = 0;
+			_array = 0;
+			_drawFramebuffer = 0;
+			_unit = 0;
+			_boundBuffers.clear();
+			_boundTextures.clear();
+			_indirect.clear();
+
+			_error = GL_NO_ERROR;
+			_counters = Counters{};
+			_log.clear();
+		}
+
+		template<typename... Args>
+		static void record(const char* name, const Args&... args) {
+			++_counters.calls;
+
+			if (!_recording) {
+				return;
+			}
+
+			std::ostringstream line;
+			line << name << "(";
+
+			[[maybe_unused]] const char* separator{ "" };
+			((line << separator << args, separator = ", "), ...);
+
+			line << ")";
+			_log.push_back(line.str());
+		}
+
+		static void raise(GLenum error) {
+			++_counters.errors;
+
+			if (_recording) {
+				_log.push_back("  error " + std::to_string(error));
+			}
+
+			if (_error == GL_NO_ERROR) {
+				_error = error;
+			}
+		}
+
+		static void generate(std::unordered_set<GLuint>& names, GLsizei n, GLuint* ids) {
+			for (GLsizei i{}; i < n; ++i) {
+				ids[i] = _nextName++;
+				names.insert(ids[i]);
+			}
+		}
+
+		static void release(std::unordered_set<GLuint>& names, GLsizei n, const GLuint* ids) {
+			for (GLsizei i{}; i < n; ++i) {
+				names.erase(ids[i]);
+			}
+		}
+
+		static bool known(const std::unordered_set<GLuint>& names, GLuint id) {
+			if (id != 0 && !names.count(id)) {
+				raise(GL_INVALID_OPERATION);
+				return false;
+			}
+
+			return true;
+		}
+
+		static uint64_t now() {
+			auto time{ std::chrono::steady_clock::now().time_since_epoch() };
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+		}
+
+		static uint64_t textureSlot(GLenum target) {
+			return (static_cast<uint64_t>(_unit) << 32) | target;
+		}
+
+		static void APIENTRY activeTexture(GLenum texture) {
+			record("glActiveTexture", texture);
+
+			if (texture < GL_TEXTURE0 || texture >= GL_TEXTURE0 + unitCount) {
+				raise(GL_INVALID_ENUM);
+				return;
+			}
+
+			_unit = texture - GL_TEXTURE0;
+		}
+
+		static void APIENTRY attachShader(GLuint program, GLuint shader) {
+			record("glAttachShader", program, shader);
+
+			auto result{ _programs.find(program) };
+			if (result == _programs.end() || !_shaders.count(shader)) {
+				raise(GL_INVALID_VALUE);
+				return;
+			}
+
+			result->second.shaders.push_back(shader);
+		}
+
+		static void APIENTRY bindBuffer(GLenum target, GLuint buffer) {
+			record("glBindBuffer", target, buffer);
+			++_counters.binds;
+
+			if (known(_buffers, buffer)) {
+				_boundBuffers[target] = buffer;
+			}
+		}
+
+		static void APIENTRY bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+			record("glBindBufferBase", target, index, buffer);
+			++_counters.binds;
+
+			known(_buffers, buffer);
+		}
+
+		static void APIENTRY bindFramebuffer(GLenum target, GLuint framebuffer) {
+			record("glBindFramebuffer", target, framebuffer);
+			++_counters.binds;
+
+			if (known(_framebuffers, framebuffer) && target != GL_READ_FRAMEBUFFER) {
+				_drawFramebuffer = framebuffer;
+			}
+		}
+
+		static void APIENTRY bindRenderbuffer(GLenum target, GLuint renderbuffer) {
+			record("glBindRenderbuffer", target, renderbuffer);
+			known(_renderbuffers, renderbuffer);
+		}
+
+		static void APIENTRY bindTexture(GLenum target, GLuint texture) {
+			record("glBindTexture", target, texture);
+			++_counters.binds;
+
+			if (known(_textures, texture)) {
+				_boundTextures[textureSlot(target)] = texture;
+			}
+		}
+
+		static void APIENTRY bindVertexArray(GLuint array) {
+			record("glBindVertexArray", array);
+			++_counters.binds;
+
+			if (known(_arrays, array)) {
+				_array = array;
+			}
+		}
+
+		static void APIENTRY blendColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+			record("glBlendColor", red, green, blue, alpha);
+		}
+
+		static void APIENTRY blendEquation(GLenum mode) {
+			record("glBlendEquation", mode);
+		}
+
+		static void APIENTRY blendFunc(GLenum sfactor, GLenum dfactor) {
+			record("glBlendFunc", sfactor, dfactor);
+		}
+
+		static void APIENTRY blitFramebuffer(
+			GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+			GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+			GLbitfield mask, GLenum filter) {
+			record("glBlitFramebuffer", srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+		}
+
+		static void APIENTRY bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+			record("glBufferData", target, size, usage);
+
+			if (!_boundBuffers[target]) {
+				raise(GL_INVALID_OPERATION);
+				return;
+			}
+
+			_counters.uploadedBytes += static_cast<size_t>(size);
+
+			// Kept so indirect draws can count what they would submit.
+			if (target == GL_DRAW_INDIRECT_BUFFER) {
+				const uint8_t* bytes{ static_cast<const uint8_t*>(data) };
+				_indirect.assign(bytes, bytes + (data ? size : 0));
+			}
+		}
+
+		static void APIENTRY bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, [[maybe_unused]] const void* data) {
+			record("glBufferSubData", target, offset, size);
+
+			if (!_boundBuffers[target]) {
+				raise(GL_INVALID_OPERATION);
+				return;
+			}
+
+			_counters.uploadedBytes += static_cast<size_t>(size);
+		}
+
+		static GLenum APIENTRY checkFramebufferStatus(GLenum target) {
+			record("glCheckFramebufferStatus", target);
+			return GL_FRAMEBUFFER_COMPLETE;
+		}
+
+		static void APIENTRY clear(GLbitfield mask) {
+			record("glClear", mask);
+		}
+
+		static void APIENTRY clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+			record("glClearColor", red, green, blue, alpha);
+		}
+
+		static void APIENTRY compileShader(GLuint shader) {
+			record("glCompileShader", shader);
+
+			if (!_shaders.count(shader)) {
+				raise(GL_INVALID_VALUE);
+			}
+		}
+
+		static GLuint APIENTRY createProgram() {
+			record("glCreateProgram");
+
+			GLuint id{ _nextName++ };
+			_programs.emplace(id, ProgramObject{});
+
+			return id;
+		}
+
+		static GLuint APIENTRY createShader(GLenum type) {
+			record("glCreateShader", type);
+
+			GLuint id{ _nextName++ };
+			_shaders.emplace(id, std::string{});
+
+			return id;
+		}
+
+		static void APIENTRY cullFace(GLenum mode) {
+			record("glCullFace", mode);
+		}
+
+		static void APIENTRY deleteBuffers(GLsizei n, const GLuint* buffers) {
+			record("glDeleteBuffers", n);
+			release(_buffers, n, buffers);
+		}
+
+		static void APIENTRY deleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+			record("glDeleteFramebuffers", n);
+			release(_framebuffers, n, framebuffers);
+
+			for (GLsizei i{}; i < n; ++i) {
+				if (_drawFramebuffer == framebuffers[i]) {
+					_drawFramebuffer = 0;
+				}
+			}
+		}
+
+		static void APIENTRY deleteProgram(GLuint program) {
+			record("glDeleteProgram", program);
+			_programs.erase(program);
+		}
+
+		static void APIENTRY deleteQueries(GLsizei n, const GLuint* ids) {
+			record("glDeleteQueries", n);
+
+			for (GLsizei i{}; i < n; ++i) {
+				_queries.erase(ids[i]);
+			}
+		}
+
+		static void APIENTRY deleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+			record("glDeleteRenderbuffers", n);
+			release(_renderbuffers, n, renderbuffers);
+		}
+
+		static void APIENTRY deleteShader(GLuint shader) {
+			record("glDeleteShader", shader);
+			_shaders.erase(shader);
+		}
+
+		static void APIENTRY deleteTextures(GLsizei n, const GLuint* textures) {
+			record("glDeleteTextures", n);
+			release(_textures, n, textures);
+		}
+
+		static void APIENTRY deleteVertexArrays(GLsizei n, const GLuint* arrays) {
+			record("glDeleteVertexArrays", n);
+			release(_arrays, n, arrays);
+
+			for (GLsizei i{}; i < n; ++i) {
+				if (_array == arrays[i]) {
+					_array = 0;
+				}
+			}
+		}
+
+		static void APIENTRY depthMask(GLboolean flag) {
+			record("glDepthMask", static_cast<int>(flag));
+		}
+
+		static void APIENTRY disable(GLenum cap) {
+			record("glDisable", cap);
+		}
+
+		static bool drawable() {
+			if (!_program || !_array) {
+				raise(GL_INVALID_OPERATION);
+				return false;
+			}
+
+			return true;
+		}
+
+		static bool drawable(GLenum type) {
+			if (type != GL_UNSIGNED_BYTE && type != GL_UNSIGNED_SHORT && type != GL_UNSIGNED_INT) {
+				raise(GL_INVALID_ENUM);
+				return false;
+			}
+
+			return drawable();
+		}
+
+		static void APIENTRY drawArrays(GLenum mode, GLint first, GLsizei count) {
+			record("glDrawArrays", mode, first, count);
+
+			if (drawable()) {
+				++_counters.draws;
+				_counters.indices += static_cast<size_t>(count);
+				++_counters.instances;
+			}
+		}
+
+		static void APIENTRY drawBuffers(GLsizei n, [[maybe_unused]] const GLenum* bufs) {
+			record("glDrawBuffers", n);
+
+			if (!_drawFramebuffer) {
+				raise(GL_INVALID_OPERATION);
+			}
+		}
+
+		static void APIENTRY drawElements(GLenum mode, GLsizei count, GLenum type, [[maybe_unused]] const void* indices) {
+			record("glDrawElements", mode, count, type);
+
+			if (drawable(type)) {
+				++_counters.draws;
+				_counters.indices += static_cast<size_t>(count);
+				++_counters.instances;
+			}
+		}
+
+		static void APIENTRY drawElementsInstanced(
+			GLenum mode, GLsizei count, GLenum type, [[maybe_unused]] const void* indices, GLsizei instancecount) {
+			record("glDrawElementsInstanced", mode, count, type, instancecount);
+
+			if (drawable(type)) {
+				++_counters.draws;
+				_counters.indices += static_cast<size_t>(count) * static_cast<size_t>(instancecount);
+				_counters.instances += static_cast<size_t>(instancecount);
+			}
+		}
+
+		static void APIENTRY drawElementsInstancedBaseVertex(
+			GLenum mode, GLsizei count, GLenum type, [[maybe_unused]] const void* indices, GLsizei instancecount, GLint basevertex) {
+			record("glDrawElementsInstancedBaseVertex", mode, count, type, instancecount, basevertex);
+
+			if (drawable(type)) {
+				++_counters.draws;
+				_counters.indices += static_cast<size_t>(count) * static_cast<size_t>(instancecount);
+				_counters.instances += static_cast<size_t>(instancecount);
+			}
+		}
+
+		static void APIENTRY enable(GLenum cap) {
+			record("glEnable", cap);
+		}
+
+		static void APIENTRY enableVertexAttribArray(GLuint index) {
+			record("glEnableVertexAttribArray", index);
+
+			if (!_array) {
+				raise(GL_INVALID_OPERATION);
+			}
+		}
+
+		static void APIENTRY framebufferRenderbuffer(
+			GLenum target, GLenum attachment, [[maybe_unused]] GLenum renderbuffertarget, GLuint renderbuffer) {
+			record("glFramebufferRenderbuffer", target, attachment, renderbuffer);
+
+			if (!_drawFramebuffer) {
+				raise(GL_INVALID_OPERATION);
+			}
+		}
+
+		static void APIENTRY framebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level) {
+			record("glFramebufferTexture", target, attachment, texture, level);
+
+			if (!_drawFramebuffer) {
+				raise(GL_INVALID_OPERATION);
+				return;
+			}
+
+			known(_textures, texture);
+		}
+
+		static void APIENTRY framebufferTexture2D(
+			GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) {
+			record("glFramebufferTexture2D", target, attachment, textarget, texture, level);
+
+			if (!_drawFramebuffer) {
+				raise(GL_INVALID_OPERATION);
+				return;
+			}
+
+			known(_textures, texture);
+		}
+
+		static void APIENTRY genBuffers(GLsizei n, GLuint* buffers) {
+			record("glGenBuffers", n);
+			generate(_buffers, n, buffers);
+		}
+
+		static void APIENTRY genFramebuffers(GLsizei n, GLuint* framebuffers) {
+			record("glGenFramebuffers", n);
+			generate(_framebuffers, n, framebuffers);
+		}
+
+		static void APIENTRY genQueries(GLsizei n, GLuint* ids) {
+			record("glGenQueries", n);
+
+			for (GLsizei i{}; i < n; ++i) {
+				ids[i] = _nextName++;
+				_queries.emplace(ids[i], 0);
+			}
+		}
+
+		static void APIENTRY genRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+			record("glGenRenderbuffers", n);
+			generate(_renderbuffers, n, renderbuffers);
+		}
+
+		static void APIENTRY genTextures(GLsizei n, GLuint* textures) {
+			record("glGenTextures", n);
+			generate(_textures, n, textures);
+		}
+
+		static void APIENTRY genVertexArrays(GLsizei n, GLuint* arrays) {
+			record("glGenVertexArrays", n);
+			generate(_arrays, n, arrays);
+		}
+
+		static void APIENTRY generateMipmap(GLenum target) {
+			record("glGenerateMipmap", target);
+
+			if (!_boundTextures[textureSlot(target)]) {
+				raise(GL_INVALID_OPERATION);
+			}
+		}
+
+		static void APIENTRY getActiveAttrib(
+			GLuint program, GLuint index, GLsizei bufSize,
+			GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
+			record("glGetActiveAttrib", program, index);
+
+			auto result{ _programs.find(program) };
+			if (result == _programs.end() || index >= result->second.attributes.size()) {
+				raise(GL_INVALID_VALUE);
+				return;
+			}
+
+			const AttributeInfo& attribute{ result->second.attributes[index] };
+
+			GLsizei written{ static_cast<GLsizei>(std::min<size_t>(attribute.name.size(), bufSize > 0 ? bufSize - 1 : 0)) };
+			if (bufSize > 0) {
+				std::copy(attribute.name.begin(), attribute.name.begin() + written, name);
+				name[written] = '\0';
+			}
+
+			if (length) {
+				*length = written;
+			}
+			*size = 1;
+			*type = attribute.type;
+		}
+
+		static void APIENTRY getActiveUniform(
+			GLuint program, GLuint index, GLsizei bufSize,
+			GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
+			record("glGetActiveUniform", program, index);
+
+			auto result{ _programs.find(program) };
+			if (result == _programs.end() || index >= result->second.uniforms.size()) {
+				raise(GL_INVALID_VALUE);
+				return;
+			}
+
+			const UniformInfo& uniform{ result->second.uniforms[index] };
+			std::string reported{ uniform.array ? uniform.name + "[0]" : uniform.name };
+
+			GLsizei written{ static_cast<GLsizei>(std::min<size_t>(reported.size(), bufSize > 0 ? bufSize - 1 : 0)) };
+			if (bufSize > 0) {
+				std::copy(reported.begin(), reported.begin() + written, name);
+				name[written] = '\0';
+			}
+
+			if (length) {
+				*length = written;
+			}
+			*size = uniform.count;
+			*type = uniform.type;
+		}
+
+		static GLint APIENTRY getAttribLocation(GLuint program, const GLchar* name) {
+			record("glGetAttribLocation", program);
+
+			auto result{ _programs.find(program) };
+			if (result == _programs.end()) {
+				raise(GL_INVALID_OPERATION);
+				return -1;
+			}
+
+			for (const auto& attribute : result->second.attributes) {
+				if (attribute.name == name) {
+					return attribute.location;
+				}
+			}
+
+			return -1;
+		}
+
+		static GLenum APIENTRY getError() {
+			GLenum error{ _error };
+			_error = GL_NO_ERROR;
+
+			return error;
+		}
+
+		static void APIENTRY getInteger64v(GLenum pname, GLint64* data) {
+			record("glGetInteger64v", pname);
+			*data = pname == GL_TIMESTAMP ? static_cast<GLint64>(now()) : 0;
+		}
+
+		static void APIENTRY getIntegerv(GLenum pname, GLint* data) {
+			record("glGetIntegerv", pname);
+
+			switch (pname) {
+			case GL_CURRENT_PROGRAM:
+				*data = static_cast<GLint>(_program);
+				break;
+			case GL_VERTEX_ARRAY_BINDING:
+				*data = static_cast<GLint>(_array);
+				break;
+			case GL_FRAMEBUFFER_BINDING:
+				*data = static_cast<GLint>(_drawFramebuffer);
+				break;
+			case GL_ACTIVE_TEXTURE:
+				*data = static_cast<GLint>(GL_TEXTURE0 + _unit);
+				break;
+			default:
+				*data = 0;
+				break;
+			}
+		}
+
+		static void APIENTRY getProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+			getShaderInfoLog(program, bufSize, length, infoLog);
+		}
+
+		static void APIENTRY getProgramiv(GLuint program, GLenum pname, GLint* params) {
+			record("glGetProgramiv", program, pname);
+
+			auto result{ _programs.find(program) };
+			if (result == _programs.end()) {
+				raise(GL_INVALID_VALUE);
+				*params = 0;
+				return;
+			}
+
+			switch (pname) {
+			case GL_LINK_STATUS:
+				*params = GL_TRUE;
+				break;
+			case GL_ACTIVE_UNIFORMS:
+				*params = static_cast<GLint>(result->second.uniforms.size());
+				break;
+			case GL_ACTIVE_ATTRIBUTES:
+				*params = static_cast<GLint>(result->second.attributes.size());
+				break;
+			case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH: {
+				size_t length{};
+				for (const auto& attribute : result->second.attributes) {
+					length = std::max(length, attribute.name.size());
+				}
+				*params = static_cast<GLint>(length + 1);
+				break;
+			}
+			case GL_ACTIVE_UNIFORM_MAX_LENGTH: {
+				size_t length{};
+				for (const auto& uniform : result->second.uniforms) {
+					length = std::max(length, uniform.name.size() + 4);
+				}
+				*params = static_cast<GLint>(length + 1);
+				break;
+			}
+			default:
+				*params = 0;
+				break;
+			}
+		}
+
+		static void APIENTRY getQueryObjectiv(GLuint id, GLenum pname, GLint* params) {
+			record("glGetQueryObjectiv", id, pname);
+			*params = GL_TRUE;
+		}
+
+		static void APIENTRY getQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) {
+			record("glGetQueryObjectui64v", id, pname);
+
+			auto result{ _queries.find(id) };
+			*params = result != _queries.end() ? result->second : 0;
+		}
+
+		static void APIENTRY getShaderInfoLog([[maybe_unused]] GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+			if (length) {
+				*length = 0;
+			}
+			if (bufSize > 0) {
+				infoLog[0] = '\0';
+			}
+		}
+
+		static void APIENTRY getShaderiv(GLuint shader, GLenum pname, GLint* params) {
+			record("glGetShaderiv", shader, pname);
+			*params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+		}
+
+		static const GLubyte* APIENTRY getString(GLenum name) {
+			switch (name) {
+			case GL_VENDOR:
+				return reinterpret_cast<const GLubyte*>("Byte");
+			case GL_RENDERER:
+				return reinterpret_cast<const GLubyte*>(_recording ? "Recording device" : "Null device");
+			case GL_VERSION:
+				return reinterpret_cast<const GLubyte*>("4.1 Core");
+			default:
+				return reinterpret_cast<const GLubyte*>("");
+			}
+		}
+
+		static GLuint APIENTRY getUniformBlockIndex(GLuint program, const GLchar* uniformBlockName) {
+			record("glGetUniformBlockIndex", program, uniformBlockName);
+
+			auto result{ _programs.find(program) };
+			if (result == _programs.end()) {
+				raise(GL_INVALID_VALUE);
+				return GL_INVALID_INDEX;
+			}
+
+			const auto& blocks{ result->second.blocks };
+			auto block{ std::find(blocks.begin(), blocks.end(), uniformBlockName) };
+
+			return block != blocks.end() ? static_cast<GLuint>(block - blocks.begin()) : GL_INVALID_INDEX;
+		}
+
+		static GLint APIENTRY getUniformLocation(GLuint program, const GLchar* name) {
+			record("glGetUniformLocation", program, name);
+
+			auto result{ _programs.find(program) };
+			if (result == _programs.end()) {
+				raise(GL_INVALID_VALUE);
+				return -1;
+			}
+
+			std::string_view text{ name };
+			std::string_view base{ text };
+			GLint element{};
+
+			size_t bracket{ text.find('[') };
+			if (bracket != std::string_view::npos) {
+				base = text.substr(0, bracket);
+				element = std::stoi(std::string{ text.substr(bracket + 1) });
+			}
+
+			for (const auto& uniform : result->second.uniforms) {
+				if (uniform.name == base) {
+					return element < uniform.count ? uniform.location + element : -1;
+				}
+			}
+
+			return -1;
+		}
+
+		static void APIENTRY linkProgram(GLuint program) {
+			record("glLinkProgram", program);
+
+			auto result{ _programs.find(program) };
+			if (result == _programs.end()) {
+				raise(GL_INVALID_VALUE);
+				return;
+			}
+
+			ProgramObject& object{ result->second };
+			object.uniforms.clear();
+			object.attributes.clear();
+			object.blocks.clear();
+			object.locationCount = 0;
+
+			for (GLuint shader : object.shaders) {
+				auto source{ _shaders.find(shader) };
+				if (source != _shaders.end()) {
+					reflect(source->second, object);
+				}
+			}
+		}
+
+		static void APIENTRY patchParameteri(GLenum pname, GLint value) {
+			record("glPatchParameteri", pname, value);
+		}
+
+		static void APIENTRY pixelStorei(GLenum pname, GLint param) {
+			record("glPixelStorei", pname, param);
+		}
+
+		static void APIENTRY queryCounter(GLuint id, GLenum target) {
+			record("glQueryCounter", id, target);
+
+			auto result{ _queries.find(id) };
+			if (result == _queries.end()) {
+				raise(GL_INVALID_OPERATION);
+				return;
+			}
+
+			result->second = now();
+		}
+
+		static void APIENTRY readPixels(
+			GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, [[maybe_unused]] void* pixels) {
+			record("glReadPixels", x, y, width, height, format, type);
+
+			if (width < 0 || height < 0) {
+				raise(GL_INVALID_VALUE);
+			}
+		}
+
+		static void APIENTRY renderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+			record("glRenderbufferStorage", target, internalformat, width, height);
+		}
+
+		static void APIENTRY shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) {
+			record("glShaderSource", shader, count);
+
+			auto result{ _shaders.find(shader) };
+			if (result == _shaders.end()) {
+				raise(GL_INVALID_VALUE);
+				return;
+			}
+
+			result->second.clear();
+			for (GLsizei i{}; i < count; ++i) {
+				if (length && length[i] >= 0) {
+					result->second.append(string[i], static_cast<size_t>(length[i]));
+				}
+				else {
+					result->second.append(string[i]);
+				}
+			}
+		}
+
+		static void texture(GLenum target, size_t bytes) {
+			if (!_boundTextures[textureSlot(target)]) {
+				raise(GL_INVALID_OPERATION);
+				return;
+			}
+
+			_counters.uploadedBytes += bytes;
+		}
+
+		static void APIENTRY texBuffer(GLenum target, GLenum internalformat, GLuint buffer) {
+			record("glTexBuffer", target, internalformat, buffer);
+
+			if (!_boundTextures[textureSlot(target)]) {
+				raise(GL_INVALID_OPERATION);
+				return;
+			}
+
+			known(_buffers, buffer);
+		}
+
+		static void APIENTRY texImage2D(
+			GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+			[[maybe_unused]] GLint border, GLenum format, GLenum type, const void* pixels) {
+			record("glTexImage2D", target, level, internalformat, width, height, format, type);
+			texture(target, pixels ? static_cast<size_t>(width) * static_cast<size_t>(height) : 0);
+		}
+
+		static void APIENTRY texImage3D(
+			GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth,
+			[[maybe_unused]] GLint border, GLenum format, GLenum type, const void* pixels) {
+			record("glTexImage3D", target, level, internalformat, width, height, depth, format, type);
+			texture(target, pixels ? static_cast<size_t>(width) * static_cast<size_t>(height) * depth : 0);
+		}
+
+		static void APIENTRY texParameteri(GLenum target, GLenum pname, GLint param) {
+			record("glTexParameteri", target, pname, param);
+		}
+
+		// Validates a glUniform* call against the reflected uniform at location.
+		static void uniform(const char* name, GLint location, GLsizei count, GLenum type) {
+			record(name, location, count);
+			++_counters.uniforms;
+
+			if (location == -1) {
+				return;
+			}
+
+			auto result{ _programs.find(_program) };
+			if (result == _programs.end()) {
+				raise(GL_INVALID_OPERATION);
+				return;
+			}
+
+			for (const auto& uniform : result->second.uniforms) {
+				if (location < uniform.location || location >= uniform.location + uniform.count) {
+					continue;
+				}
+
+				if (!compatible(uniform.type, type) || (count > 1 && !uniform.array)) {
+					raise(GL_INVALID_OPERATION);
+				}
+				return;
+			}
+
+			raise(GL_INVALID_OPERATION);
+		}
+
+		static void APIENTRY uniform1fv(GLint location, GLsizei count, [[maybe_unused]] const GLfloat* value) {
+			uniform("glUniform1fv", location, count, GL_FLOAT);
+		}
+
+		static void APIENTRY uniform1iv(GLint location, GLsizei count, [[maybe_unused]] const GLint* value) {
+			uniform("glUniform1iv", location, count, GL_INT);
+		}
+
+		static void APIENTRY uniform1uiv(GLint location, GLsizei count, [[maybe_unused]] const GLuint* value) {
+			uniform("glUniform1uiv", location, count, GL_UNSIGNED_INT);
+		}
+
+		static void APIENTRY uniform2fv(GLint location, GLsizei count, [[maybe_unused]] const GLfloat* value) {
+			uniform("glUniform2fv", location, count, GL_FLOAT_VEC2);
+		}
+
+		static void APIENTRY uniform3fv(GLint location, GLsizei count, [[maybe_unused]] const GLfloat* value) {
+			uniform("glUniform3fv", location, count, GL_FLOAT_VEC3);
+		}
+
+		static void APIENTRY uniform4fv(GLint location, GLsizei count, [[maybe_unused]] const GLfloat* value) {
+			uniform("glUniform4fv", location, count, GL_FLOAT_VEC4);
+		}
+
+		static void APIENTRY uniformMatrix2fv(GLint location, GLsizei count, [[maybe_unused]] GLboolean transpose, [[maybe_unused]] const GLfloat* value) {
+			uniform("glUniformMatrix2fv", location, count, GL_FLOAT_MAT2);
+		}
+
+		static void APIENTRY uniformMatrix3fv(GLint location, GLsizei count, [[maybe_unused]] GLboolean transpose, [[maybe_unused]] const GLfloat* value) {
+			uniform("glUniformMatrix3fv", location, count, GL_FLOAT_MAT3);
+		}
+
+		static void APIENTRY uniformMatrix4fv(GLint location, GLsizei count, [[maybe_unused]] GLboolean transpose, [[maybe_unused]] const GLfloat* value) {
+			uniform("glUniformMatrix4fv", location, count, GL_FLOAT_MAT4);
+		}
+
+		static void APIENTRY uniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding) {
+			record("glUniformBlockBinding", program, uniformBlockIndex, uniformBlockBinding);
+
+			auto result{ _programs.find(program) };
+			if (result == _programs.end() || uniformBlockIndex >= result->second.blocks.size()) {
+				raise(GL_INVALID_VALUE);
+			}
+		}
+
+		static void APIENTRY useProgram(GLuint program) {
+			record("glUseProgram", program);
+			++_counters.binds;
+
+			if (program && !_programs.count(program)) {
+				raise(GL_INVALID_VALUE);
+				return;
+			}
+
+			_program = program;
+		}
+
+		static void APIENTRY vertexAttribDivisor(GLuint index, GLuint divisor) {
+			record("glVertexAttribDivisor", index, divisor);
+		}
+
+		static void APIENTRY vertexAttribPointer(
+			GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, [[maybe_unused]] const void* pointer) {
+			record("glVertexAttribPointer", index, size, type, static_cast<int>(normalized), stride);
+
+			if (!_array || !_boundBuffers[GL_ARRAY_BUFFER]) {
+				raise(GL_INVALID_OPERATION);
+			}
+		}
+
+		static void APIENTRY viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+			record("glViewport", x, y, width, height);
+
+			if (width < 0 || height < 0) {
+				raise(GL_INVALID_VALUE);
+			}
+		}
+
+		static bool compatible(GLenum uniform, GLenum call) {
+			switch (call) {
+			case GL_INT:
+				return uniform == GL_INT || uniform == GL_BOOL ||
+					uniform == GL_SAMPLER_2D || uniform == GL_SAMPLER_2D_ARRAY || uniform == GL_SAMPLER_BUFFER;
+			case GL_UNSIGNED_INT:
+				return uniform == GL_UNSIGNED_INT || uniform == GL_BOOL;
+			case GL_FLOAT:
+				return uniform == GL_FLOAT || uniform == GL_BOOL;
+			default:
+				return uniform == call;
+			}
+		}
+
+		static GLenum type(std::string_view name) {
+			static const std::unordered_map<std::string_view, GLenum> types{
+				{ "float", GL_FLOAT },
+				{ "vec2", GL_FLOAT_VEC2 },
+				{ "vec3", GL_FLOAT_VEC3 },
+				{ "vec4", GL_FLOAT_VEC4 },
+				{ "int", GL_INT },
+				{ "ivec2", GL_INT_VEC2 },
+				{ "ivec3", GL_INT_VEC3 },
+				{ "ivec4", GL_INT_VEC4 },
+				{ "uint", GL_UNSIGNED_INT },
+				{ "bool", GL_BOOL },
+				{ "mat2", GL_FLOAT_MAT2 },
+				{ "mat3", GL_FLOAT_MAT3 },
+				{ "mat4", GL_FLOAT_MAT4 },
+				{ "sampler2D", GL_SAMPLER_2D },
+				{ "sampler2DArray", GL_SAMPLER_2D_ARRAY },
+				{ "samplerBuffer", GL_SAMPLER_BUFFER },
+			};
+
+			auto result{ types.find(name) };
+			return result != types.end() ? result->second : GL_FLOAT;
+		}
+
+		static Buffer<std::string> split(std::string_view text, std::string_view separators) {
+			Buffer<std::string> tokens;
+			size_t begin{};
+
+			while (begin < text.size()) {
+				size_t end{ text.find_first_of(separators, begin) };
+				if (end == std::string_view::npos) {
+					end = text.size();
+				}
+
+				if (end > begin) {
+					tokens.emplace_back(text.substr(begin, end - begin));
+				}
+
+				begin = end + 1;
+			}
+
+			return tokens;
+		}
+
+		// Declares "type name" or "type name[N]" in program, once per name.
+		static void declare(ProgramObject& program, std::string_view typeName, std::string name, const std::string& prefix = "") {
+			UniformInfo uniform{};
+			uniform.type = type(typeName);
+
+			size_t bracket{ name.find('[') };
+			if (bracket != std::string::npos) {
+				uniform.count = std::max(1, std::atoi(name.c_str() + bracket + 1));
+				uniform.array = true;
+				name.resize(bracket);
+			}
+
+			uniform.name = prefix + name;
+
+			bool exists{ std::any_of(program.uniforms.begin(), program.uniforms.end(), [&uniform](const UniformInfo& other) {
+				return other.name == uniform.name;
+			}) };
+
+			if (exists) {
+				return;
+			}
+
+			uniform.location = program.locationCount;
+			program.locationCount += uniform.count;
+			program.uniforms.push_back(std::move(uniform));
+		}
+
+		// Finds top-level uniform declarations: plain uniforms, uniform structs and uniform blocks,
+		// and inputs declared with an explicit location, which only vertex shaders use here.
+		static void reflect(const std::string& source, ProgramObject& program) {
+			std::string text;
+			text.reserve(source.size());
+
+			for (size_t i{}; i < source.size(); ++i) {
+				if (source.compare(i, 2, "//") == 0) {
+					i = std::min(source.find('\n', i), source.size()) - 1;
+				}
+				else if (source.compare(i, 2, "/*") == 0) {
+					size_t end{ source.find("*/", i + 2) };
+					i = end == std::string::npos ? source.size() : end + 1;
+				}
+				else {
+					text.push_back(source[i]);
+				}
+			}
+
+			auto word = [&text](size_t position, std::string_view value) {
+				auto boundary = [](char c) {
+					return !(std::isalnum(static_cast<unsigned char>(c)) || c == '_');
+				};
+
+				return text.compare(position, value.size(), value) == 0 &&
+					(position == 0 || boundary(text[position - 1])) &&
+					(position + value.size() >= text.size() || boundary(text[position + value.size()]));
+			};
+
+			int depth{};
+			for (size_t i{}; i < text.size(); ++i) {
+				if (text[i] == '{') {
+					++depth;
+					continue;
+				}
+				if (text[i] == '}') {
+					--depth;
+					continue;
+				}
+				if (depth == 0 && word(i, "layout")) {
+					size_t close{ text.find(')', i) };
+					size_t next{ close == std::string::npos ? text.size() : text.find_first_not_of(" \t\r\n", close + 1) };
+
+					if (next != std::string::npos && next < text.size() && word(next, "in")) {
+						std::string qualifier{ text.substr(i, close - i) };
+						size_t location{ qualifier.find("location") };
+						size_t equals{ qualifier.find('=', location) };
+
+						size_t end{ std::min(text.find(';', next), text.size()) };
+						Buffer<std::string> tokens{ split(text.substr(next + 2, end - next - 2), " \t\r\n") };
+
+						if (location != std::string::npos && equals != std::string::npos && tokens.size() >= 2) {
+							AttributeInfo attribute{ tokens[1], type(tokens[0]), std::atoi(qualifier.c_str() + equals + 1) };
+
+							bool exists{ std::any_of(program.attributes.begin(), program.attributes.end(), [&attribute](const AttributeInfo& other) {
+								return other.name == attribute.name;
+							}) };
+
+							if (!exists) {
+								program.attributes.push_back(std::move(attribute));
+							}
+						}
+
+						i = end;
+						continue;
+					}
+				}
+
+				if (depth != 0 || !word(i, "uniform")) {
+					continue;
+				}
+
+				size_t end{ i };
+				int local{};
+				while (end < text.size() && !(text[end] == ';' && local == 0)) {
+					local += text[end] == '{' ? 1 : text[end] == '}' ? -1 : 0;
+					++end;
+				}
+
+				std::string declaration{ text.substr(i + 7, end - i - 7) };
+				i = end;
+
+				size_t open{ declaration.find('{') };
+				if (open == std::string::npos) {
+					Buffer<std::string> tokens{ split(declaration, " \t\r\n,") };
+
+					size_t first{};
+					while (first < tokens.size() &&
+						(tokens[first] == "lowp" || tokens[first] == "mediump" || tokens[first] == "highp")) {
+						++first;
+					}
+
+					for (size_t t{ first + 1 }; t < tokens.size(); ++t) {
+						std::string name{ tokens[t] };
+						if (name.front() == '[' && t > first + 1) {
+							declare(program, tokens[first], tokens[t - 1] + name);
+							continue;
+						}
+						if (t + 1 < tokens.size() && tokens[t + 1].front() == '[') {
+							continue;
+						}
+						declare(program, tokens[first], name);
+					}
+					continue;
+				}
+
+				size_t close{ declaration.rfind('}') };
+				Buffer<std::string> head{ split(declaration.substr(0, open), " \t\r\n") };
+				Buffer<std::string> tail{ split(declaration.substr(close + 1), " \t\r\n") };
+
+				if (!head.empty() && head.front() == "struct") {
+					std::string prefix{ tail.empty() ? "" : tail.front() + "." };
+
+					for (const auto& member : split(declaration.substr(open + 1, close - open - 1), ";")) {
+						Buffer<std::string> tokens{ split(member, " \t\r\n") };
+						if (tokens.size() >= 2) {
+							declare(program, tokens[0], tokens[1], prefix);
+						}
+					}
+				}
+				else if (!head.empty()) {
+					if (std::find(program.blocks.begin(), program.blocks.end(), head.back()) == program.blocks.end()) {
+						program.blocks.push_back(head.back());
+					}
+				}
+			}
+		}
+	};
+
+}
@@ -2,37 +2,65 @@
 
 #include <cstdint>
 #include <fstream>
+#include <array>
 #include <algorithm>
+#include <type_traits>
 
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 
 #include "core/window.h"
+#include "core/vertex_format.h"
 #include "math/mat.h"
 #include "math/vec.h"
 #include "math/quaternion.h"
 #include "render_type.h"
+#include "null_device.h"
 
 namespace Byte {
 
     class RenderAPI {
+    private:
+        inline static RenderBackend _backend{ RenderBackend::OPENGL };
+
     public:
         static void initialize(Window& window) {
             static bool initialized{ false };
 
-            glfwMakeContextCurrent(window.glfwWindow);
-            glfwSetFramebufferSizeCallback(window.glfwWindow, RenderAPI::framebufferSizeCallback);
+            if (_backend == RenderBackend::OPENGL) {
+                glfwMakeContextCurrent(window.glfwWindow);
+                glfwSetFramebufferSizeCallback(window.glfwWindow, RenderAPI::framebufferSizeCallback);
+            }
 
             if (!initialized) {
-                glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-                glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
-                glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+                if (_backend == RenderBackend::OPENGL) {
+                    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+                    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+                    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+                    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+                        throw std::exception{ "GLAD cannot be loaded" };
+                    }
 
-                if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-                    throw std::exception{ "GLAD cannot be loaded" };
+                    // Arena draws find their index through baseInstance, which 4.0 and 4.1 ignore.
+                    bool multiDraw{ GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3) };
+                    bool baseInstance{ GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 2) };
+
+                    multiDraw = multiDraw || glfwExtensionSupported("GL_ARB_multi_draw_indirect");
+                    baseInstance = baseInstance || glfwExtensionSupported("GL_ARB_base_instance");
+
+                    if (multiDraw && baseInstance) {
+                        Draw::multiDrawIndirect(reinterpret_cast<Draw::MultiDrawIndirect>(
+                            glfwGetProcAddress("glMultiDrawElementsIndirect")));
+                    }
+                }
+                else {
+                    NullDevice::install(_backend == RenderBackend::RECORDING);
+                    Draw::multiDrawIndirect(NullDevice::multiDrawElementsIndirect);
                 }
 
-                glEnable(GL_DEPTH_TEST);
+                State::invalidate();
+                State::depthTest(true);
 
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -47,36 +75,54 @@ namespace Byte {
         }
 
         static void update(Window& window) {
-            glfwSwapBuffers(window.glfwWindow);
+            // Headless frames stay in the default framebuffer until the next frame clears it,
+            // so they can still be read back.
+            if (window.headless()) {
+                return;
+            }
+
+            if (window.glfwWindow) {
+                glfwSwapBuffers(window.glfwWindow);
+            }
+            State::framebuffer(Framebuffer::defaultFramebuffer());
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         }
 
+        // Must be chosen before the first initialize; NULL_DEVICE and RECORDING need no context.
+        static void backend(RenderBackend backend) {
+            _backend = backend;
+        }
+
+        static RenderBackend backend() {
+            return _backend;
+        }
+
         static void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
-            glViewport(0, 0, width, height);
+            State::viewport(0, 0, width, height);
         }
 
         static void enableDepthMask() {
-            glDepthMask(GL_TRUE);
+            State::depthMask(true);
         }
 
         static void disableDepthMask() {
-            glDepthMask(GL_FALSE);
+            State::depthMask(false);
         }
 
         static void enableDepth() {
-            glEnable(GL_DEPTH_TEST);
+            State::depthTest(true);
         }
 
         static void disableDepth() {
-            glDisable(GL_DEPTH_TEST);
+            State::depthTest(false);
         }
 
         static void enableBlend() {
-            glEnable(GL_BLEND);
+            State::blend(true);
         }
 
         static void disableBlend() {
-            glDisable(GL_BLEND);
+            State::blend(false);
         }
 
         static void setBlend(float sFactor, float dFactor) {
@@ -88,36 +134,36 @@ namespace Byte {
             float sNorm{ sFactor / total };
             float dNorm{ dFactor / total };
 
-            glBlendColor(sNorm, sNorm, sNorm, dNorm);
-            glBlendFunc(GL_CONSTANT_COLOR, GL_ONE_MINUS_CONSTANT_COLOR);
+            State::blendColor(sNorm, sNorm, sNorm, dNorm);
+            State::blendFunction(GL_CONSTANT_COLOR, GL_ONE_MINUS_CONSTANT_COLOR);
         }
 
         static void setBlendAdditive() {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_ONE, GL_ONE);
-            glBlendEquation(GL_FUNC_ADD);
+            State::blend(true);
+            State::blendFunction(GL_ONE, GL_ONE);
+            State::blendEquation(GL_FUNC_ADD);
         }
 
         static void setBlendTransparency() {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glBlendEquation(GL_FUNC_ADD);
+            State::blend(true);
+            State::blendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            State::blendEquation(GL_FUNC_ADD);
         }
 
         static void cullFront() {
-            glCullFace(GL_FRONT);
+            State::cullFace(GL_FRONT);
         }
 
         static void cullBack() {
-            glCullFace(GL_BACK);
+            State::cullFace(GL_BACK);
         }
 
         static void enableCulling() {
-            glEnable(GL_CULL_FACE);
+            State::culling(true);
         }
 
         static void disableCulling() {
-            glDisable(GL_CULL_FACE);
+            State::culling(false);
         }
 
         static void patchParameter(size_t value) {
@@ -130,7 +176,7 @@ namespace Byte {
             GLint glX{ static_cast<GLint>(x) };
             GLint glY{ static_cast<GLint>(y) };
 
-            glViewport(glX, glY, glWidth, glHeight);
+            State::viewport(glX, glY, glWidth, glHeight);
         }
 
         static void clearColor(Vec3 color) {
@@ -142,9 +188,23 @@ namespace Byte {
         }
 
         struct Framebuffer {
+        private:
+            inline static FramebufferID _default{};
+
+        public:
+            // Framebuffer bound in place of 0, so headless contexts without a window surface
+            // still have a target to present into.
+            static void defaultFramebuffer(FramebufferID id) {
+                _default = id;
+            }
+
+            static FramebufferID defaultFramebuffer() {
+                return _default;
+            }
+
             static void build(FramebufferData& data) {
                 glGenFramebuffers(1, &data.id);
-                glBindFramebuffer(GL_FRAMEBUFFER, data.id);
+                State::framebuffer(data.id);
 
                 GLint glWidth{ static_cast<GLint>(data.width) };
                 GLint glHeight{ static_cast<GLint>(data.height) };
@@ -191,28 +251,34 @@ namespace Byte {
                     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
                 }
 
+                if (!data.attachments.empty()) {
+                    Buffer<GLenum> attachments;
+                    for (auto& att : data.attachments) {
+                        attachments.push_back(TypeCast::convert(att));
+                    }
+                    glDrawBuffers(static_cast<GLsizei>(attachments.size()), attachments.data());
+                }
+
                 if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
                     release(data);
                     throw std::exception("Framebuffer not complete");
                 }
 
-                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                State::framebuffer(_default);
             }
 
             static void clear(FramebufferID id) {
-                glBindFramebuffer(GL_FRAMEBUFFER, id);
+                State::framebuffer(id);
                 glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             }
 
             static void clearDepth(FramebufferID id) {
-                glBindFramebuffer(GL_FRAMEBUFFER, id);
+                State::framebuffer(id);
                 glClear(GL_DEPTH_BUFFER_BIT);
             }
 
             static void blitDepth(FramebufferData& source, FramebufferData& destination) {
-                glBindFramebuffer(GL_READ_FRAMEBUFFER, source.id);
-
-                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destination.id);
+                State::framebuffer(source.id, destination.id);
 
                 GLint sourceWidth{ static_cast<GLint>(source.width) };
                 GLint sourceHeight{ static_cast<GLint>(source.height) };
@@ -226,29 +292,39 @@ namespace Byte {
                     GL_NEAREST
                 );
 
-                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                State::framebuffer(_default);
             }
 
             static void bind(FramebufferData& data) {
-                glBindFramebuffer(GL_FRAMEBUFFER, data.id);
-
-                if (!data.attachments.empty()) {
-                    Buffer<uint32_t> attachments;
-                    for (auto& att : data.attachments) {
-                        attachments.push_back(TypeCast::convert(att));
-                    }
-                    glDrawBuffers(static_cast<GLsizei>(attachments.size()), attachments.data());
-                }
-
-                glViewport(0,0,static_cast<GLsizei>(data.width),static_cast<GLsizei>(data.height));
+                State::framebuffer(data.id);
+                State::viewport(0, 0, static_cast<GLsizei>(data.width), static_cast<GLsizei>(data.height));
             }
 
             static void unbind() {
-                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                State::framebuffer(_default);
+            }
+
+            // Reads the color attachment of id back as tightly packed RGBA8 rows, bottom row first.
+            static Buffer<uint8_t> read(FramebufferID id, size_t width, size_t height) {
+                Buffer<uint8_t> pixels(width * height * 4);
+
+                State::framebuffer(id);
+                glPixelStorei(GL_PACK_ALIGNMENT, 1);
+                glReadPixels(
+                    0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height),
+                    GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+                return pixels;
             }
 
             static void release(FramebufferData& data) {
-                glDeleteBuffers(1, &data.id);
+                glDeleteFramebuffers(1, &data.id);
+                State::forgetFramebuffer(data.id);
+
+                // Falls back to the window surface once the headless target is gone.
+                if (data.id && data.id == _default) {
+                    _default = 0;
+                }
 
                 data.id = 0;
 
@@ -265,32 +341,95 @@ namespace Byte {
         };
 
         struct Draw {
-            static void elements(size_t size, PrimitiveType type = PrimitiveType::TRIANGLES) {
-                glDrawElements(TypeCast::convert(type), static_cast<GLint>(size), GL_UNSIGNED_INT, 0);
+            using MultiDrawIndirect = void (APIENTRYP)(GLenum, GLenum, const void*, GLsizei, GLsizei);
+
+            static void elements(
+                size_t size,
+                PrimitiveType type = PrimitiveType::TRIANGLES,
+                IndexType index = IndexType::UINT32,
+                size_t firstIndex = 0) {
+                glDrawElements(
+                    TypeCast::convert(type),
+                    static_cast<GLint>(size),
+                    TypeCast::convert(index),
+                    (void*)(firstIndex * TypeCast::size(index)));
+            }
+
+            // Ignores baseInstance, which GL 4.1 cannot express; instance IDs start at zero.
+            static void elements(
+                const IndirectCommand& command,
+                PrimitiveType type = PrimitiveType::TRIANGLES,
+                IndexType index = IndexType::UINT32) {
+                glDrawElementsInstancedBaseVertex(
+                    TypeCast::convert(type),
+                    static_cast<GLsizei>(command.count),
+                    TypeCast::convert(index),
+                    (void*)(command.firstIndex * TypeCast::size(index)),
+                    static_cast<GLsizei>(command.instanceCount),
+                    command.baseVertex);
             }
 
             static void instancedElements(
                 size_t size, 
                 size_t instanceCount, 
-                PrimitiveType type = PrimitiveType::TRIANGLES) {
+                PrimitiveType type = PrimitiveType::TRIANGLES,
+                IndexType index = IndexType::UINT32) {
                 if (instanceCount) {
                     GLint glSize{ static_cast<GLint>(size) };
                     GLsizei glCount{ static_cast<GLsizei>(instanceCount) };
-                    glDrawElementsInstanced(TypeCast::convert(type), glSize, GL_UNSIGNED_INT, 0, glCount);
+                    glDrawElementsInstanced(TypeCast::convert(type), glSize, TypeCast::convert(index), 0, glCount);
                 }
             }
 
             static void quad() {
                 glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+
+            // Needs GL 4.3 or ARB_multi_draw_indirect; callers fall back to one draw per command.
+            static bool indirectSupported() {
+                return _multiDrawIndirect != nullptr;
+            }
 
-                glBindVertexArray(0);
+            static void multiDrawIndirect(MultiDrawIndirect function) {
+                _multiDrawIndirect = function;
             }
+
+            // Streams the commands into a shared indirect buffer and submits them in one call.
+            static void indirectElements(
+                const IndirectCommand* commands,
+                size_t count,
+                PrimitiveType type = PrimitiveType::TRIANGLES,
+                IndexType index = IndexType::UINT32) {
+                if (!count) {
+                    return;
+                }
+
+                if (!_indirectBuffer) {
+                    glGenBuffers(1, &_indirectBuffer);
+                }
+
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirectBuffer);
+                glBufferData(GL_DRAW_INDIRECT_BUFFER, count * sizeof(IndirectCommand), commands, GL_STREAM_DRAW);
+
+                _multiDrawIndirect(
+                    TypeCast::convert(type),
+                    TypeCast::convert(index),
+                    nullptr,
+                    static_cast<GLsizei>(count),
+                    0);
+            }
+
+        private:
+            inline static MultiDrawIndirect _multiDrawIndirect{};
+            inline static uint32_t _indirectBuffer{};
         };
 
         struct RenderArray {
+            // Vertices may be any contiguous range, such as a Buffer or a span over mapped memory.
+            template<typename Vertices, typename Index>
             static RenderArrayData build(
-                const Buffer<float>& vertices,
-                const Buffer<uint32_t>& indices,
+                const Vertices& vertices,
+                const Buffer<Index>& indices,
                 Buffer<VertexAttribute>& attributes, 
                 bool isStatic) {
                 uint32_t VAO, VBO, EBO;
@@ -298,12 +437,12 @@ namespace Byte {
                 auto draw{ isStatic ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW };
 
                 glGenVertexArrays(1, &VAO);
-                glBindVertexArray(VAO);
+                State::renderArray(VAO);
 
                 glGenBuffers(1, &VBO);
                 glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-                glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), draw);
+                glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(*vertices.data()), vertices.data(), draw);
 
                 uint32_t vertexStride{};
 
@@ -325,18 +464,19 @@ namespace Byte {
 
                 glGenBuffers(1, &EBO);
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), draw);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(Index), indices.data(), draw);
 
-                glBindVertexArray(0);
+                State::renderArray(0);
 
                 Buffer<RBufferData> buffers{ RBufferData{VBO,attributes} };
 
-                return RenderArrayData{ VAO, buffers, EBO, indices.size() };
+                return RenderArrayData{ VAO, buffers, EBO, indices.size(), indexType<Index>() };
             }
 
+            template<typename Vertices, typename Index>
             static RenderArrayData build(
-                const Buffer<float>& vertices,
-                const Buffer<uint32_t>& indices,
+                const Vertices& vertices,
+                const Buffer<Index>& indices,
                 Buffer<VertexAttribute>& attributes,
                 Buffer<VertexAttribute>& instanceAttributes,
                 bool isStatic) {
@@ -346,11 +486,11 @@ namespace Byte {
                 auto draw{ isStatic ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW };
 
                 glGenVertexArrays(1, &VAO);
-                glBindVertexArray(VAO);
+                State::renderArray(VAO);
 
                 glGenBuffers(1, &VBO);
                 glBindBuffer(GL_ARRAY_BUFFER, VBO);
-                glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), draw);
+                glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(*vertices.data()), vertices.data(), draw);
 
                 uint32_t vertexStride{};
                 for (auto& attribute : attributes) {
@@ -371,7 +511,7 @@ namespace Byte {
 
                 glGenBuffers(1, &EBO);
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), draw);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(Index), indices.data(), draw);
 
                 glGenBuffers(1, &iVBO);
                 glBindBuffer(GL_ARRAY_BUFFER, iVBO);
@@ -392,11 +532,11 @@ namespace Byte {
                     glEnableVertexAttribArray(attribute.index);
                     glVertexAttribDivisor(attribute.index, 1);
                 }
-                glBindVertexArray(0);
+                State::renderArray(0);
 
                 Buffer<RBufferData> buffers{ RBufferData{VBO,attributes}, RBufferData{iVBO,attributes} };
 
-                return RenderArrayData{ VAO, buffers, EBO, indices.size() };
+                return RenderArrayData{ VAO, buffers, EBO, indices.size(), indexType<Index>() };
             }
 
             static Buffer<VertexAttribute> buildAttributes(const Buffer<uint8_t>& layout, uint8_t indexOffset = 0) {
@@ -417,6 +557,62 @@ namespace Byte {
                 return atts;
             }
 
+            static Buffer<VertexAttribute> buildAttributes(
+                const Buffer<uint8_t>& layout,
+                const Buffer<VertexType>& types,
+                uint8_t indexOffset = 0) {
+                uint16_t offset{ 0 };
+
+                Buffer<VertexAttribute> atts;
+
+                for (uint8_t index{ 0 }; index < layout.size(); ++index) {
+                    VertexType type{ VertexFormat::type(types, index) };
+
+                    uint32_t size{ static_cast<uint32_t>(VertexFormat::componentSize(type)) };
+                    uint16_t count{ static_cast<uint16_t>(VertexFormat::components(type, layout[index])) };
+                    uint8_t i{ static_cast<uint8_t>(index + indexOffset) };
+
+                    atts.push_back(VertexAttribute{ 0, size, glType(type), offset, count, i, VertexFormat::normalized(type) });
+
+                    offset += static_cast<uint16_t>(size * count);
+                }
+
+                return atts;
+            }
+
+            template<typename Index>
+            static constexpr IndexType indexType() {
+                static_assert(std::is_same_v<Index, uint16_t> || std::is_same_v<Index, uint32_t>, "Unsupported index type");
+                return std::is_same_v<Index, uint16_t> ? IndexType::UINT16 : IndexType::UINT32;
+            }
+
+            // Indices fit in 16 bits while none of them addresses past vertex 65535.
+            static IndexType indexType(const Buffer<uint32_t>& indices) {
+                for (uint32_t index : indices) {
+                    if (index > UINT16_MAX) {
+                        return IndexType::UINT32;
+                    }
+                }
+
+                return IndexType::UINT16;
+            }
+
+            static uint32_t glType(VertexType type) {
+                switch (type) {
+                case VertexType::HALF_FLOAT:
+                    return GL_HALF_FLOAT;
+                case VertexType::SNORM16:
+                case VertexType::OCTAHEDRAL:
+                    return GL_SHORT;
+                case VertexType::UNORM16:
+                    return GL_UNSIGNED_SHORT;
+                case VertexType::UNORM8:
+                    return GL_UNSIGNED_BYTE;
+                default:
+                    return GL_FLOAT;
+                }
+            }
+
             static void fillArray(Buffer<float>& data, bool isStatic) {
                 auto draw{ isStatic ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW };
                 glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), draw);
@@ -425,6 +621,7 @@ namespace Byte {
             static void release(RenderArrayData& renderArrayData) {
                 if (renderArrayData.VAO != 0) {
                     glDeleteVertexArrays(1, &renderArrayData.VAO);
+                    State::forgetRenderArray(renderArrayData.VAO);
 
                     for (const auto& VBuffer : renderArrayData.VBuffers) {
                         glDeleteBuffers(1, &VBuffer.id);
@@ -435,11 +632,12 @@ namespace Byte {
             }
 
             static void bind(RenderArrayID id) {
-                glBindVertexArray(id);
+                State::renderArray(id);
             }
 
+            // Left bound until the next bind; nothing draws without binding its own array.
             static void unbind() {
-                glBindVertexArray(0);
+                State::skip();
             }
 
             static void bufferData(RenderBufferID id, Buffer<float>& data, size_t size, bool isStatic) {
@@ -453,11 +651,19 @@ namespace Byte {
                 glBindBuffer(GL_ARRAY_BUFFER, id);
                 glBufferSubData(GL_ARRAY_BUFFER, offset, data.size() * sizeof(float), data.data());
             }
+
+            // Goes through the copy target so neither the bound array nor its element buffer changes.
+            static void subBufferData(RenderBufferID id, const void* data, size_t offset, size_t size) {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+                glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            }
         };
 
         struct Program {
             static void release(uint32_t id) {
                 glDeleteProgram(id);
+                State::forgetProgram(id);
             }
 
             static uint32_t build(
@@ -498,15 +704,118 @@ namespace Byte {
                 }
 
             }
+
+            static Buffer<UniformData> uniforms(uint32_t program) {
+                GLint count{};
+                GLint length{};
+                glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+                glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &length);
+
+                Buffer<UniformData> uniforms;
+                std::string name(static_cast<size_t>(length), '\0');
+
+                for (GLint i{}; i < count; ++i) {
+                    GLsizei written{};
+                    GLint size{};
+                    GLenum type{};
+                    glGetActiveUniform(program, i, length, &written, &size, &type, name.data());
+
+                    UniformData data{ name.substr(0, written) };
+                    data.location = glGetUniformLocation(program, data.name.c_str());
+
+                    // Block members have no location.
+                    if (data.location < 0) {
+                        continue;
+                    }
+
+                    data.count = static_cast<size_t>(size);
+                    data.size = TypeCast::size(type);
+
+                    uniforms.push_back(std::move(data));
+                }
+
+                return uniforms;
+            }
+
+            static int32_t location(uint32_t program, const std::string& name) {
+                return glGetUniformLocation(program, name.c_str());
+            }
+
+            static Buffer<AttributeData> attributes(uint32_t program) {
+                GLint count{};
+                GLint length{};
+                glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+                glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &length);
+
+                Buffer<AttributeData> attributes;
+                std::string name(static_cast<size_t>(length), '\0');
+
+                for (GLint i{}; i < count; ++i) {
+                    GLsizei written{};
+                    GLint size{};
+                    GLenum type{};
+                    glGetActiveAttrib(program, i, length, &written, &size, &type, name.data());
+
+                    AttributeData data{ name.substr(0, written) };
+                    data.location = glGetAttribLocation(program, data.name.c_str());
+
+                    // Built-in inputs such as gl_VertexID have no location.
+                    if (data.location < 0) {
+                        continue;
+                    }
+
+                    switch (type) {
+                    case GL_INT:
+                    case GL_UNSIGNED_INT:
+                        data.integer = true;
+                        [[fallthrough]];
+                    case GL_FLOAT:
+                        data.components = 1;
+                        break;
+                    case GL_INT_VEC2:
+                    case GL_UNSIGNED_INT_VEC2:
+                        data.integer = true;
+                        [[fallthrough]];
+                    case GL_FLOAT_VEC2:
+                        data.components = 2;
+                        break;
+                    case GL_INT_VEC3:
+                    case GL_UNSIGNED_INT_VEC3:
+                        data.integer = true;
+                        [[fallthrough]];
+                    case GL_FLOAT_VEC3:
+                        data.components = 3;
+                        break;
+                    case GL_INT_VEC4:
+                    case GL_UNSIGNED_INT_VEC4:
+                        data.integer = true;
+                        [[fallthrough]];
+                    default:
+                        data.components = 4;
+                        break;
+                    }
+
+                    attributes.push_back(std::move(data));
+                }
+
+                return attributes;
+            }
+
+            static void blockBinding(uint32_t program, const char* name, uint32_t binding) {
+                GLuint index{ glGetUniformBlockIndex(program, name) };
+                if (index != GL_INVALID_INDEX) {
+                    glUniformBlockBinding(program, index, binding);
+                }
+            }
         };
 
         struct Shader {
             static void bind(uint32_t id) {
-                glUseProgram(id);
+                State::program(id);
             }
 
             static void unbind() {
-                glUseProgram(0);
+                State::skip();
             }
 
             static void release(uint32_t id) {
@@ -514,74 +823,53 @@ namespace Byte {
             }
 
             template<typename Type>
-            static void uniform(uint32_t id, const std::string& name, const Type& value) {
+            static void uniform(int32_t location, const Type* values, size_t count) {
                 throw std::exception("No such uniform type");
             }
 
             template<>
-            static void uniform<bool>(uint32_t id, const std::string& name, const bool& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniform1i(loc, (int)value);
+            static void uniform<int>(int32_t location, const int* values, size_t count) {
+                glUniform1iv(location, static_cast<GLsizei>(count), values);
             }
 
             template<>
-            static void uniform<int>(uint32_t id, const std::string& name, const int& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniform1i(loc, value);
+            static void uniform<uint32_t>(int32_t location, const uint32_t* values, size_t count) {
+                glUniform1uiv(location, static_cast<GLsizei>(count), values);
             }
 
             template<>
-            static void uniform<size_t>(uint32_t id, const std::string& name, const size_t& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniform1i(loc, static_cast<GLint>(value));
+            static void uniform<float>(int32_t location, const float* values, size_t count) {
+                glUniform1fv(location, static_cast<GLsizei>(count), values);
             }
 
             template<>
-            static void uniform<float>(uint32_t id, const std::string& name, const float& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniform1f(loc, value);
+            static void uniform<Vec2>(int32_t location, const Vec2* values, size_t count) {
+                glUniform2fv(location, static_cast<GLsizei>(count), &values->x);
             }
 
             template<>
-            static void uniform<Vec2>(uint32_t id, const std::string& name, const Vec2& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniform2f(loc, value.x, value.y);
+            static void uniform<Vec3>(int32_t location, const Vec3* values, size_t count) {
+                glUniform3fv(location, static_cast<GLsizei>(count), &values->x);
             }
 
             template<>
-            static void uniform<Vec3>(uint32_t id, const std::string& name, const Vec3& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniform3f(loc, value.x, value.y, value.z);
+            static void uniform<Vec4>(int32_t location, const Vec4* values, size_t count) {
+                glUniform4fv(location, static_cast<GLsizei>(count), &values->x);
             }
 
             template<>
-            static void uniform<Vec4>(uint32_t id, const std::string& name, const Vec4& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniform4f(loc, value.x, value.y, value.z, value.w);
+            static void uniform<Mat2>(int32_t location, const Mat2* values, size_t count) {
+                glUniformMatrix2fv(location, static_cast<GLsizei>(count), GL_FALSE, values->data);
             }
 
             template<>
-            static void uniform<Quaternion>(uint32_t id, const std::string& name, const Quaternion& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniform4f(loc, value.x, value.y, value.z, value.w);
+            static void uniform<Mat3>(int32_t location, const Mat3* values, size_t count) {
+                glUniformMatrix3fv(location, static_cast<GLsizei>(count), GL_FALSE, values->data);
             }
 
             template<>
-            static void uniform<Mat2>(uint32_t id, const std::string& name, const Mat2& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniformMatrix2fv(loc, 1, GL_FALSE, value.data);
-            }
-
-            template<>
-            static void uniform<Mat3>(uint32_t id, const std::string& name, const Mat3& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniformMatrix3fv(loc, 1, GL_FALSE, value.data);
-            }
-
-            template<>
-            static void uniform<Mat4>(uint32_t id, const std::string& name, const Mat4& value) {
-                auto loc{ glGetUniformLocation(id, name.c_str()) };
-                glUniformMatrix4fv(loc, 1, GL_FALSE, value.data);
+            static void uniform<Mat4>(int32_t location, const Mat4* values, size_t count) {
+                glUniformMatrix4fv(location, static_cast<GLsizei>(count), GL_FALSE, values->data);
             }
 
             static uint32_t compile(const Path& shaderPath, ShaderType shaderType) {
@@ -624,6 +912,16 @@ namespace Byte {
 
         struct Texture {
             static void build(TextureData& data) {
+                if (data.type == TextureType::TEXTURE_ARRAY) {
+                    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                    data.id = buildArray(data);
+
+                    State::texture(GL_TEXTURE_2D_ARRAY, data.id);
+                    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+                    State::texture(GL_TEXTURE_2D_ARRAY, 0);
+                    return;
+                }
+
                 TextureID textureID;
 
                 GLint glWidth{ static_cast<GLint>(data.width) };
@@ -631,7 +929,7 @@ namespace Byte {
 
                 glGenTextures(1, &textureID);
 
-                glBindTexture(GL_TEXTURE_2D, textureID);
+                State::texture(GL_TEXTURE_2D, textureID);
 
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, TypeCast::convert(data.wrapS));
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, TypeCast::convert(data.wrapT));
@@ -650,7 +948,7 @@ namespace Byte {
 
                 glGenerateMipmap(GL_TEXTURE_2D);
 
-                glBindTexture(GL_TEXTURE_2D, 0);
+                State::texture(GL_TEXTURE_2D, 0);
 
                 data.id = textureID;
             }
@@ -664,7 +962,7 @@ namespace Byte {
 
                 glGenTextures(1, &textureID);
 
-                glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+                State::texture(GL_TEXTURE_2D_ARRAY, textureID);
 
                 glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, TypeCast::convert(data.wrapS));
                 glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, TypeCast::convert(data.wrapT));
@@ -680,7 +978,7 @@ namespace Byte {
                     TypeCast::convert(data.format),
                     TypeCast::convert(data.dataType), textureData);
 
-                glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+                State::texture(GL_TEXTURE_2D_ARRAY, 0);
 
                 return textureID;
             }
@@ -689,16 +987,353 @@ namespace Byte {
                 TextureID textureID, 
                 TextureUnit unit = TextureUnit::T0,
                 TextureType type = TextureType::TEXTURE_2D) {
-                glActiveTexture(TypeCast::convert(unit));
-                glBindTexture(TypeCast::convert(type), textureID);
+                State::texture(static_cast<uint32_t>(unit), TypeCast::convert(type), textureID);
             }
 
             static void unbind() {
-                glBindTexture(GL_TEXTURE_2D, 0);
+                State::texture(GL_TEXTURE_2D, 0);
             }
 
             static void release(TextureID textureID) {
                 glDeleteTextures(1, &textureID);
+                State::forgetTexture(textureID);
+            }
+        };
+
+        struct UniformBuffer {
+            static uint32_t build(size_t size) {
+                uint32_t id;
+                glGenBuffers(1, &id);
+
+                glBindBuffer(GL_UNIFORM_BUFFER, id);
+                glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+                glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+                return id;
+            }
+
+            static void upload(uint32_t id, const void* data, size_t size) {
+                glBindBuffer(GL_UNIFORM_BUFFER, id);
+                glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW);
+                glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            }
+
+            static void bind(uint32_t id, uint32_t binding) {
+                glBindBufferBase(GL_UNIFORM_BUFFER, binding, id);
+            }
+
+            static void release(uint32_t id) {
+                glDeleteBuffers(1, &id);
+            }
+        };
+
+        // Buffer of RGBA32F texels read in shaders through a samplerBuffer.
+        struct TextureBuffer {
+            static void build(uint32_t& buffer, TextureID& texture, size_t size) {
+                glGenBuffers(1, &buffer);
+                glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+                glBufferData(GL_TEXTURE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+                glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+                glGenTextures(1, &texture);
+                State::texture(GL_TEXTURE_BUFFER, texture);
+                glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+                State::texture(GL_TEXTURE_BUFFER, 0);
+            }
+
+            static void upload(uint32_t buffer, const void* data, size_t offset, size_t size) {
+                glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+                glBufferSubData(GL_TEXTURE_BUFFER, offset, size, data);
+                glBindBuffer(GL_TEXTURE_BUFFER, 0);
+            }
+
+            static void release(uint32_t buffer, TextureID texture) {
+                Texture::release(texture);
+                glDeleteBuffers(1, &buffer);
+            }
+        };
+
+        struct Query {
+            static void build(Buffer<QueryID>& ids) {
+                glGenQueries(static_cast<GLsizei>(ids.size()), ids.data());
+            }
+
+            static void release(Buffer<QueryID>& ids) {
+                if (!ids.empty()) {
+                    glDeleteQueries(static_cast<GLsizei>(ids.size()), ids.data());
+                }
+            }
+
+            static void timestamp(QueryID id) {
+                glQueryCounter(id, GL_TIMESTAMP);
+            }
+
+            static bool available(QueryID id) {
+                GLint available{ GL_FALSE };
+                glGetQueryObjectiv(id, GL_QUERY_RESULT_AVAILABLE, &available);
+                return available == GL_TRUE;
+            }
+
+            static uint64_t result(QueryID id) {
+                GLuint64 value{};
+                glGetQueryObjectui64v(id, GL_QUERY_RESULT, &value);
+                return static_cast<uint64_t>(value);
+            }
+
+            static uint64_t time() {
+                GLint64 value{};
+                glGetInteger64v(GL_TIMESTAMP, &value);
+                return static_cast<uint64_t>(value);
+            }
+        };
+
+        struct State {
+            struct Counters {
+                size_t issued{};
+                size_t filtered{};
+            };
+
+            static constexpr size_t unitCount{ 16 };
+            static constexpr uint32_t unknown{ ~0u };
+
+        private:
+            enum Capability : uint8_t {
+                DEPTH_TEST,
+                BLEND,
+                CULL_FACE,
+                CAPABILITY_COUNT
+            };
+
+            inline static uint32_t _program{ unknown };
+            inline static uint32_t _renderArray{ unknown };
+            inline static uint32_t _readFramebuffer{ unknown };
+            inline static uint32_t _drawFramebuffer{ unknown };
+
+            inline static uint32_t _unit{ unknown };
+            inline static uint32_t _textures[unitCount][3]{};
+
+            inline static int8_t _capabilities[CAPABILITY_COUNT]{ -1, -1, -1 };
+            inline static int8_t _depthMask{ -1 };
+            inline static GLenum _cullFace{ unknown };
+            inline static GLenum _blendEquation{ unknown };
+            inline static std::array<GLenum, 2> _blendFunction{ unknown, unknown };
+            inline static std::array<float, 4> _blendColor{ -1.0f, -1.0f, -1.0f, -1.0f };
+            inline static std::array<GLint, 4> _viewport{ -1, -1, -1, -1 };
+
+            inline static Counters _counters{ 0, 0 };
+
+        public:
+            static void program(uint32_t id) {
+                if (changed(_program, id)) {
+                    glUseProgram(id);
+                }
+            }
+
+            static void renderArray(uint32_t id) {
+                if (changed(_renderArray, id)) {
+                    glBindVertexArray(id);
+                }
+            }
+
+            static void framebuffer(uint32_t id) {
+                if (_readFramebuffer == id && _drawFramebuffer == id) {
+                    ++_counters.filtered;
+                    return;
+                }
+
+                ++_counters.issued;
+                _readFramebuffer = id;
+                _drawFramebuffer = id;
+                glBindFramebuffer(GL_FRAMEBUFFER, id);
+            }
+
+            static void framebuffer(uint32_t read, uint32_t draw) {
+                if (changed(_readFramebuffer, read)) {
+                    glBindFramebuffer(GL_READ_FRAMEBUFFER, read);
+                }
+
+                if (changed(_drawFramebuffer, draw)) {
+                    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw);
+                }
+            }
+
+            static void unit(uint32_t index) {
+                if (changed(_unit, index)) {
+                    glActiveTexture(GL_TEXTURE0 + index);
+                }
+            }
+
+            static void texture(uint32_t index, GLenum target, uint32_t id) {
+                unit(index);
+                texture(target, id);
+            }
+
+            static void texture(GLenum target, uint32_t id) {
+                int slot{ targetSlot(target) };
+
+                if (slot < 0 || _unit >= unitCount) {
+                    ++_counters.issued;
+                    glBindTexture(target, id);
+                    return;
+                }
+
+                if (changed(_textures[_unit][slot], id)) {
+                    glBindTexture(target, id);
+                }
+            }
+
+            static void depthTest(bool enabled) {
+                capability(DEPTH_TEST, GL_DEPTH_TEST, enabled);
+            }
+
+            static void blend(bool enabled) {
+                capability(BLEND, GL_BLEND, enabled);
+            }
+
+            static void culling(bool enabled) {
+                capability(CULL_FACE, GL_CULL_FACE, enabled);
+            }
+
+            static void depthMask(bool enabled) {
+                if (changed(_depthMask, static_cast<int8_t>(enabled))) {
+                    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+                }
+            }
+
+            static void cullFace(GLenum face) {
+                if (changed(_cullFace, face)) {
+                    glCullFace(face);
+                }
+            }
+
+            static void blendFunction(GLenum source, GLenum destination) {
+                if (changed(_blendFunction, std::array<GLenum, 2>{ source, destination })) {
+                    glBlendFunc(source, destination);
+                }
+            }
+
+            static void blendEquation(GLenum equation) {
+                if (changed(_blendEquation, equation)) {
+                    glBlendEquation(equation);
+                }
+            }
+
+            static void blendColor(float r, float g, float b, float a) {
+                if (changed(_blendColor, std::array<float, 4>{ r, g, b, a })) {
+                    glBlendColor(r, g, b, a);
+                }
+            }
+
+            static void viewport(GLint x, GLint y, GLint width, GLint height) {
+                if (changed(_viewport, std::array<GLint, 4>{ x, y, width, height })) {
+                    glViewport(x, y, width, height);
+                }
+            }
+
+            // Deleting a bound object rebinds zero, and the id may be handed out again.
+            static void forgetProgram(uint32_t id) {
+                if (_program == id) {
+                    _program = unknown;
+                }
+            }
+
+            static void forgetRenderArray(uint32_t id) {
+                if (_renderArray == id) {
+                    _renderArray = 0;
+                }
+            }
+
+            static void forgetFramebuffer(uint32_t id) {
+                if (_readFramebuffer == id) {
+                    _readFramebuffer = 0;
+                }
+
+                if (_drawFramebuffer == id) {
+                    _drawFramebuffer = 0;
+                }
+            }
+
+            static void forgetTexture(uint32_t id) {
+                for (auto& unit : _textures) {
+                    for (auto& texture : unit) {
+                        if (texture == id) {
+                            texture = 0;
+                        }
+                    }
+                }
+            }
+
+            // Call after anything outside RenderAPI touches GL state.
+            static void invalidate() {
+                _program = unknown;
+                _renderArray = unknown;
+                _readFramebuffer = unknown;
+                _drawFramebuffer = unknown;
+
+                _unit = unknown;
+                for (auto& unit : _textures) {
+                    std::fill(std::begin(unit), std::end(unit), unknown);
+                }
+
+                std::fill(std::begin(_capabilities), std::end(_capabilities), int8_t{ -1 });
+                _depthMask = -1;
+                _cullFace = unknown;
+                _blendEquation = unknown;
+                _blendFunction = { unknown, unknown };
+                _blendColor = { -1.0f, -1.0f, -1.0f, -1.0f };
+                _viewport = { -1, -1, -1, -1 };
+            }
+
+            static const Counters& counters() {
+                return _counters;
+            }
+
+            static void resetCounters() {
+                _counters = Counters{};
+            }
+
+            static void skip() {
+                ++_counters.filtered;
+            }
+
+        private:
+            template<typename Type>
+            static bool changed(Type& cached, const Type& value) {
+                if (cached == value) {
+                    ++_counters.filtered;
+                    return false;
+                }
+
+                ++_counters.issued;
+                cached = value;
+
+                return true;
+            }
+
+            static void capability(Capability index, GLenum cap, bool enabled) {
+                if (!changed(_capabilities[index], static_cast<int8_t>(enabled))) {
+                    return;
+                }
+
+                if (enabled) {
+                    glEnable(cap);
+                }
+                else {
+                    glDisable(cap);
+                }
+            }
+
+            static int targetSlot(GLenum target) {
+                switch (target) {
+                case GL_TEXTURE_2D:
+                    return 0;
+                case GL_TEXTURE_2D_ARRAY:
+                    return 1;
+                case GL_TEXTURE_BUFFER:
+                    return 2;
+                default:
+                    return -1;
+                }
             }
         };
 
@@ -707,6 +1342,14 @@ namespace Byte {
                 return static_cast<GLenum>(type);
             }
 
+            static GLenum convert(IndexType type) {
+                return static_cast<GLenum>(type);
+            }
+
+            static size_t size(IndexType type) {
+                return type == IndexType::UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+            }
+
             static GLenum convert(TextureUnit unit) {
                 return static_cast<GLenum>(unit) + GL_TEXTURE0;
             }
@@ -738,6 +1381,44 @@ namespace Byte {
             static GLenum convert(TextureWrap type) {
                 return static_cast<GLenum>(type);
             }
+
+            static size_t size(GLenum type) {
+                switch (type) {
+                case GL_FLOAT_VEC2:
+                case GL_INT_VEC2:
+                case GL_UNSIGNED_INT_VEC2:
+                case GL_BOOL_VEC2:
+                    return 8;
+                case GL_FLOAT_VEC3:
+                case GL_INT_VEC3:
+                case GL_UNSIGNED_INT_VEC3:
+                case GL_BOOL_VEC3:
+                    return 12;
+                case GL_FLOAT_VEC4:
+                case GL_INT_VEC4:
+                case GL_UNSIGNED_INT_VEC4:
+                case GL_BOOL_VEC4:
+                case GL_FLOAT_MAT2:
+                    return 16;
+                case GL_FLOAT_MAT3:
+                    return 36;
+                case GL_FLOAT_MAT4:
+                    return 64;
+                case GL_DOUBLE:
+                case GL_DOUBLE_VEC2:
+                case GL_DOUBLE_VEC3:
+                case GL_DOUBLE_VEC4:
+                case GL_FLOAT_MAT2x3:
+                case GL_FLOAT_MAT2x4:
+                case GL_FLOAT_MAT3x2:
+                case GL_FLOAT_MAT3x4:
+                case GL_FLOAT_MAT4x2:
+                case GL_FLOAT_MAT4x3:
+                    return 0;
+                default:
+                    return 4;
+                }
+            }
         };
 
 	};
@@ -8,9 +8,70 @@
 #include "render_type.h"
 #include "shader.h"
 #include "framebuffer.h"
+#include "mesh_renderer.h"
+#include "uniform_buffer.h"
+#include "material_buffer.h"
+#include "mesh_arena.h"
+#include "texture_array.h"
 
 namespace Byte {
 
+	// Points into map node storage, so it stays valid until the entry is erased.
+	template<typename Type>
+	class Handle {
+	private:
+		Type* _value{ nullptr };
+
+	public:
+		Handle() = default;
+
+		Handle(Type& value)
+			:_value{ &value } {
+		}
+
+		Type& operator*() const {
+			return *_value;
+		}
+
+		Type* operator->() const {
+			return _value;
+		}
+
+		Type* get() const {
+			return _value;
+		}
+
+		explicit operator bool() const {
+			return _value != nullptr;
+		}
+	};
+
+	// Looks the texture up on every access, since clearing a framebuffer drops its texture entries.
+	class Attachment {
+	private:
+		Framebuffer* _framebuffer{ nullptr };
+		TextureTag _tag;
+
+	public:
+		Attachment() = default;
+
+		Attachment(Framebuffer& framebuffer, const TextureTag& tag)
+			:_framebuffer{ &framebuffer }, _tag{ tag } {
+		}
+
+		TextureData& operator*() const {
+			return _framebuffer->texture(_tag);
+		}
+
+		TextureData* operator->() const {
+			return &_framebuffer->texture(_tag);
+		}
+
+		explicit operator bool() const {
+			return _framebuffer != nullptr;
+		}
+	};
+
 	struct RenderData {
 		size_t height{ 0 };
 		size_t width{ 0 };
@@ -33,10 +94,50 @@ namespace Byte {
 		using MeshMap = std::unordered_map<MeshTag, RenderMesh>;
 		MeshMap meshes;
 
+		UniformBuffer<FrameBlock> frameBlock;
+		UniformBuffer<ViewBlock> viewBlock;
+		UniformBuffer<LightBlock> lightBlock;
+
+		MaterialBuffer materials;
+		MeshArena arena;
+		TextureArray textureArrays;
+
+		// Arena slices of the ranges of ranged meshes that passed culling, merged where adjacent.
+		// Entities missing here draw their whole slice.
+		using RangeMap = std::unordered_map<RenderID, Buffer<MeshArena::Slice>>;
+		RangeMap visibleRanges;
+
 		template<typename Type>
 		Type& parameter(const std::string& tag) {
 			return std::get<Type>(parameters.at(tag));
 		}
+
+		template<typename Type>
+		Handle<Type> declare(const ParameterTag& tag, const Type& value) {
+			auto result{ parameters.emplace(tag, value).first };
+			return std::get<Type>(result->second);
+		}
+
+		template<typename Type>
+		Handle<Type> resolve(const ParameterTag& tag) {
+			return parameter<Type>(tag);
+		}
+
+		Handle<Framebuffer> framebuffer(const FramebufferTag& tag) {
+			return frameBuffers.at(tag);
+		}
+
+		Attachment attachment(const FramebufferTag& framebuffer, const TextureTag& texture) {
+			return Attachment{ frameBuffers.at(framebuffer), texture };
+		}
+
+		Handle<Shader> shader(const ShaderTag& tag) {
+			return shaders.at(tag);
+		}
+
+		Handle<RenderMesh> mesh(const MeshTag& tag) {
+			return meshes.at(tag);
+		}
 	};
 
-}
\ No newline at end of file
+}
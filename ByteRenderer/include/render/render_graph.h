@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "render_type.h"
+#include "render_data.h"
+#include "framebuffer.h"
+
+namespace Byte {
+
+	class RenderPass;
+
+	using ResourceTag = std::string;
+
+	enum class LoadOperation : uint8_t {
+		LOAD,
+		CLEAR,
+		DONT_CARE,
+	};
+
+	class RenderGraph {
+	public:
+		struct Write {
+			ResourceTag tag;
+			LoadOperation load{ LoadOperation::LOAD };
+		};
+
+		struct Node {
+			RenderPass* pass{};
+			size_t index{};
+
+			Buffer<ResourceTag> reads;
+			Buffer<Write> writes;
+
+			bool output{ false };
+
+			Node(RenderPass* pass, size_t index)
+				: pass{ pass }, index{ index } {
+			}
+		};
+
+		using CountMap = std::unordered_map<ParameterTag, uint32_t>;
+
+		class Builder {
+		private:
+			Node& _node;
+			CountMap& _counts;
+			RenderData& _data;
+
+		public:
+			Builder(Node& node, CountMap& counts, RenderData& data)
+				:_node{ node }, _counts{ counts }, _data{ data } {
+			}
+
+			// Reads a parameter that decides which resources the pass declares.
+			// The graph is rebuilt when it changes.
+			uint32_t count(const ParameterTag& tag) {
+				uint32_t value{ _data.parameter<uint32_t>(tag) };
+				_counts.insert_or_assign(tag, value);
+				return value;
+			}
+
+			void read(const ResourceTag& tag) {
+				_node.reads.push_back(tag);
+			}
+
+			void write(const ResourceTag& tag, LoadOperation load = LoadOperation::LOAD) {
+				_node.writes.push_back(Write{ tag, load });
+			}
+
+			void output() {
+				_node.output = true;
+			}
+		};
+
+		struct Step {
+			RenderPass* pass{};
+			size_t index{};
+			Buffer<Framebuffer*> clears;
+
+			Step(RenderPass* pass, size_t index)
+				: pass{ pass }, index{ index } {
+			}
+		};
+
+		struct Lifetime {
+			size_t first{};
+			size_t last{};
+		};
+
+	private:
+		using URenderPass = std::unique_ptr<RenderPass>;
+		using Pipeline = std::vector<URenderPass>;
+
+		Buffer<Node> _nodes;
+		Buffer<Step> _steps;
+
+		Buffer<bool> _enabled;
+		bool _dirty{ true };
+
+		CountMap _counts;
+
+		using AliasMap = std::unordered_map<FramebufferTag, FramebufferTag>;
+		AliasMap _aliases;
+
+		using LifetimeMap = std::unordered_map<ResourceTag, Lifetime>;
+		LifetimeMap _lifetimes;
+
+		size_t _culledCount{};
+		size_t _mergedClearCount{};
+
+	public:
+		RenderGraph() = default;
+
+		void build(Pipeline& pipeline, RenderData& data);
+
+		void compile(RenderData& data);
+
+		void prepare(const Step& step) const;
+
+		void alias(RenderData& data) const;
+
+		void invalidate() {
+			_dirty = true;
+		}
+
+		bool stale(RenderData& data) const {
+			return std::any_of(_counts.begin(), _counts.end(), [&data](const auto& pair) {
+				return data.parameter<uint32_t>(pair.first) != pair.second;
+			});
+		}
+
+		const Buffer<Step>& steps() const {
+			return _steps;
+		}
+
+		const Buffer<Node>& nodes() const {
+			return _nodes;
+		}
+
+		const AliasMap& aliases() const {
+			return _aliases;
+		}
+
+		bool aliased(const FramebufferTag& tag) const {
+			return _aliases.find(tag) != _aliases.end();
+		}
+
+		const LifetimeMap& lifetimes() const {
+			return _lifetimes;
+		}
+
+		size_t culledCount() const {
+			return _culledCount;
+		}
+
+		size_t mergedClearCount() const {
+			return _mergedClearCount;
+		}
+
+	private:
+		bool updateEnabled(RenderData& data);
+
+		Buffer<size_t> sort(const Buffer<Node>& nodes) const;
+
+		Buffer<bool> cull(const Buffer<Node>& nodes, const Buffer<size_t>& order) const;
+
+		void assignAliases(RenderData& data);
+
+		static bool compatible(const FramebufferData& left, const FramebufferData& right);
+	};
+
+}
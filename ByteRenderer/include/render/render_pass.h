@@ -1,5 +1,10 @@
 #pragma once
 
+#include <string_view>
+#include <map>
+
+#include "core/bounds.h"
+#include "core/profiler.h"
 #include "math/quaternion.h"
 #include "math/vec.h"
 #include "math/trigonometry.h"
@@ -7,6 +12,9 @@
 #include "context.h"
 #include "render_api.h"
 #include "render_data.h"
+#include "render_graph.h"
+#include "command_list.h"
+#include "draw_buffer.h"
 #include "texture.h"
 
 namespace Byte {
@@ -14,11 +22,57 @@ namespace Byte {
 	public:
 		virtual ~RenderPass() = default;
 
+		virtual void setup(RenderGraph::Builder& builder, RenderData& data) {
+		}
+
+		virtual bool enabled(RenderData& data) {
+			return true;
+		}
+
 		virtual void render(RenderContext& context, RenderData& data) = 0;
+
+		virtual std::string_view name() const {
+			return "RenderPass";
+		}
+	};
+
+	struct ShadowCascade {
+		Handle<float> divisor;
+		Handle<Mat4> lightSpace;
+		Handle<Framebuffer> depthBuffer;
+		Attachment depth;
+
+		static Buffer<ShadowCascade> resolve(RenderGraph::Builder& builder, RenderData& data);
+	};
+
+	class UniformPass : public RenderPass {
+	private:
+		Handle<float> _gamma;
+		Handle<float> _fogNear;
+		Handle<float> _fogFar;
+		Handle<Vec3> _fogColor;
+
+		Buffer<ShadowCascade> _cascades;
+
+		CommandList _commands;
+		CommandRecorder _recorder;
+		Buffer<const RenderContext::RenderEntity*> _entities;
+
+	public:
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
+		void render(RenderContext& context, RenderData& data) override;
+
+		std::string_view name() const override {
+			return "UniformPass";
+		}
 	};
 
 	class FrustumCullingPass : public RenderPass {
 	private:
+		Handle<float> _lodThreshold;
+		Handle<float> _lodHysteresis;
+
 		struct Plane {
 			Vec3 normal;
 			float distance{ 0 };
@@ -29,30 +83,92 @@ namespace Byte {
 		};
 
 	public:
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
 		void render(RenderContext& context, RenderData& data) override;
 
+		std::string_view name() const override {
+			return "FrustumCullingPass";
+		}
+
 	private:
 		Frustum createFrustum(const Camera& camera, const Transform& transform, float aspectRatio) const;
 
-		bool inside(const Frustum& frustum, const Transform& transform, float radius) const;
+		bool inside(const Frustum& frustum, const Transform& transform, const MeshBounds& bounds) const;
+
+		bool inside(const Frustum& frustum, const BoundingBox& box) const;
+
+		size_t selectLod(const Mesh& mesh, const Transform& transform, const Camera& camera, const Transform& eye, float height, size_t current) const;
+
+		bool inside(const Frustum& frustum, const Vec3& center, float radius) const;
+
+		void cullRanges(const Frustum& frustum, RenderID id, RenderContext::RenderEntity& entity, RenderData& data) const;
 
 	};
 
 	class SkyboxPass : public RenderPass {
+	private:
+		Handle<bool> _renderSkybox;
+		Handle<Framebuffer> _gBuffer;
+		Handle<Shader> _shader;
+		Handle<RenderData::RenderMesh> _quad;
+
 	public:
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
+		bool enabled(RenderData& data) override;
+
 		void render(RenderContext& context, RenderData& data) override;
+
+		std::string_view name() const override {
+			return "SkyboxPass";
+		}
 	};
 
 	class ShadowPass : public RenderPass {
+	private:
+		Handle<bool> _renderShadow;
+		Handle<uint32_t> _drawFrame;
+		Handle<uint32_t> _currentDrawFrame;
+		Handle<float> _lodThreshold;
+		Handle<float> _lodHysteresis;
+
+		Handle<Shader> _depthShader;
+		Handle<Shader> _instancedDepthShader;
+		Handle<Shader> _indirectDepthShader;
+
+		Buffer<ShadowCascade> _cascades;
+
+		CommandList _commands;
+		CommandRecorder _recorder;
+		Buffer<const RenderContext::RenderEntity*> _entities;
+
+		DrawBuffer _draws;
+		Buffer<IndirectCommand> _indirect;
+
 	public:
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
+		bool enabled(RenderData& data) override;
+
 		void render(RenderContext& context, RenderData& data) override;
 
+		std::string_view name() const override {
+			return "ShadowPass";
+		}
+
 	private:
-		void renderEntities(RenderContext& context, const Shader& shader) const;
+		void recordEntities(
+			RenderContext& context,
+			RenderData& data,
+			const Shader& shader,
+			const Shader& indirectShader);
+
+		bool casts(const Transform& transform, const MeshBounds& bounds, float& texelsPerUnit) const;
 
-		void renderInstances(RenderContext& context) const;
+		void recordInstances(RenderContext& context, const Shader& shader);
 
-		void updateLightMatrices(float aspectRatio, RenderData& data, RenderContext& context);
+		void updateLightMatrices(float aspectRatio, RenderContext& context);
 
 		Mat4 frustumSpace(
 			const Mat4& projection,
@@ -64,27 +180,60 @@ namespace Byte {
 
 	class GeometryPass : public RenderPass {
 	protected:
-		void renderEntities(
+		// Indirect draws that share the same material textures.
+		struct Batch {
+			const MaterialRecord* record{};
+			Buffer<IndirectCommand> commands;
+		};
+
+		using BatchKey = std::pair<const Texture*, const Texture*>;
+
+		CommandList _commands;
+		CommandRecorder _recorder;
+		Buffer<const RenderContext::RenderEntity*> _entities;
+
+		DrawBuffer _draws;
+		Buffer<Batch> _batches;
+		std::map<BatchKey, size_t> _batchIndex;
+
+		// With an indirect shader, static arena meshes using the default shader are drawn
+		// through it in a few indirect calls instead of one draw per entity. Entities that
+		// share arena geometry and material textures are instanced by a single command.
+		void recordEntities(
 			RenderContext& context,
 			RenderData& data,
-			const Mat4& projection,
-			const Mat4& view,
-			const ShaderTag& defaultTag,
-			TransparencyMode mode) const;
+			Shader& defaultShader,
+			TransparencyMode mode,
+			Shader* indirectShader = nullptr);
 
-		void renderInstances(
+		void recordInstances(
 			RenderContext& context,
 			RenderData& data,
-			const Mat4& projection,
-			const Mat4& view,
-			const ShaderTag& defaultTag,
-			TransparencyMode mode) const;
+			Shader& defaultShader,
+			TransparencyMode mode);
+
+	private:
+		void recordBatches(RenderContext& context, RenderData& data, Shader& indirectShader);
+
+		uint32_t batch(const MaterialRecord& record);
 
 	};
 
 	class OpaquePass : public GeometryPass {
+	private:
+		Handle<Framebuffer> _gBuffer;
+		Handle<Shader> _shader;
+		Handle<Shader> _instancedShader;
+		Handle<Shader> _indirectShader;
+
 	public:
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
 		void render(RenderContext& context, RenderData& data) override;
+
+		std::string_view name() const override {
+			return "OpaquePass";
+		}
 	};
 
 	class SSAOPass : public RenderPass {
@@ -99,38 +248,139 @@ namespace Byte {
 				TextureWrap::REPEAT, TextureWrap::REPEAT,
 			}};
 
+		Handle<bool> _renderSSAO;
+
+		Handle<Shader> _ssaoShader;
+		Handle<Shader> _blurShader;
+
+		Handle<Framebuffer> _ssaoBuffer;
+		Handle<Framebuffer> _blurBuffer;
+
+		Attachment _normal;
+		Attachment _depth;
+		Attachment _ssao;
+
+		Handle<RenderData::RenderMesh> _quad;
+
 	public:
 		SSAOPass();
 
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
+		bool enabled(RenderData& data) override;
+
 		void render(RenderContext& context, RenderData& data) override;
+
+		std::string_view name() const override {
+			return "SSAOPass";
+		}
 	};
 
 	class LightingPass : public RenderPass {
+	private:
+		Handle<bool> _renderSSAO;
+
+		Handle<Shader> _lightingShader;
+		Handle<Shader> _pointLightShader;
+
+		Handle<Framebuffer> _colorBuffer;
+
+		Attachment _normal;
+		Attachment _albedo;
+		Attachment _material;
+		Attachment _depth;
+		Attachment _ssao;
+
+		Handle<RenderData::RenderMesh> _quad;
+		Handle<RenderData::RenderMesh> _sphere;
+
+		Buffer<ShadowCascade> _cascades;
+		Buffer<int> _depthUnits;
+
 	public:
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
 		void render(RenderContext& context, RenderData& data) override;
 
+		std::string_view name() const override {
+			return "LightingPass";
+		}
+
 	private:
 		void setupGBufferTextures(Shader& shader);
 
-		void setupCascades(RenderData& data, Shader& shader, Camera& camera);
-
-		void bindCommon(Shader& shader, Mat4& view, Mat4& iView, Mat4& iProjection, Vec3& viewPos);
+		void setupCascades(Shader& shader);
 
 	};
 
 	class TransparentPass : public GeometryPass {
+	private:
+		Handle<Framebuffer> _gBuffer;
+		Handle<Framebuffer> _colorBuffer;
+		Handle<Shader> _shader;
+		Handle<Shader> _instancedShader;
+
 	public:
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
 		void render(RenderContext& context, RenderData& data) override;
+
+		std::string_view name() const override {
+			return "TransparentPass";
+		}
 	};
 
 	class BloomPass : public RenderPass {
+	private:
+		struct Target {
+			Handle<Framebuffer> framebuffer;
+			Attachment color;
+		};
+
+		Handle<bool> _renderBloom;
+		Handle<float> _gamma;
+		Handle<float> _strength;
+
+		Handle<Shader> _downsampleShader;
+		Handle<Shader> _upsampleShader;
+
+		Target _colorBuffer;
+		Buffer<Target> _bloomBuffers;
+
+		Handle<RenderData::RenderMesh> _quad;
+
 	public:
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
+		bool enabled(RenderData& data) override;
+
 		void render(RenderContext& context, RenderData& data) override;
+
+		std::string_view name() const override {
+			return "BloomPass";
+		}
 	};
 
 	class DrawPass : public RenderPass {
+	private:
+		Handle<bool> _renderFXAA;
+
+		Handle<Shader> _fxaaShader;
+		Handle<Shader> _quadShader;
+
+		Attachment _color;
+		Attachment _depth;
+
+		Handle<RenderData::RenderMesh> _quad;
+
 	public:
+		void setup(RenderGraph::Builder& builder, RenderData& data) override;
+
 		void render(RenderContext& context, RenderData& data) override;
+
+		std::string_view name() const override {
+			return "DrawPass";
+		}
 	};
 
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <memory>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <exception>
 #include <variant>
 #include <random>
@@ -40,6 +41,7 @@ namespace Byte {
 
 	using RenderArrayID = uint32_t;
 	using RenderBufferID = uint32_t;
+	using QueryID = uint32_t;
 
 	enum class PrimitiveType : uint32_t {
 		POINTS = 0x0000,
@@ -51,6 +53,11 @@ namespace Byte {
 		PATCHES = 0x000E             
 	};
 
+	enum class IndexType : uint32_t {
+		UINT16 = 0x1403,
+		UINT32 = 0x1405
+	};
+
 	enum class TextureUnit: uint8_t {
 		T0, T1, T2, T3,
 		T4, T5, T6, T7,
@@ -61,6 +68,7 @@ namespace Byte {
 	enum class TextureType : uint32_t {
 		TEXTURE_2D = 0x0DE1,
 		TEXTURE_ARRAY = 0x8C1A,
+		TEXTURE_BUFFER = 0x8C2A,
 	};
 
 	enum class ShaderType : uint32_t {
@@ -165,6 +173,8 @@ namespace Byte {
 
 		bool resize{ true };
 		float resizeFactor{ 1.0f };
+
+		bool transient{ false };
 	};
 
 	struct VertexAttribute {
@@ -192,6 +202,16 @@ namespace Byte {
 
 		RenderBufferID EBO{ 0 };
 		size_t elementCount{ 0 };
+		IndexType indexType{ IndexType::UINT32 };
+	};
+
+	// Matches the layout glMultiDrawElementsIndirect reads from the indirect buffer.
+	struct IndirectCommand {
+		uint32_t count{};
+		uint32_t instanceCount{};
+		uint32_t firstIndex{};
+		int32_t baseVertex{};
+		uint32_t baseInstance{};
 	};
 
 	enum class UniformType: uint16_t {
@@ -214,6 +234,52 @@ namespace Byte {
 		UniformType type;
 	};
 
+	struct UniformKey {
+		uint64_t hash{};
+
+		constexpr UniformKey() = default;
+
+		constexpr UniformKey(std::string_view name)
+			:hash{ compute(name) } {
+		}
+
+		constexpr UniformKey(const char* name)
+			:UniformKey{ std::string_view{ name } } {
+		}
+
+		UniformKey(const std::string& name)
+			:UniformKey{ std::string_view{ name } } {
+		}
+
+		static constexpr uint64_t compute(std::string_view name) {
+			uint64_t value{ 14695981039346656037ULL };
+			for (char c : name) {
+				value ^= static_cast<uint8_t>(c);
+				value *= 1099511628211ULL;
+			}
+
+			return value;
+		}
+
+		constexpr bool operator==(const UniformKey& right) const {
+			return hash == right.hash;
+		}
+	};
+
+	struct UniformData {
+		std::string name;
+		int32_t location{ -1 };
+		size_t count{};
+		size_t size{};
+	};
+
+	struct AttributeData {
+		std::string name;
+		int32_t location{ -1 };
+		uint8_t components{};
+		bool integer{ false };
+	};
+
 	template<typename Type>
 	struct ShaderInput {
 		Type value;
@@ -247,4 +313,28 @@ namespace Byte {
 		DISABLED,
 	};
 
+	enum class RenderBackend : uint8_t {
+		OPENGL,
+		NULL_DEVICE,
+		RECORDING,
+	};
+
+	struct Shader;
+	class Texture;
+
+	// What a draw needs from a material, resolved when the material changes. Parameters live
+	// in the material buffer at index; the shader is the material's geometry shader, if any.
+	struct MaterialRecord {
+		const Shader* shader{};
+		const Texture* albedo{};
+		const Texture* surface{};
+		TextureUnit albedoUnit{ TextureUnit::T0 };
+		TextureUnit surfaceUnit{ TextureUnit::T1 };
+		Buffer<const Texture*> bindings;
+
+		uint32_t index{};
+		uint64_t revision{};
+		uint64_t frame{};
+	};
+
 }
\ No newline at end of file
@@ -5,7 +5,10 @@
 #include <unordered_map>
 
 #include "Core/window.h"
+#include "core/profiler.h"
 #include "render_pass.h"
+#include "render_graph.h"
+#include "gpu_timer.h"
 #include "texture.h"
 
 namespace Byte {
@@ -18,6 +21,9 @@ namespace Byte {
 		RenderContext _context;
 		RenderData _data;
 		Pipeline _pipeline;
+		RenderGraph _graph;
+		GPUTimer _gpuTimer;
+		Framebuffer _target;
 
 	public:
 		Renderer() = default;
@@ -32,10 +38,18 @@ namespace Byte {
 			_data.width = window.width();
 			_data.height = window.height();
 
+			if (window.headless()) {
+				buildTarget();
+			}
+
 			for (auto& pair : _data.frameBuffers) {
 				pair.second.build();
 			}
 
+			_data.frameBlock.build();
+			_data.viewBlock.build();
+			_data.lightBlock.build();
+
 			compileShaders();
 
 			for (auto& [tag,pair] : _data.meshes) {
@@ -43,22 +57,51 @@ namespace Byte {
 			}
 
 			load();
+
+			_graph.build(_pipeline, _data);
+
+			_gpuTimer.clear();
+			for (auto& pass : _pipeline) {
+				_gpuTimer.zone(pass->name());
+			}
 		}
 
 		void load() {
+			BYTE_PROFILE_ZONE("Renderer::load");
+
 			prepareVertexArrays();
+			prepareTextureArrays();
 			prepareTextures();
+			prepareMaterials();
 		}
 
 		void render() {
+			BYTE_PROFILE_ZONE("Renderer::render");
+
 			load();
 
-			for (auto& pass : _pipeline) {
-				pass->render(_context, _data);
+			if (_graph.stale(_data)) {
+				_graph.build(_pipeline, _data);
+			}
+
+			_graph.compile(_data);
+			_gpuTimer.beginFrame();
+
+			for (auto& step : _graph.steps()) {
+				BYTE_PROFILE_ZONE(step.pass->name().data());
+
+				_gpuTimer.begin(step.index);
+
+				_graph.prepare(step);
+				step.pass->render(_context, _data);
+
+				_gpuTimer.end(step.index);
 			}
 		}
 
 		void update(Window& window) {
+			BYTE_PROFILE_ZONE("Renderer::update");
+
 			RenderAPI::update(window);
 
 			if (_data.width != window.width() || _data.height != window.height()) {
@@ -67,10 +110,18 @@ namespace Byte {
 		}
 
 		void resize(size_t width, size_t height) {
+			if (_target.data().id) {
+				RenderAPI::Framebuffer::defaultFramebuffer(0);
+				_target.resize(width, height);
+				RenderAPI::Framebuffer::defaultFramebuffer(_target.data().id);
+			}
+
 			for (auto& pair : _data.frameBuffers) {
 				pair.second.resize(width, height);
 			}
 
+			_graph.alias(_data);
+
 			_data.width = width;
 			_data.height = height;
 		}
@@ -109,6 +160,27 @@ namespace Byte {
 			return _pipeline;
 		}
 
+		RenderGraph& graph() {
+			return _graph;
+		}
+
+		const RenderGraph& graph() const {
+			return _graph;
+		}
+
+		GPUTimer& gpuTimer() {
+			return _gpuTimer;
+		}
+
+		const GPUTimer& gpuTimer() const {
+			return _gpuTimer;
+		}
+
+		// Presented image as RGBA8, bottom row first; from the offscreen target when headless.
+		Buffer<uint8_t> readback() const {
+			return RenderAPI::Framebuffer::read(RenderAPI::Framebuffer::defaultFramebuffer(), _data.width, _data.height);
+		}
+
 		void compileShaders() {
 			for (auto& pair : _data.shaders) {
 				if (!pair.second.id()) {
@@ -126,15 +198,43 @@ namespace Byte {
 		}
 
 	private:
+		void buildTarget() {
+			FramebufferData data;
+			data.width = _data.width;
+			data.height = _data.height;
+			data.textures = {
+				{
+					"color",
+					{
+						AttachmentType::COLOR_0,
+						ColorFormat::RGBA,
+						ColorFormat::RGBA,
+						DataType::UNSIGNED_BYTE
+					}
+				}
+			};
+
+			_target = Framebuffer{ std::move(data) };
+			_target.build();
+
+			RenderAPI::Framebuffer::defaultFramebuffer(_target.data().id);
+		}
+
 		void prepareVertexArrays() {
+			BYTE_PROFILE_ZONE("Renderer::prepareVertexArrays");
+
 			for (auto& pair : _context.renderEntities()) {
 				Mesh& mesh{ *pair.second.mesh };
 				MeshRenderer& meshRenderer{ *pair.second.meshRenderer };
 				if (!meshRenderer.drawable() && !mesh.empty()) {
 					meshRenderer.upload(mesh);
 				}
+
+				_data.arena.add(mesh);
 			}
 
+			_data.arena.upload();
+
 			for (auto& [tag, instance] : _context.instances()) {
 				if (!instance.meshRenderer().drawable() && !instance.mesh().empty()) {
 					instance.meshRenderer().uploadInstanced(instance.mesh(),instance.layout());
@@ -146,9 +246,38 @@ namespace Byte {
 			}
 		}
 
+		// Packs the textures of new materials into shared arrays and moves materials onto their layers.
+		void prepareTextureArrays() {
+			BYTE_PROFILE_ZONE("Renderer::prepareTextureArrays");
+
+			TextureArray& arrays{ _data.textureArrays };
+
+			for (auto& pair : _context.renderEntities()) {
+				arrays.add(*pair.second.material);
+			}
+
+			for (auto& pair : _context.instances()) {
+				arrays.add(pair.second.material());
+			}
+
+			if (arrays.pending()) {
+				arrays.build();
+			}
+
+			for (auto& pair : _context.renderEntities()) {
+				arrays.apply(*pair.second.material);
+			}
+
+			for (auto& pair : _context.instances()) {
+				arrays.apply(pair.second.material());
+			}
+		}
+
 		void prepareTextures() {
+			BYTE_PROFILE_ZONE("Renderer::prepareTextures");
+
 			for (auto& pair : _context.renderEntities()) {
-				Material& material{ *pair.second.material };
+				const Material& material{ *pair.second.material };
 
 				for (auto& [tag, texture]: material.textureMap()) {
 					if (!texture->id()) {
@@ -158,7 +287,7 @@ namespace Byte {
 			}
 
 			for (auto& pair : _context.instances()) {
-				Material& material{ pair.second.material() };
+				const Material& material{ pair.second.material() };
 				for (auto& [tag, texture] : material.textureMap()) {
 					if (!texture->id()) {
 						RenderAPI::Texture::build(texture->data());
@@ -167,6 +296,20 @@ namespace Byte {
 			}
 		}
 
+		void prepareMaterials() {
+			BYTE_PROFILE_ZONE("Renderer::prepareMaterials");
+
+			for (auto& pair : _context.renderEntities()) {
+				_data.materials.update(*pair.second.material, _data.shaders);
+			}
+
+			for (auto& pair : _context.instances()) {
+				_data.materials.update(pair.second.material(), _data.shaders);
+			}
+
+			_data.materials.upload();
+		}
+
 	};
 
 }
\ No newline at end of file
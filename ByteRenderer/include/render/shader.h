@@ -4,10 +4,14 @@
 #include <type_traits>
 #include <variant>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
 
+#include "core/material.h"
 #include "render_type.h"
 #include "render_api.h"
 #include "texture.h"
+#include "uniform_buffer.h"
 
 namespace Byte {
 
@@ -28,9 +32,42 @@ namespace Byte {
         using TextureBindingVector = std::vector<Binding>;
         TextureBindingVector _bindings;
 
+        Buffer<AttributeData> _inputs;
+        Buffer<uint8_t> _vertexLayout;
+        Buffer<VertexType> _vertexTypes;
+
+        struct UniformSlot {
+            UniformKey key;
+            int32_t location{ -1 };
+            size_t count{};
+            size_t size{};
+            size_t offset{};
+            size_t element{};
+        };
+
+        // Sorted by key. Array elements share the value cache of their array.
+        Buffer<UniformSlot> _slots;
+        mutable Buffer<uint8_t> _values;
+        mutable Buffer<uint8_t> _cached;
+
+        template<typename Type>
+        static constexpr bool converted{
+            std::is_same_v<Type, bool> ||
+            std::is_same_v<Type, size_t> ||
+            std::is_same_v<Type, Quaternion> };
+
         friend struct ShaderCompiler;
 
     public:
+        // Sampler units are fixed at link time; 2D and array samplers never share one.
+        static constexpr TextureUnit albedoUnit{ TextureUnit::T0 };
+        static constexpr TextureUnit surfaceUnit{ TextureUnit::T1 };
+        static constexpr TextureUnit albedoArrayUnit{ TextureUnit::T2 };
+        static constexpr TextureUnit surfaceArrayUnit{ TextureUnit::T3 };
+        static constexpr TextureUnit materialUnit{ TextureUnit::T4 };
+        static constexpr TextureUnit drawUnit{ TextureUnit::T5 };
+        static constexpr TextureUnit bindingUnit{ TextureUnit::T6 };
+
         Shader() = default;
 
         Shader(
@@ -44,6 +81,10 @@ namespace Byte {
 
         ~Shader() = default;
 
+        const ShaderPath& path() const {
+            return _path;
+        }
+
         void bind() const {
             RenderAPI::Shader::bind(_id);
         }
@@ -53,76 +94,118 @@ namespace Byte {
         }
 
         template<typename Type>
-        void uniform(const std::string& name, const Type& value) const {
-            RenderAPI::Shader::uniform(_id, name, value);
+        void uniform(UniformKey key, const Type& value) const {
+            if constexpr (converted<Type>) {
+                auto value_{ convert(value) };
+                upload(key, &value_, 1);
+            }
+            else {
+                upload(key, &value, 1);
+            }
         }
 
         template<typename Type>
-        void uniform(const std::string& name, const Buffer<Type>& values) const {
-            for (size_t i{}; i < values.size(); ++i) {
-                RenderAPI::Shader::uniform(_id, name + "[" + std::to_string(i) + "]", values[i]);
+        void uniform(UniformKey key, const Buffer<Type>& values) const {
+            if constexpr (converted<Type>) {
+                Buffer<decltype(convert(std::declval<Type>()))> values_;
+                values_.reserve(values.size());
+
+                for (const auto& value : values) {
+                    values_.push_back(convert(value));
+                }
+
+                upload(key, values_.data(), values_.size());
+            }
+            else {
+                upload(key, values.data(), values.size());
             }
         }
 
         void uniform(const ShaderInputMap& inputs) {
             for (const auto& [tag, input] : inputs) {
                 std::visit([this, &tag](const auto& inputValue) {
-                    RenderAPI::Shader::uniform(_id, tag, inputValue.value);
+                    uniform(tag, inputValue.value);
                 }, input); 
             }
         }
 
-        void uniform(const Material& material) {
-            if (!material.hasTexture("albedo") && !material.hasTexture("material")) {
-                uniform<int>("uDataMode", 0);
-                uniform<float>("uMetallic", material.metallic());
-                uniform<float>("uRoughness", material.roughness());
-                uniform<float>("uAO", material.ambientOcclusion());
-                uniform<float>("uEmission", material.emission());
-            }
+        template<typename Type>
+        void uniform(UniformKey key, const Type* values, size_t count) const {
+            upload(key, values, count);
+        }
 
-            else if (material.hasTexture("albedo") && !material.hasTexture("material")) {
-                uniform<int>("uDataMode", 1);
-                uniform<int>("uAlbedoTexture", 0);
+        void uniform(const MaterialRecord& record) const {
+            Immediate immediate{ *this };
+            material(record, immediate);
+        }
 
-                material.texture("albedo").bind();
-                uniform<float>("uMetallic", material.metallic());
-                uniform<float>("uRoughness", material.roughness());
-                uniform<float>("uAO", material.ambientOcclusion());
-                uniform<float>("uEmission", material.emission());
-            }
+        // Target receives uniform(key, value) and texture(texture, unit) calls. Material parameters
+        // are read from the material buffer, so a draw only selects its record and textures.
+        template<typename Target>
+        void material(const MaterialRecord& record, Target& target) const {
+            target.uniform("uMaterialIndex", static_cast<int>(record.index));
 
-            else if (!material.hasTexture("albedo") && material.hasTexture("material")) {
-                uniform<int>("uDataMode", 2);
-                uniform<int>("uMaterialTexture", 0);
+            if (record.albedo) {
+                target.texture(*record.albedo, record.albedoUnit);
+            }
 
-                material.texture("material").bind();
+            if (record.surface) {
+                target.texture(*record.surface, record.surfaceUnit);
             }
 
-            else {
-                uniform<int>("uDataMode", 3);
-                uniform<int>("uAlbedoTexture", 0);
-                uniform<int>("uMaterialTexture", 1);
+            size_t count{ std::min(record.bindings.size(), _bindings.size()) };
+            size_t index{ static_cast<size_t>(bindingUnit) };
 
-                material.texture("albedo").bind();
-                material.texture("material").bind(TextureUnit::T1);
+            for (size_t i{}; i < count; ++i, ++index) {
+                target.texture(*record.bindings[i], static_cast<TextureUnit>(index));
+                target.uniform(_bindings[i].uniformTag, static_cast<int>(index));
             }
+        }
 
-            uniform<Vec4>("uAlbedo", material.albedo());
+        void binding(TextureTag&& textureTag, UniformTag&& uniformTag) {
+            _bindings.emplace_back(std::forward<TextureTag>(textureTag), std::forward<TextureTag>(uniformTag));
+        }
 
-            size_t index{
-                static_cast<size_t>(material.hasTexture("albedo")) + 
-                static_cast<size_t>(material.hasTexture("material")) };
+        const TextureBindingVector& bindings() const {
+            return _bindings;
+        }
 
-            for (auto& [tag, uniformTag] : _bindings) {
-                material.texture(tag).bind(static_cast<TextureUnit>(index));
-                uniform<int>(uniformTag, static_cast<int>(index));
-                ++index;
+        // Declares the vertex format the shader is drawn with; it is checked against the
+        // shader's inputs when the program links.
+        template<typename Format>
+        void vertexFormat() {
+            vertexFormat(Format::vertexLayout(), Buffer<VertexType>{ Format::types.begin(), Format::types.end() });
+        }
+
+        void vertexFormat(const Buffer<uint8_t>& layout, const Buffer<VertexType>& types) {
+            _vertexLayout = layout;
+            _vertexTypes = types;
+        }
+
+        // Every input the layout covers has to read floats with as many components as are
+        // stored; octahedral normals may also be read as three and decoded by the shader.
+        // Inputs past the layout belong to instance attributes and are not checked.
+        bool accepts(const Buffer<uint8_t>& layout, const Buffer<VertexType>& types) const {
+            for (const AttributeData& input : _inputs) {
+                size_t location{ static_cast<size_t>(input.location) };
+                if (location >= layout.size()) {
+                    continue;
+                }
+
+                VertexType type{ VertexFormat::type(types, location) };
+                uint8_t stored{ type == VertexType::OCTAHEDRAL ? uint8_t{ 2 } : layout[location] };
+
+                bool fits{ input.components == stored || (type == VertexType::OCTAHEDRAL && input.components == 3) };
+                if (input.integer || !fits) {
+                    return false;
+                }
             }
+
+            return true;
         }
 
-        void binding(TextureTag&& textureTag, UniformTag&& uniformTag) {
-            _bindings.emplace_back(std::forward<TextureTag>(textureTag), std::forward<TextureTag>(uniformTag));
+        const Buffer<AttributeData>& inputs() const {
+            return _inputs;
         }
 
         uint32_t id() const {
@@ -144,6 +227,75 @@ namespace Byte {
         bool compiled() const {
             return _id != 0;
         }
+
+        bool active(UniformKey key) const {
+            return find(key) != nullptr;
+        }
+
+    private:
+        struct Immediate {
+            const Shader& shader;
+
+            template<typename Type>
+            void uniform(UniformKey key, const Type& value) {
+                shader.uniform(key, value);
+            }
+
+            void texture(const Texture& texture, TextureUnit unit) {
+                texture.bind(unit);
+            }
+        };
+
+        const UniformSlot* find(UniformKey key) const {
+            auto result{ std::lower_bound(_slots.begin(), _slots.end(), key.hash,
+                [](const UniformSlot& slot, uint64_t hash) {
+                    return slot.key.hash < hash;
+                }) };
+
+            return result != _slots.end() && result->key == key ? &*result : nullptr;
+        }
+
+        template<typename Type>
+        void upload(UniformKey key, const Type* values, size_t count) const {
+            const UniformSlot* slot{ find(key) };
+            if (!slot || !count) {
+                return;
+            }
+
+            count = std::min(count, slot->count);
+            uint8_t* cached{ _cached.data() + slot->element };
+
+            if (sizeof(Type) == slot->size) {
+                size_t bytes{ sizeof(Type) * count };
+                uint8_t* stored{ _values.data() + slot->offset };
+
+                bool known{ std::all_of(cached, cached + count, [](uint8_t flag) {
+                    return flag != 0;
+                }) };
+
+                if (known && !std::memcmp(stored, values, bytes)) {
+                    return;
+                }
+
+                std::memcpy(stored, values, bytes);
+                std::fill(cached, cached + count, uint8_t{ 1 });
+            }
+            else {
+                std::fill(cached, cached + count, uint8_t{ 0 });
+            }
+
+            RenderAPI::Shader::uniform(slot->location, values, count);
+        }
+
+        template<typename Type>
+        static auto convert(const Type& value) {
+            if constexpr (std::is_same_v<Type, Quaternion>) {
+                return Vec4{ value.x, value.y, value.z, value.w };
+            }
+            else {
+                return static_cast<int>(value);
+            }
+        }
     };
 
     struct ShaderCompiler {
@@ -168,6 +320,17 @@ namespace Byte {
             }
 
             shader._id = createProgram(vertexShader, fragmentShader, geometryShader, tessCShader, tessEShader);
+            reflect(shader);
+            samplers(shader);
+
+            shader._inputs = RenderAPI::Program::attributes(shader._id);
+            if (!shader._vertexLayout.empty() && !shader.accepts(shader._vertexLayout, shader._vertexTypes)) {
+                throw std::exception("Vertex format does not match shader inputs");
+            }
+
+            RenderAPI::Program::blockBinding(shader._id, FrameBlock::name, FrameBlock::binding);
+            RenderAPI::Program::blockBinding(shader._id, ViewBlock::name, ViewBlock::binding);
+            RenderAPI::Program::blockBinding(shader._id, LightBlock::name, LightBlock::binding);
 
             RenderAPI::Shader::release(vertexShader);
             RenderAPI::Shader::release(fragmentShader);
@@ -186,6 +349,66 @@ namespace Byte {
             return RenderAPI::Shader::compile(shaderPath, shaderType);
         }
 
+        static void samplers(Shader& shader) {
+            RenderAPI::Shader::bind(shader._id);
+
+            shader.uniform("uAlbedoTexture", static_cast<int>(Shader::albedoUnit));
+            shader.uniform("uMaterialTexture", static_cast<int>(Shader::surfaceUnit));
+            shader.uniform("uAlbedoArray", static_cast<int>(Shader::albedoArrayUnit));
+            shader.uniform("uMaterialArray", static_cast<int>(Shader::surfaceArrayUnit));
+            shader.uniform("uMaterials", static_cast<int>(Shader::materialUnit));
+            shader.uniform("uDraws", static_cast<int>(Shader::drawUnit));
+        }
+
+        static void reflect(Shader& shader) {
+            using Slot = Shader::UniformSlot;
+
+            shader._slots.clear();
+
+            size_t offset{};
+            size_t element{};
+
+            for (const auto& uniform : RenderAPI::Program::uniforms(shader._id)) {
+                std::string name{ uniform.name };
+
+                bool array{ name.size() > 3 && name.ends_with("[0]") };
+                if (array) {
+                    name.resize(name.size() - 3);
+                }
+
+                shader._slots.push_back(Slot{ name, uniform.location, uniform.count, uniform.size, offset, element });
+
+                if (array) {
+                    for (size_t i{}; i < uniform.count; ++i) {
+                        std::string elementName{ name + "[" + std::to_string(i) + "]" };
+                        int32_t location{ i ? RenderAPI::Program::location(shader._id, elementName) : uniform.location };
+
+                        shader._slots.push_back(Slot{
+                            elementName, location, uniform.count - i, uniform.size,
+                            offset + i * uniform.size, element + i });
+                    }
+                }
+
+                offset += uniform.count * uniform.size;
+                element += uniform.count;
+            }
+
+            std::sort(shader._slots.begin(), shader._slots.end(), [](const Slot& left, const Slot& right) {
+                return left.key.hash < right.key.hash;
+            });
+
+            auto collision{ std::adjacent_find(shader._slots.begin(), shader._slots.end(), [](const Slot& left, const Slot& right) {
+                return left.key == right.key;
+            }) };
+
+            if (collision != shader._slots.end()) {
+                throw std::exception("Uniform name hash collision");
+            }
+
+            shader._values.assign(offset, 0);
+            shader._cached.assign(element, 0);
+        }
+
         static uint32_t createProgram(
             uint32_t vertex, 
             uint32_t fragment, 
@@ -67,7 +67,7 @@ namespace Byte {
 		}
 
 		void bind(TextureUnit unit = TextureUnit::T0) const {
-			RenderAPI::Texture::bind(_data.id, unit);
+			RenderAPI::Texture::bind(_data.id, unit, _data.type);
 		}
 
 		void unbind() const {
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <utility>
+
+#include "core/material.h"
+#include "texture.h"
+
+namespace Byte {
+
+	// Packs textures of the same size, format and sampling into the layers of 2D array
+	// textures. Packed materials then differ only by a layer index and share one bind.
+	// Only albedo and material textures are packed, as only the shared fragment shaders
+	// sample arrays; every texture is considered once, every material once per revision.
+	class TextureArray {
+	public:
+		struct Layer {
+			Texture* array{};
+			uint32_t index{};
+		};
+
+	private:
+		using UTexture = std::unique_ptr<Texture>;
+
+		std::vector<UTexture> _arrays;
+		std::unordered_map<const Texture*, Layer> _layers;
+		std::vector<const Texture*> _pending;
+		std::unordered_set<const Texture*> _seen;
+		std::unordered_map<const Material*, uint64_t> _materials;
+
+		size_t _maxLayers{ 256 };
+
+	public:
+		TextureArray() = default;
+
+		TextureArray(size_t maxLayers)
+			:_maxLayers{ std::max<size_t>(maxLayers, 1) } {
+		}
+
+		void add(const Texture& texture) {
+			if (packable(texture) && _seen.insert(&texture).second) {
+				_pending.push_back(&texture);
+			}
+		}
+
+		void add(const Material& material) {
+			if (current(material)) {
+				return;
+			}
+
+			for (const auto& [tag, texture] : material.textureMap()) {
+				if (tag == "albedo" || tag == "material") {
+					add(*texture);
+				}
+			}
+		}
+
+		bool pending() const {
+			return !_pending.empty();
+		}
+
+		// Groups everything added since the last build into new arrays; textures that end up
+		// alone in a group are left as they are.
+		void build() {
+			std::vector<std::vector<const Texture*>> groups;
+
+			for (const Texture* texture : _pending) {
+				auto result{ std::find_if(groups.begin(), groups.end(), [texture](const auto& group) {
+					return compatible(group.front()->data(), texture->data());
+				}) };
+
+				if (result == groups.end()) {
+					groups.push_back({ texture });
+				}
+				else {
+					result->push_back(texture);
+				}
+			}
+
+			_pending.clear();
+
+			for (auto& group : groups) {
+				for (size_t first{}; first < group.size(); first += _maxLayers) {
+					size_t count{ std::min(_maxLayers, group.size() - first) };
+					if (count > 1) {
+						pack(group.data() + first, count);
+					}
+				}
+			}
+		}
+
+		// Moves each packed texture of the material onto its array layer. Only tags that
+		// actually move touch the material, so its revision stays put once applied.
+		void apply(Material& material) {
+			if (current(material)) {
+				return;
+			}
+
+			std::vector<std::pair<TextureTag, Layer>> moves;
+
+			for (const auto& [tag, texture] : std::as_const(material).textureMap()) {
+				auto result{ _layers.find(texture) };
+				if (result != _layers.end() && (tag == "albedo" || tag == "material")) {
+					moves.emplace_back(tag, result->second);
+				}
+			}
+
+			for (const auto& [tag, layer] : moves) {
+				material.texture(tag, *layer.array, layer.index);
+			}
+
+			_materials.insert_or_assign(&material, material.revision());
+		}
+
+		bool current(const Material& material) const {
+			auto result{ _materials.find(&material) };
+			return result != _materials.end() && result->second == material.revision();
+		}
+
+		bool contains(const Texture& texture) const {
+			return _layers.count(&texture);
+		}
+
+		const Layer& layer(const Texture& texture) const {
+			return _layers.at(&texture);
+		}
+
+		const std::vector<UTexture>& arrays() const {
+			return _arrays;
+		}
+
+		void clear() {
+			_arrays.clear();
+			_layers.clear();
+			_pending.clear();
+			_seen.clear();
+			_materials.clear();
+		}
+
+	private:
+		void pack(const Texture* const* textures, size_t count) {
+			const TextureData& first{ textures[0]->data() };
+
+			TextureData data;
+			data.internalFormat = first.internalFormat;
+			data.format = first.format;
+			data.dataType = first.dataType;
+			data.width = first.width;
+			data.height = first.height;
+			data.wrapS = first.wrapS;
+			data.wrapT = first.wrapT;
+			data.minFilter = first.minFilter;
+			data.magFilter = first.magFilter;
+			data.type = TextureType::TEXTURE_ARRAY;
+			data.layerCount = count;
+			data.data.reserve(first.data.size() * count);
+
+			for (size_t i{}; i < count; ++i) {
+				const Buffer<uint8_t>& bytes{ textures[i]->data().data };
+				data.data.insert(data.data.end(), bytes.begin(), bytes.end());
+			}
+
+			_arrays.push_back(std::make_unique<Texture>(std::move(data)));
+
+			for (size_t i{}; i < count; ++i) {
+				_layers.emplace(textures[i], Layer{ _arrays.back().get(), static_cast<uint32_t>(i) });
+			}
+		}
+
+		static bool packable(const Texture& texture) {
+			const TextureData& data{ texture.data() };
+			return data.type == TextureType::TEXTURE_2D && data.width && data.height && !data.data.empty();
+		}
+
+		static bool compatible(const TextureData& left, const TextureData& right) {
+			return left.width == right.width &&
+				left.height == right.height &&
+				left.internalFormat == right.internalFormat &&
+				left.format == right.format &&
+				left.dataType == right.dataType &&
+				left.wrapS == right.wrapS &&
+				left.wrapT == right.wrapT &&
+				left.minFilter == right.minFilter &&
+				left.magFilter == right.magFilter &&
+				left.data.size() == right.data.size();
+		}
+	};
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+
+#include "math/vec.h"
+#include "math/mat.h"
+#include "render_api.h"
+
+namespace Byte {
+
+	// Layouts mirror the std140 blocks declared in the shaders.
+	struct FrameBlock {
+		static constexpr uint32_t binding{ 0 };
+		static constexpr const char* name{ "FrameData" };
+
+		Vec3 wind;
+		float time{};
+		Vec3 fogColor;
+		float fogNear{};
+		Vec2 screenSize;
+		float fogFar{};
+		float gamma{};
+	};
+
+	struct ViewBlock {
+		static constexpr uint32_t binding{ 1 };
+		static constexpr const char* name{ "ViewData" };
+
+		Mat4 projection{};
+		Mat4 view{};
+		Mat4 inverseProjection{};
+		Mat4 inverseView{};
+		Vec3 viewPos;
+		float near{};
+		float far{};
+		float padding[3]{};
+	};
+
+	struct LightBlock {
+		static constexpr uint32_t binding{ 2 };
+		static constexpr const char* name{ "LightData" };
+		static constexpr size_t maxCascades{ 4 };
+
+		Mat4 lightSpaces[maxCascades]{};
+		Vec4 cascadeFars[maxCascades];
+		Vec3 direction;
+		float padding0{};
+		Vec3 color;
+		float intensity{};
+		int32_t cascadeCount{};
+		int32_t padding1[3]{};
+	};
+
+	static_assert(sizeof(FrameBlock) == 48);
+	static_assert(sizeof(ViewBlock) == 288);
+	static_assert(sizeof(LightBlock) == 368);
+
+	template<typename Block>
+	class UniformBuffer {
+	private:
+		Block _data{};
+		uint32_t _id{};
+
+	public:
+		UniformBuffer() = default;
+
+		UniformBuffer(const UniformBuffer&) = delete;
+
+		UniformBuffer(UniformBuffer&& right) noexcept
+			:_data{ right._data }, _id{ right._id } {
+			right._id = 0;
+		}
+
+		UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+		UniformBuffer& operator=(UniformBuffer&& right) noexcept {
+			release();
+
+			_data = right._data;
+			_id = right._id;
+			right._id = 0;
+
+			return *this;
+		}
+
+		~UniformBuffer() {
+			release();
+		}
+
+		Block& data() {
+			return _data;
+		}
+
+		const Block& data() const {
+			return _data;
+		}
+
+		void build() {
+			if (!_id) {
+				_id = RenderAPI::UniformBuffer::build(sizeof(Block));
+			}
+		}
+
+		void upload() {
+			RenderAPI::UniformBuffer::upload(_id, &_data, sizeof(Block));
+		}
+
+		void bind() const {
+			RenderAPI::UniformBuffer::bind(_id, Block::binding);
+		}
+
+		void release() {
+			if (_id) {
+				RenderAPI::UniformBuffer::release(_id);
+				_id = 0;
+			}
+		}
+
+		uint32_t id() const {
+			return _id;
+		}
+	};
+
+}
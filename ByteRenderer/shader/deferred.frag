@@ -7,48 +7,61 @@ layout (location = 2) out vec4 oMaterial;
 in vec3 vNormal;
 in vec2 vTexCoord;
 
-uniform vec4 uAlbedo;
-uniform float uMetallic;
-uniform float uRoughness;
-uniform float uAO;
-uniform float uEmission;
-
 uniform sampler2D uAlbedoTexture;
 uniform sampler2D uMaterialTexture;
+uniform sampler2DArray uAlbedoArray;
+uniform sampler2DArray uMaterialArray;
 
-uniform int uDataMode;
+// Three texels per material: albedo; metallic, roughness, AO, emission; data mode and layers.
+uniform samplerBuffer uMaterials;
+flat in int vMaterialIndex;
 
 void main()
 {    
+    vec4 albedo = texelFetch(uMaterials, vMaterialIndex * 3);
+    vec4 surface = texelFetch(uMaterials, vMaterialIndex * 3 + 1);
+    ivec3 mode = ivec3(texelFetch(uMaterials, vMaterialIndex * 3 + 2).xyz);
+    int dataMode = mode.x;
+    int albedoLayer = mode.y;
+    int materialLayer = mode.z;
+
     oNormal = normalize(vNormal);
 
     vec4 sampledAlbedo = vec4(1.0);
     vec4 sampledMaterial = vec4(1.0);
 
-    bool useAlbedoTexture = (uDataMode == 1 || uDataMode == 3);
+    bool useAlbedoTexture = (dataMode == 1 || dataMode == 3);
 
     if (useAlbedoTexture) {
-        sampledAlbedo = texture(uAlbedoTexture, vTexCoord);
+        sampledAlbedo = albedoLayer < 0
+            ? texture(uAlbedoTexture, vTexCoord)
+            : texture(uAlbedoArray, vec3(vTexCoord, albedoLayer));
         if (sampledAlbedo.a == 0.0) {
             discard;
         }
     } else {
-        if (uAlbedo.a == 0.0) {
+        if (albedo.a == 0.0) {
             discard;
         }
     }
 
-    if (uDataMode == 0) {
-        oAlbedo = uAlbedo.rgb;
-        oMaterial = vec4(uMetallic, uRoughness, uAO, uEmission);
-    } else if (uDataMode == 1) {
-        oAlbedo = sampledAlbedo.rgb * uAlbedo.rgb;
-        oMaterial = vec4(uMetallic, uRoughness, uAO, uEmission);
-    } else if (uDataMode == 2) {
-        oAlbedo = uAlbedo.rgb;
+    if (dataMode >= 2) {
+        sampledMaterial = materialLayer < 0
+            ? texture(uMaterialTexture, vTexCoord)
+            : texture(uMaterialArray, vec3(vTexCoord, materialLayer));
+    }
+
+    if (dataMode == 0) {
+        oAlbedo = albedo.rgb;
+        oMaterial = surface;
+    } else if (dataMode == 1) {
+        oAlbedo = sampledAlbedo.rgb * albedo.rgb;
+        oMaterial = surface;
+    } else if (dataMode == 2) {
+        oAlbedo = albedo.rgb;
         oMaterial = sampledMaterial;
-    } else if (uDataMode == 3) {
-        oAlbedo = sampledAlbedo.rgb * uAlbedo.rgb;
+    } else if (dataMode == 3) {
+        oAlbedo = sampledAlbedo.rgb * albedo.rgb;
         oMaterial = sampledMaterial;
     } else {
         oAlbedo = vec3(1.0);
@@ -6,45 +6,51 @@ in vec3 vFragPos;
 
 out vec4 oFragColor;
 
-uniform vec4 uAlbedo;
-uniform float uMetallic;
-uniform float uRoughness;
-uniform float uAO;
-uniform float uEmission;
-
 uniform sampler2D uAlbedoTexture;
 uniform sampler2D uMaterialTexture;
+uniform sampler2DArray uAlbedoArray;
+uniform sampler2DArray uMaterialArray;
 
-uniform int uDataMode;
+// Three texels per material: albedo; metallic, roughness, AO, emission; data mode and layers.
+uniform samplerBuffer uMaterials;
+flat in int vMaterialIndex;
 
 void main()
 {    
+    vec4 albedo = texelFetch(uMaterials, vMaterialIndex * 3);
+    ivec3 mode = ivec3(texelFetch(uMaterials, vMaterialIndex * 3 + 2).xyz);
+    int dataMode = mode.x;
+    int albedoLayer = mode.y;
+    int materialLayer = mode.z;
+
     vec4 sampledAlbedo = vec4(1.0);
     vec4 sampledMaterial = vec4(1.0);
 
-    bool useAlbedoTexture = (uDataMode == 1 || uDataMode == 3);
+    bool useAlbedoTexture = (dataMode == 1 || dataMode == 3);
 
     if (useAlbedoTexture) {
-        sampledAlbedo = texture(uAlbedoTexture, vTexCoord);
+        sampledAlbedo = albedoLayer < 0
+            ? texture(uAlbedoTexture, vTexCoord)
+            : texture(uAlbedoArray, vec3(vTexCoord, albedoLayer));
         if (sampledAlbedo.a == 0.0) {
             discard;
         }
     } else {
-        if (uAlbedo.a == 0.0) {
+        if (albedo.a == 0.0) {
             discard;
         }
     }
 
     vec4 color;
 
-    if (uDataMode == 0) {
-        color = uAlbedo;
-    } else if (uDataMode == 1) {
-        color = sampledAlbedo * uAlbedo;
-    } else if (uDataMode == 2) {
-        color = uAlbedo;
-    } else if (uDataMode == 3) {
-        color = sampledAlbedo * uAlbedo;
+    if (dataMode == 0) {
+        color = albedo;
+    } else if (dataMode == 1) {
+        color = sampledAlbedo * albedo;
+    } else if (dataMode == 2) {
+        color = albedo;
+    } else if (dataMode == 3) {
+        color = sampledAlbedo * albedo;
     } else {
         color = vec4(1.0);
     }
@@ -0,0 +1,71 @@
+#version 410 core
+
+// Arena vertices: SNORM16 position relative to the mesh bounds, octahedral normal, UNORM16 UV.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+layout (location = 3) in float aDrawIndex;
+
+// Three texels per draw: position and material index; scale including the bounds; rotation.
+uniform samplerBuffer uDraws;
+uniform int uDrawBase;
+
+layout (std140) uniform ViewData {
+    mat4 uProjection;
+    mat4 uView;
+    mat4 uInverseProjection;
+    mat4 uInverseView;
+    vec3 uViewPos;
+    float uNear;
+    float uFar;
+};
+
+out vec3 vNormal;
+out vec2 vTexCoord;
+flat out int vMaterialIndex;
+
+vec3 rotateVertex( vec3 v, vec4 q ) {
+    return v + 2.*cross( q.xyz, cross( q.xyz, v ) + q.w*v ); 
+}
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+vec3 translateVertex(vec3 point, vec3 translation) {
+    return point + translation;
+}
+
+vec3 scaleVertex(vec3 point, vec3 scaleFactor) {
+    return point * scaleFactor;
+}
+
+vec3 translate(vec3 aPos, vec3 position, vec3 scale, vec4 rotation) {
+    vec3 translatedPos = scaleVertex(aPos, scale);
+
+    translatedPos = rotateVertex(translatedPos, rotation);
+
+    translatedPos = translateVertex(translatedPos, position);
+
+    return translatedPos;
+}
+
+void main() {
+    int draw = (uDrawBase + int(aDrawIndex)) * 3;
+
+    vec4 position = texelFetch(uDraws, draw);
+    vec3 scale = texelFetch(uDraws, draw + 1).xyz;
+    vec4 rotation = texelFetch(uDraws, draw + 2);
+
+    vec3 translated = translate(aPos,position.xyz,scale,rotation);
+    gl_Position = uProjection * uView * vec4(translated.xyz, 1.0);
+
+    vNormal = normalize(rotateVertex(decodeOctahedral(aNormal),rotation));
+    vTexCoord = aTexCoord;
+    vMaterialIndex = int(position.w);
+}
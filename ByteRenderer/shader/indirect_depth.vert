@@ -0,0 +1,44 @@
+#version 410 core
+
+layout (location = 0) in vec3 aPos;
+
+layout (location = 3) in float aDrawIndex;
+
+// Three texels per draw: position and material index; scale including the bounds; rotation.
+uniform samplerBuffer uDraws;
+uniform int uDrawBase;
+
+uniform mat4 uLightSpace;
+
+vec3 rotateVertex( vec3 v, vec4 q ) {
+    return v + 2.*cross( q.xyz, cross( q.xyz, v ) + q.w*v ); 
+}
+
+vec3 translateVertex(vec3 point, vec3 translation) {
+    return point + translation;
+}
+
+vec3 scaleVertex(vec3 point, vec3 scaleFactor) {
+    return point * scaleFactor;
+}
+
+vec3 translate(vec3 aPos, vec3 position, vec3 scale, vec4 rotation) {
+    vec3 translatedPos = scaleVertex(aPos, scale);
+
+    translatedPos = rotateVertex(translatedPos, rotation);
+
+    translatedPos = translateVertex(translatedPos, position);
+
+    return translatedPos;
+}
+
+void main() {
+    int draw = (uDrawBase + int(aDrawIndex)) * 3;
+
+    vec3 position = texelFetch(uDraws, draw).xyz;
+    vec3 scale = texelFetch(uDraws, draw + 1).xyz;
+    vec4 rotation = texelFetch(uDraws, draw + 2);
+
+    vec3 translated = translate(aPos,position,scale,rotation);
+    gl_Position = uLightSpace * vec4(translated.xyz, 1.0);
+}
@@ -8,16 +8,39 @@ layout (location = 3) in vec3 aPosition;
 layout (location = 4) in vec3 aScale;
 layout (location = 5) in vec4 aRotation;
 
-uniform mat4 uProjection;
-uniform mat4 uView;
+layout (std140) uniform ViewData {
+    mat4 uProjection;
+    mat4 uView;
+    mat4 uInverseProjection;
+    mat4 uInverseView;
+    vec3 uViewPos;
+    float uNear;
+    float uFar;
+};
+
+uniform int uMaterialIndex;
+
+// SNORM16 positions are relative to the mesh bounds, normals may be octahedral.
+uniform float uPositionScale;
+uniform vec3 uPositionOffset;
+uniform bool uOctahedralNormals;
 
 out vec3 vNormal;
 out vec2 vTexCoord;
+flat out int vMaterialIndex;
 
 vec3 rotateVertex( vec3 v, vec4 q ) {
     return v + 2.*cross( q.xyz, cross( q.xyz, v ) + q.w*v ); 
 }
 
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
 vec3 translateVertex(vec3 point, vec3 translation) {
     return point + translation;
 }
@@ -38,9 +61,12 @@ vec3 translate(vec3 aPos, vec3 position, vec3 scale, vec4 rotation) {
 
 void main() {
 
-    vec3 translated = translate(aPos,aPosition,aScale,aRotation);
+    vec3 local = aPos * uPositionScale + uPositionOffset;
+    vec3 translated = translate(local,aPosition,aScale,aRotation);
     gl_Position = uProjection * uView * vec4(translated.xyz, 1.0);
 
-    vNormal = normalize(rotateVertex(aNormal,aRotation));
+    vec3 normal = uOctahedralNormals ? decodeOctahedral(aNormal.xy) : aNormal;
+    vNormal = normalize(rotateVertex(normal,aRotation));
     vTexCoord = aTexCoord;
+    vMaterialIndex = uMaterialIndex;
 }
@@ -8,6 +8,10 @@ layout (location = 5) in vec4 aRotation;
 
 uniform mat4 uLightSpace;
 
+// SNORM16 positions are relative to the mesh bounds.
+uniform float uPositionScale;
+uniform vec3 uPositionOffset;
+
 vec3 rotateVertex( vec3 v, vec4 q ) {
     return v + 2.*cross( q.xyz, cross( q.xyz, v ) + q.w*v ); 
 }
@@ -31,6 +35,7 @@ vec3 translate(vec3 aPos, vec3 position, vec3 scale, vec4 rotation) {
 }
 
 void main() {
-    vec3 translated = translate(aPos,aPosition,aScale,aRotation);
+    vec3 local = aPos * uPositionScale + uPositionOffset;
+    vec3 translated = translate(local,aPosition,aScale,aRotation);
     gl_Position = uLightSpace * vec4(translated.xyz, 1.0);
 }
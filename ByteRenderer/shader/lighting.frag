@@ -10,22 +10,30 @@ uniform sampler2D uMaterial;
 uniform sampler2D uDepth;
 uniform sampler2D uSSAO;
 
-uniform vec3 uViewPos;
-
-uniform struct {
+layout (std140) uniform ViewData {
+    mat4 uProjection;
+    mat4 uView;
+    mat4 uInverseProjection;
+    mat4 uInverseView;
+    vec3 uViewPos;
+    float uNear;
+    float uFar;
+};
+
+struct DirectionalLight {
     vec3 direction;
     vec3 color;
     float intensity;
-} uDirectionalLight;
+};
 
-uniform mat4 uView;
-uniform mat4 uInverseView;
-uniform mat4 uInverseProjection;
+layout (std140) uniform LightData {
+    mat4 uLightSpaces[4];
+    float uCascadeFars[4];
+    DirectionalLight uDirectionalLight;
+    int uCascadeCount;
+};
 
 uniform sampler2D uDepthMaps[4];
-uniform float uCascadeFars[4];
-uniform mat4 uLightSpaces[4];
-uniform int uCascadeCount;
 
 uniform bool uUseSSAO;
 
@@ -16,11 +16,25 @@ uniform struct PointLight {
     float quadratic;
 } uPointLight;
 
-uniform vec2 uViewPortSize;
-uniform mat4 uInverseView;
-uniform mat4 uInverseProjection;
-
-uniform vec3 uViewPos;
+layout (std140) uniform FrameData {
+    vec3 uWind;
+    float uTime;
+    vec3 uFogColor;
+    float uFogNear;
+    vec2 uScreenSize;
+    float uFogFar;
+    float uGamma;
+};
+
+layout (std140) uniform ViewData {
+    mat4 uProjection;
+    mat4 uView;
+    mat4 uInverseProjection;
+    mat4 uInverseView;
+    vec3 uViewPos;
+    float uNear;
+    float uFar;
+};
 
 const float PI = 3.14159265359;
 
@@ -61,7 +75,7 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0) {
 }
 
 void main() {
-    vec2 texCoord = gl_FragCoord.xy / uViewPortSize;
+    vec2 texCoord = gl_FragCoord.xy / uScreenSize;
     vec3 pos = worldPosFromDepth(texture(uDepth, texCoord).r, texCoord);
     vec3 normal = normalize(texture(uNormal, texCoord).xyz);
     vec3 albedo = texture(uAlbedo, texCoord).rgb;
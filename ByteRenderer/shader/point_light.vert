@@ -9,8 +9,15 @@ uniform vec3 uPosition;
 uniform vec3 uScale;
 uniform vec4 uRotation;
 
-uniform mat4 uProjection;
-uniform mat4 uView;
+layout (std140) uniform ViewData {
+    mat4 uProjection;
+    mat4 uView;
+    mat4 uInverseProjection;
+    mat4 uInverseView;
+    vec3 uViewPos;
+    float uNear;
+    float uFar;
+};
 
 vec3 rotateVertex( vec3 v, vec4 q ) {
     return v + 2.*cross( q.xyz, cross( q.xyz, v ) + q.w*v ); 
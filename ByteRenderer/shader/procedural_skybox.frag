@@ -8,7 +8,12 @@ struct DirectionalLight {
     float intensity;
 };
 
-uniform DirectionalLight uDirectionalLight;
+layout (std140) uniform LightData {
+    mat4 uLightSpaces[4];
+    float uCascadeFars[4];
+    DirectionalLight uDirectionalLight;
+    int uCascadeCount;
+};
 
 in vec3 vRotatedDir;
 
@@ -7,12 +7,25 @@ out vec4 oFragColor;
 uniform sampler2D uAlbedo;
 uniform sampler2D uDepth;
 
-uniform float uGamma;
-uniform float uNear;
-uniform float uFar;
-uniform vec3 uFogColor;
-uniform float uFogNear;
-uniform float uFogFar;
+layout (std140) uniform FrameData {
+    vec3 uWind;
+    float uTime;
+    vec3 uFogColor;
+    float uFogNear;
+    vec2 uScreenSize;
+    float uFogFar;
+    float uGamma;
+};
+
+layout (std140) uniform ViewData {
+    mat4 uProjection;
+    mat4 uView;
+    mat4 uInverseProjection;
+    mat4 uInverseView;
+    vec3 uViewPos;
+    float uNear;
+    float uFar;
+};
 
 float linearizeDepth(float depth, float near, float far) {
     float z = depth * 2.0 - 1.0; 
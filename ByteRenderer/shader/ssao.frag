@@ -8,10 +8,26 @@ uniform sampler2D uNormal;
 uniform sampler2D uDepth;
 uniform sampler2D uNoise;
 
-uniform mat4 uProjection;
-uniform mat4 uInverseProjection;
-uniform mat4 uInverseView;
-uniform vec2 uScreenSize;
+layout (std140) uniform FrameData {
+    vec3 uWind;
+    float uTime;
+    vec3 uFogColor;
+    float uFogNear;
+    vec2 uScreenSize;
+    float uFogFar;
+    float uGamma;
+};
+
+layout (std140) uniform ViewData {
+    mat4 uProjection;
+    mat4 uView;
+    mat4 uInverseProjection;
+    mat4 uInverseView;
+    vec3 uViewPos;
+    float uNear;
+    float uFar;
+};
+
 uniform vec3 uSamples[64];
 
 const float radius = 0.5;
@@ -0,0 +1,110 @@
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "core/mapped_file.h"
+
+namespace Byte {
+
+#ifdef _WIN32
+	void MappedFile::open(const Path& path) {
+		HANDLE file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+		if (file == INVALID_HANDLE_VALUE) {
+			throw std::exception("Cannot open file for mapping");
+		}
+
+		_file = file;
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size)) {
+			close();
+			throw std::exception("Cannot read file size");
+		}
+
+		_size = static_cast<size_t>(size.QuadPart);
+		if (!_size) {
+			return;
+		}
+
+		_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* view{ _mapping ? MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr };
+
+		if (!view) {
+			close();
+			throw std::exception("Cannot map file");
+		}
+
+		_data = static_cast<const uint8_t*>(view);
+	}
+
+	void MappedFile::close() {
+		if (_data) {
+			UnmapViewOfFile(_data);
+		}
+
+		if (_mapping) {
+			CloseHandle(_mapping);
+		}
+
+		if (_file) {
+			CloseHandle(_file);
+		}
+
+		_data = nullptr;
+		_size = 0;
+		_mapping = nullptr;
+		_file = nullptr;
+	}
+#else
+	void MappedFile::open(const Path& path) {
+		int file{ ::open(path.c_str(), O_RDONLY) };
+		if (file < 0) {
+			throw std::exception("Cannot open file for mapping");
+		}
+
+		struct stat status {};
+		if (fstat(file, &status) != 0) {
+			::close(file);
+			throw std::exception("Cannot read file size");
+		}
+
+		_size = static_cast<size_t>(status.st_size);
+		if (!_size) {
+			::close(file);
+			return;
+		}
+
+		void* view{ mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0) };
+		::close(file);
+
+		if (view == MAP_FAILED) {
+			_size = 0;
+			throw std::exception("Cannot map file");
+		}
+
+		madvise(view, _size, MADV_WILLNEED);
+		_data = static_cast<const uint8_t*>(view);
+	}
+
+	void MappedFile::close() {
+		if (_data) {
+			munmap(const_cast<uint8_t*>(_data), _size);
+		}
+
+		_data = nullptr;
+		_size = 0;
+	}
+#endif
+
+}
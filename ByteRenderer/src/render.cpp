@@ -25,6 +25,10 @@ namespace Byte {
 				"../ByteRenderer/shader/instanced.vert",
 				"../ByteRenderer/shader/deferred.frag"
 			};
+			shaders["indirect_deferred"] = {
+				"../ByteRenderer/shader/indirect.vert",
+				"../ByteRenderer/shader/deferred.frag"
+			};
 			shaders["height_map"] = {
 				"../ByteRenderer/shader/quad.vert",
 				"../ByteRenderer/shader/deferred.frag",
@@ -42,6 +46,9 @@ namespace Byte {
 
 			shaders.at("height_map").binding("height_map", "uHeightMap");
 
+			shaders.at("deferred").vertexFormat<StandardVertex>();
+			shaders.at("indirect_deferred").vertexFormat<MeshArena::Format>();
+
 			// Lighting shaders
 			shaders["lighting"] = {
 				"../ByteRenderer/shader/quad.vert",
@@ -61,6 +68,12 @@ namespace Byte {
 				"../ByteRenderer/shader/instanced_depth.vert",
 				"../ByteRenderer/shader/depth.frag"
 			};
+			shaders["indirect_depth"] = {
+				"../ByteRenderer/shader/indirect_depth.vert",
+				"../ByteRenderer/shader/depth.frag"
+			};
+
+			shaders.at("indirect_depth").vertexFormat<MeshArena::Format>();
 
 			// Skybox shader
 			shaders["procedural_skybox"] = {
@@ -102,36 +115,40 @@ namespace Byte {
 		}
 
 		void setupRenderingParameters(Renderer& renderer) {
-			auto& params{ renderer.data().parameters };
+			RenderData& data{ renderer.data() };
 
 			// Basic rendering toggles
-			params.emplace("render_skybox", true);
-			params.emplace("render_shadow", true);
-			params.emplace("clear_gbuffer", true);
-			params.emplace("gamma", 2.2f);
-
-			// Shadow cascade parameters
-			params.emplace("cascade_count", 4U);
-			params.emplace("cascade_divisor_1", 1.0f);
-			params.emplace("cascade_divisor_2", 4.0f);
-			params.emplace("cascade_divisor_3", 8.0f);
-			params.emplace("cascade_divisor_4", 20.0f);
-			params.emplace("cascade_light_1", Mat4{});
-			params.emplace("cascade_light_2", Mat4{});
-			params.emplace("cascade_light_3", Mat4{});
-			params.emplace("cascade_light_4", Mat4{});
-			params.emplace("current_shadow_draw_frame", 0U);
-			params.emplace("shadow_draw_frame", 4U);
+			data.declare("render_skybox", true);
+			data.declare("render_shadow", true);
+			data.declare("gamma", 2.2f);
+
+			// Shadow cascade parameters, at most four cascades have depth buffers
+			data.declare("cascade_count", 4U);
+			data.declare("cascade_divisor_1", 1.0f);
+			data.declare("cascade_divisor_2", 4.0f);
+			data.declare("cascade_divisor_3", 8.0f);
+			data.declare("cascade_divisor_4", 20.0f);
+			data.declare("cascade_light_1", Mat4{});
+			data.declare("cascade_light_2", Mat4{});
+			data.declare("cascade_light_3", Mat4{});
+			data.declare("cascade_light_4", Mat4{});
+			data.declare("current_shadow_draw_frame", 0U);
+			data.declare("shadow_draw_frame", 4U);
+
+			// Level of detail parameters, errors in pixels
+			data.declare("lod_threshold", 1.0f);
+			data.declare("lod_hysteresis", 0.25f);
 
 			// Post-processing parameters
-			params.emplace("render_bloom", true);
-			params.emplace("bloom_mip_count", 5U);
-			params.emplace("bloom_strength", 0.3f);
-			params.emplace("render_ssao", true);
-			params.emplace("render_fxaa", true);
-			params.emplace("fog_color", Vec3(0.3f, 0.4f, 0.6f));
-			params.emplace("fog_near", 450.0f);
-			params.emplace("fog_far", 550.0f);
+			data.declare("render_bloom", true);
+			// Bloom buffers are created for the initial count, it may only shrink at runtime
+			data.declare("bloom_mip_count", 5U);
+			data.declare("bloom_strength", 0.3f);
+			data.declare("render_ssao", true);
+			data.declare("render_fxaa", true);
+			data.declare("fog_color", Vec3(0.3f, 0.4f, 0.6f));
+			data.declare("fog_near", 450.0f);
+			data.declare("fog_far", 550.0f);
 		}
 
 		void setupMeshes(Renderer& renderer) {
@@ -232,6 +249,7 @@ namespace Byte {
 			FramebufferData bloomBufferData;
 			bloomBufferData.width = width;
 			bloomBufferData.height = height;
+			bloomBufferData.transient = true;
 			bloomBufferData.textures = {
 				{
 					"color",
@@ -258,6 +276,7 @@ namespace Byte {
 			FramebufferData ssaoBufferData;
 			ssaoBufferData.width = width;
 			ssaoBufferData.height = height;
+			ssaoBufferData.transient = true;
 			ssaoBufferData.textures = {
 				{
 					"color",
@@ -275,6 +294,7 @@ namespace Byte {
 			FramebufferData blurBufferData;
 			blurBufferData.width = width;
 			blurBufferData.height = height;
+			blurBufferData.transient = true;
 			blurBufferData.textures = {
 				{
 					"color",
@@ -293,6 +313,7 @@ namespace Byte {
 	Renderer deferredRenderer(Window& window) {
 		Renderer renderer{
 			Renderer::build<
+				UniformPass,
 				FrustumCullingPass,
 				SkyboxPass,
 				ShadowPass,
@@ -0,0 +1,357 @@
+#include <algorithm>
+
+#include "render/render_graph.h"
+#include "render/render_pass.h"
+
+namespace Byte {
+
+	void RenderGraph::build(Pipeline& pipeline, RenderData& data) {
+		_nodes.clear();
+		_counts.clear();
+		_nodes.reserve(pipeline.size());
+
+		for (auto& pass : pipeline) {
+			Node node{ pass.get(), _nodes.size() };
+			Builder builder{ node, _counts, data };
+			pass->setup(builder, data);
+
+			_nodes.push_back(std::move(node));
+		}
+
+		_enabled.assign(_nodes.size(), false);
+		_dirty = true;
+
+		compile(data);
+	}
+
+	void RenderGraph::compile(RenderData& data) {
+		bool changed{ updateEnabled(data) };
+		if (!changed && !_dirty) {
+			return;
+		}
+
+		Buffer<Node> active;
+		for (size_t i{}; i < _nodes.size(); ++i) {
+			if (_enabled[i]) {
+				active.push_back(_nodes[i]);
+			}
+		}
+
+		Buffer<size_t> order{ sort(active) };
+		Buffer<bool> live(active.size(), true);
+		Buffer<Node> merged;
+
+		while (true) {
+			merged = active;
+			_mergedClearCount = 0;
+
+			std::unordered_set<ResourceTag> written;
+			for (size_t index : order) {
+				if (!live[index]) {
+					continue;
+				}
+
+				for (auto& write : merged[index].writes) {
+					bool first{ written.insert(write.tag).second };
+					if (!first && write.load == LoadOperation::CLEAR) {
+						write.load = LoadOperation::LOAD;
+						++_mergedClearCount;
+					}
+				}
+			}
+
+			Buffer<bool> next{ cull(merged, order) };
+			if (next == live) {
+				break;
+			}
+			live = std::move(next);
+		}
+
+		_steps.clear();
+		_lifetimes.clear();
+		_culledCount = _nodes.size() - active.size();
+
+		for (size_t index : order) {
+			if (!live[index]) {
+				++_culledCount;
+				continue;
+			}
+
+			const Node& node{ merged[index] };
+			size_t position{ _steps.size() };
+
+			Step step{ node.pass, node.index };
+			for (const auto& write : node.writes) {
+				auto result{ data.frameBuffers.find(write.tag) };
+				if (write.load == LoadOperation::CLEAR && result != data.frameBuffers.end()) {
+					step.clears.push_back(&result->second);
+				}
+			}
+
+			auto extend = [this, position](const ResourceTag& tag) {
+				auto [it, inserted] = _lifetimes.emplace(tag, Lifetime{ position, position });
+				if (!inserted) {
+					it->second.last = position;
+				}
+			};
+
+			for (const auto& tag : node.reads) {
+				extend(tag);
+			}
+			for (const auto& write : node.writes) {
+				extend(write.tag);
+			}
+
+			_steps.push_back(std::move(step));
+		}
+
+		assignAliases(data);
+
+		_dirty = false;
+	}
+
+	void RenderGraph::prepare(const Step& step) const {
+		for (Framebuffer* framebuffer : step.clears) {
+			framebuffer->clearContent();
+		}
+	}
+
+	void RenderGraph::alias(RenderData& data) const {
+		for (const auto& [tag, target] : _aliases) {
+			data.frameBuffers.at(tag).alias(data.frameBuffers.at(target));
+		}
+	}
+
+	bool RenderGraph::updateEnabled(RenderData& data) {
+		bool changed{ false };
+
+		for (size_t i{}; i < _nodes.size(); ++i) {
+			bool enabled{ _nodes[i].pass->enabled(data) };
+			if (enabled != _enabled[i]) {
+				_enabled[i] = enabled;
+				changed = true;
+			}
+		}
+
+		return changed;
+	}
+
+	Buffer<size_t> RenderGraph::sort(const Buffer<Node>& nodes) const {
+		struct Access {
+			size_t node{};
+			bool write{};
+		};
+
+		size_t count{ nodes.size() };
+		std::unordered_map<ResourceTag, Buffer<Access>> accesses;
+
+		for (size_t i{}; i < count; ++i) {
+			const Node& node{ nodes[i] };
+
+			for (const auto& write : node.writes) {
+				accesses[write.tag].push_back(Access{ i, true });
+			}
+
+			for (const auto& tag : node.reads) {
+				bool written{ std::any_of(node.writes.begin(), node.writes.end(), [&tag](const Write& write) {
+					return write.tag == tag;
+				}) };
+
+				if (!written) {
+					accesses[tag].push_back(Access{ i, false });
+				}
+			}
+		}
+
+		Buffer<Buffer<size_t>> edges(count);
+		Buffer<size_t> incoming(count, 0);
+
+		auto link = [&edges, &incoming](size_t from, size_t to) {
+			if (from != to) {
+				edges[from].push_back(to);
+				++incoming[to];
+			}
+		};
+
+		// Writers of a resource keep their relative order, readers follow the writer before them
+		// and precede the next one. Readers with no earlier writer consume the final version.
+		for (const auto& [tag, list] : accesses) {
+			auto last{ std::find_if(list.rbegin(), list.rend(), [](const Access& access) {
+				return access.write;
+			}) };
+
+			const Access* producer{};
+			Buffer<size_t> consumers;
+
+			for (const auto& access : list) {
+				if (access.write) {
+					if (producer) {
+						link(producer->node, access.node);
+					}
+					for (size_t consumer : consumers) {
+						link(consumer, access.node);
+					}
+
+					consumers.clear();
+					producer = &access;
+				}
+				else if (producer) {
+					link(producer->node, access.node);
+					consumers.push_back(access.node);
+				}
+				else if (last != list.rend()) {
+					link(last->node, access.node);
+				}
+			}
+		}
+
+		Buffer<size_t> order;
+		Buffer<size_t> ready;
+
+		for (size_t i{}; i < count; ++i) {
+			if (!incoming[i]) {
+				ready.push_back(i);
+			}
+		}
+
+		while (!ready.empty()) {
+			auto next{ std::min_element(ready.begin(), ready.end()) };
+			size_t index{ *next };
+			ready.erase(next);
+
+			order.push_back(index);
+
+			for (size_t target : edges[index]) {
+				if (!--incoming[target]) {
+					ready.push_back(target);
+				}
+			}
+		}
+
+		if (order.size() != count) {
+			throw std::exception("Render graph has cyclic resource dependencies");
+		}
+
+		return order;
+	}
+
+	Buffer<bool> RenderGraph::cull(const Buffer<Node>& nodes, const Buffer<size_t>& order) const {
+		Buffer<bool> live(nodes.size(), false);
+		std::unordered_set<ResourceTag> needed;
+
+		for (auto it{ order.rbegin() }; it != order.rend(); ++it) {
+			const Node& node{ nodes[*it] };
+
+			bool used{ node.output };
+			for (const auto& write : node.writes) {
+				used = used || needed.count(write.tag);
+			}
+
+			if (!used) {
+				continue;
+			}
+
+			live[*it] = true;
+
+			for (const auto& write : node.writes) {
+				if (write.load != LoadOperation::LOAD) {
+					needed.erase(write.tag);
+				}
+			}
+
+			for (const auto& tag : node.reads) {
+				needed.insert(tag);
+			}
+		}
+
+		return live;
+	}
+
+	void RenderGraph::assignAliases(RenderData& data) {
+		struct Candidate {
+			FramebufferTag tag;
+			Lifetime lifetime;
+		};
+
+		Buffer<Candidate> candidates;
+		for (const auto& [tag, framebuffer] : data.frameBuffers) {
+			auto result{ _lifetimes.find(tag) };
+			if (framebuffer.data().transient && result != _lifetimes.end()) {
+				candidates.push_back(Candidate{ tag, result->second });
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+			if (a.lifetime.first != b.lifetime.first) {
+				return a.lifetime.first < b.lifetime.first;
+			}
+			return a.tag < b.tag;
+		});
+
+		struct Slot {
+			FramebufferTag tag;
+			size_t last{};
+		};
+
+		Buffer<Slot> slots;
+		AliasMap aliases;
+
+		for (const auto& candidate : candidates) {
+			const FramebufferData& description{ data.frameBuffers.at(candidate.tag).data() };
+
+			auto slot{ std::find_if(slots.begin(), slots.end(), [&](const Slot& slot) {
+				return slot.last < candidate.lifetime.first &&
+					compatible(data.frameBuffers.at(slot.tag).data(), description);
+			}) };
+
+			if (slot != slots.end()) {
+				aliases.emplace(candidate.tag, slot->tag);
+				slot->last = candidate.lifetime.last;
+			}
+			else {
+				slots.push_back(Slot{ candidate.tag, candidate.lifetime.last });
+			}
+		}
+
+		for (auto& [tag, framebuffer] : data.frameBuffers) {
+			auto result{ aliases.find(tag) };
+			if (framebuffer.aliased() && (result == aliases.end() || _aliases.at(tag) != result->second)) {
+				framebuffer.unalias();
+			}
+		}
+
+		_aliases = std::move(aliases);
+
+		alias(data);
+	}
+
+	bool RenderGraph::compatible(const FramebufferData& left, const FramebufferData& right) {
+		if (left.width != right.width || left.height != right.height ||
+			left.resize != right.resize || left.resizeFactor != right.resizeFactor ||
+			left.textures.size() != right.textures.size()) {
+			return false;
+		}
+
+		for (const auto& [tag, texture] : left.textures) {
+			auto result{ right.textures.find(tag) };
+			if (result == right.textures.end()) {
+				return false;
+			}
+
+			const TextureData& other{ result->second };
+			if (texture.attachment != other.attachment ||
+				texture.internalFormat != other.internalFormat ||
+				texture.format != other.format ||
+				texture.dataType != other.dataType ||
+				texture.type != other.type ||
+				texture.layerCount != other.layerCount ||
+				texture.width != other.width ||
+				texture.height != other.height) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+}
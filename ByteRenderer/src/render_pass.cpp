@@ -2,24 +2,163 @@
 
 namespace Byte {
 
+	Buffer<ShadowCascade> ShadowCascade::resolve(RenderGraph::Builder& builder, RenderData& data) {
+		size_t cascadeCount{ builder.count("cascade_count") };
+
+		Buffer<ShadowCascade> cascades;
+		for (size_t i{}; i < cascadeCount; ++i) {
+			std::string index{ std::to_string(i + 1) };
+			Framebuffer& depthBuffer{ data.frameBuffers.at("depthBuffer" + index) };
+
+			cascades.push_back(ShadowCascade{
+				data.resolve<float>("cascade_divisor_" + index),
+				data.resolve<Mat4>("cascade_light_" + index),
+				depthBuffer,
+				Attachment{ depthBuffer, "depth" } });
+		}
+
+		return cascades;
+	}
+
+	void UniformPass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		builder.write("frameData", LoadOperation::DONT_CARE);
+		builder.write("viewData", LoadOperation::DONT_CARE);
+		builder.write("lightData", LoadOperation::DONT_CARE);
+		builder.output();
+
+		_gamma = data.resolve<float>("gamma");
+		_fogNear = data.resolve<float>("fog_near");
+		_fogFar = data.resolve<float>("fog_far");
+		_fogColor = data.resolve<Vec3>("fog_color");
+
+		_cascades = ShadowCascade::resolve(builder, data);
+	}
+
+	void UniformPass::render(RenderContext& context, RenderData& data) {
+		float aspectRatio{ static_cast<float>(data.width) / static_cast<float>(data.height) };
+
+		auto [camera, cTransform] = context.camera();
+		auto [directionalLight, dlTransform] = context.directionalLight();
+
+		FrameBlock& frame{ data.frameBlock.data() };
+		frame.time = context.time();
+		frame.wind = context.wind();
+		frame.fogColor = *_fogColor;
+		frame.fogNear = *_fogNear;
+		frame.fogFar = *_fogFar;
+		frame.gamma = *_gamma;
+		frame.screenSize = Vec2{ static_cast<float>(data.width), static_cast<float>(data.height) };
+
+		ViewBlock& view{ data.viewBlock.data() };
+		view.projection = camera->perspective(aspectRatio);
+		view.view = cTransform->view();
+		view.inverseProjection = view.projection.inverse();
+		view.inverseView = view.view.inverse();
+		view.viewPos = cTransform->position();
+		view.near = camera->nearPlane();
+		view.far = camera->farPlane();
+
+		LightBlock& light{ data.lightBlock.data() };
+		size_t cascadeCount{ std::min(_cascades.size(), LightBlock::maxCascades) };
+
+		for (size_t i{}; i < cascadeCount; ++i) {
+			light.lightSpaces[i] = *_cascades[i].lightSpace;
+			light.cascadeFars[i].x = camera->farPlane() / *_cascades[i].divisor;
+		}
+
+		light.cascadeCount = static_cast<int32_t>(cascadeCount);
+		light.direction = dlTransform->front();
+		light.color = directionalLight->color;
+		light.intensity = directionalLight->intensity;
+
+		data.frameBlock.upload();
+		data.viewBlock.upload();
+		data.lightBlock.upload();
+
+		data.frameBlock.bind();
+		data.viewBlock.bind();
+		data.lightBlock.bind();
+	}
+
+	void FrustumCullingPass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		builder.write("visibility", LoadOperation::DONT_CARE);
+
+		_lodThreshold = data.resolve<float>("lod_threshold");
+		_lodHysteresis = data.resolve<float>("lod_hysteresis");
+	}
+
 	void FrustumCullingPass::render(RenderContext& context, RenderData& data) {
+		BYTE_PROFILE_ZONE("FrustumCullingPass::cull");
+
 		float aspectRatio{ static_cast<float>(data.width) / static_cast<float>(data.height) };
 		auto [camera, cameraTransform] = context.camera();
 
 		Frustum frustum{ createFrustum(*camera, *cameraTransform, aspectRatio) };
 
+		data.visibleRanges.clear();
+
 		for (auto& pair : context.renderEntities()) {
-			auto [mesh, material, transform, mode, meshRenderer] = pair.second;
+			auto [mesh, material, transform, meshRenderer, mode, lod, shadowLod] = pair.second;
 
-			if (!inside(frustum, *transform, mesh->data().boundingRadius)) {
+			if (!inside(frustum, *transform, mesh->bounds())) {
 				pair.second.mode = RenderMode::DISABLED;
 			}
 			else {
 				pair.second.mode = RenderMode::ENABLED;
+				pair.second.lod = static_cast<uint8_t>(selectLod(*mesh, *transform, *camera, *cameraTransform, static_cast<float>(data.height), lod));
+
+				// Ranges index the full mesh, so coarser levels are drawn whole.
+				if (!mesh->ranges().empty() && pair.second.lod == 0) {
+					cullRanges(frustum, pair.first, pair.second, data);
+				}
 			}
 		}
 	}
 
+	void FrustumCullingPass::cullRanges(
+		const Frustum& frustum,
+		RenderID id,
+		RenderContext::RenderEntity& entity,
+		RenderData& data) const {
+		const MeshArena::Slice* slice{ data.arena.slice(*entity.mesh) };
+		if (!slice) {
+			return;
+		}
+
+		const Transform& transform{ *entity.transform };
+		const Vec3& scale{ transform.scale() };
+		float maxScale{ std::max(std::max(scale.x, scale.y), scale.z) };
+
+		Buffer<MeshArena::Slice> visible;
+		uint32_t end{ UINT32_MAX };
+
+		for (const MeshRange& range : entity.mesh->ranges()) {
+			Vec3 center{ transform.rotation() * (range.center * scale) + transform.position() };
+			if (!inside(frustum, center, range.radius * maxScale)) {
+				continue;
+			}
+
+			if (range.firstIndex == end) {
+				visible.back().indexCount += range.indexCount;
+			}
+			else {
+				MeshArena::Slice part{ *slice };
+				part.firstIndex = slice->firstIndex + range.firstIndex;
+				part.indexCount = range.indexCount;
+				visible.push_back(part);
+			}
+
+			end = range.firstIndex + range.indexCount;
+		}
+
+		if (visible.empty()) {
+			entity.mode = RenderMode::DISABLED;
+		}
+		else if (visible.size() > 1 || visible.front().indexCount != slice->indexCount) {
+			data.visibleRanges.emplace(id, std::move(visible));
+		}
+	}
+
 	FrustumCullingPass::Frustum FrustumCullingPass::createFrustum(
 		const Camera& camera, 
 		const Transform& transform,
@@ -71,16 +210,57 @@ namespace Byte {
 		return frustum;
 	}
 
-	bool FrustumCullingPass::inside(const Frustum& frustum, const Transform& transform, float radius) const {
-		Vec3 position{ transform.position() };
+	// The sphere rejects most meshes cheaply; the box around the rotated mesh box catches
+	// long or flat meshes whose sphere still reaches into the frustum.
+	bool FrustumCullingPass::inside(const Frustum& frustum, const Transform& transform, const MeshBounds& bounds) const {
+		const Vec3& scale{ transform.scale() };
+		float maxScale{ std::max(std::max(std::abs(scale.x), std::abs(scale.y)), std::abs(scale.z)) };
 
-		Vec3 scale{ transform.scale() };
-		float maxScale{ std::max(std::max(scale.x, scale.y), scale.z) };
-		float scaledRadius{ radius * maxScale };
+		Vec3 center{ transform.rotation() * (bounds.sphere.center * scale) + transform.position() };
+		if (!inside(frustum, center, bounds.sphere.radius * maxScale)) {
+			return false;
+		}
+
+		return inside(frustum, bounds.box.transformed(transform.position(), transform.rotation(), scale));
+	}
+
+	// Error in pixels is the world space error over the distance to the bounding sphere, times
+	// the pixels one unit covers at distance one.
+	size_t FrustumCullingPass::selectLod(
+		const Mesh& mesh,
+		const Transform& transform,
+		const Camera& camera,
+		const Transform& eye,
+		float height,
+		size_t current) const {
+		if (mesh.lodCount() < 2) {
+			return 0;
+		}
+
+		const Vec3& scale{ transform.scale() };
+		float maxScale{ std::max(std::max(std::abs(scale.x), std::abs(scale.y)), std::abs(scale.z)) };
+
+		const BoundingSphere& sphere{ mesh.bounds().sphere };
+		Vec3 center{ transform.rotation() * (sphere.center * scale) + transform.position() };
+
+		float distance{ std::max((center - eye.position()).length() - sphere.radius * maxScale, camera.nearPlane()) };
+		float pixels{ height / (2.0f * std::tan(radians(camera.fov()) * 0.5f)) };
+
+		return mesh.selectLod(pixels * maxScale / distance, *_lodThreshold, *_lodHysteresis, current);
+	}
+
+	bool FrustumCullingPass::inside(const Frustum& frustum, const BoundingBox& box) const {
+		Vec3 center{ box.center() };
+		Vec3 extent{ box.extent() };
 
 		for (const auto& plane : frustum.planes) {
-			float distance{ plane.normal.dot(position) + plane.distance };
-			if (distance < -scaledRadius) {
+			float distance{ plane.normal.dot(center) + plane.distance };
+			float reach{
+				std::abs(plane.normal.x) * extent.x +
+				std::abs(plane.normal.y) * extent.y +
+				std::abs(plane.normal.z) * extent.z };
+
+			if (distance < -reach) {
 				return false;
 			}
 		}
@@ -88,19 +268,37 @@ namespace Byte {
 		return true;
 	}
 
-	void SkyboxPass::render(RenderContext& context, RenderData& data) {
-		if (!data.parameter<bool>("render_skybox")) {
-			return;
+	bool FrustumCullingPass::inside(const Frustum& frustum, const Vec3& center, float radius) const {
+		for (const auto& plane : frustum.planes) {
+			float distance{ plane.normal.dot(center) + plane.distance };
+			if (distance < -radius) {
+				return false;
+			}
 		}
 
-		Framebuffer& gBuffer{ data.frameBuffers["gBuffer"] };
+		return true;
+	}
 
-		gBuffer.bind();
-		gBuffer.clearContent();
+	void SkyboxPass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		builder.read("lightData");
+		builder.write("gBuffer", LoadOperation::CLEAR);
 
-		data.parameter<bool>("clear_gbuffer") = false;
+		_renderSkybox = data.resolve<bool>("render_skybox");
+		_gBuffer = data.framebuffer("gBuffer");
+		_shader = data.shader("procedural_skybox");
+		_quad = data.mesh("quad");
+	}
+
+	bool SkyboxPass::enabled(RenderData& data) {
+		return *_renderSkybox;
+	}
 
-		Shader& skyboxShader{ data.shaders["procedural_skybox"] };
+	void SkyboxPass::render(RenderContext& context, RenderData& data) {
+		Framebuffer& gBuffer{ *_gBuffer };
+
+		gBuffer.bind();
+
+		Shader& skyboxShader{ *_shader };
 
 		float aspectRatio{ static_cast<float>(data.width) / static_cast<float>(data.height) };
 		auto [camera, cTransform] = context.camera();
@@ -113,117 +311,228 @@ namespace Byte {
 
 		Mat4 inv{(projection * view).inverse()};
 
-		auto [dl, dlTransform] = context.directionalLight();
 		skyboxShader.bind();
 
 		RenderAPI::disableDepth();
 
 		skyboxShader.uniform<Mat4>("uInverseViewProjection", inv);
-		skyboxShader.uniform<Vec3>("uDirectionalLight.direction", dlTransform->front());
-		skyboxShader.uniform<Vec3>("uDirectionalLight.color", dl->color);
-		skyboxShader.uniform<float>("uDirectionalLight.intensity", dl->intensity);
 
-		data.meshes.at("quad").renderer.bind();
+		_quad->renderer.bind();
 
 		RenderAPI::Draw::elements(
-			data.meshes.at("quad").mesh.indices().size(),
-			data.meshes.at("quad").renderer.primitive());
+			_quad->mesh.indices().size(),
+			_quad->renderer.primitive(),
+			_quad->renderer.indexType());
 
-		data.meshes.at("quad").renderer.unbind();
+		_quad->renderer.unbind();
 		gBuffer.unbind();
 
 		RenderAPI::enableDepth();
 	}
 
-	void ShadowPass::render(RenderContext& context, RenderData& data) {
-		if (!data.parameter<bool>("render_shadow")) {
-			return;
+	void ShadowPass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		_renderShadow = data.resolve<bool>("render_shadow");
+		_drawFrame = data.resolve<uint32_t>("shadow_draw_frame");
+		_currentDrawFrame = data.resolve<uint32_t>("current_shadow_draw_frame");
+		_lodThreshold = data.resolve<float>("lod_threshold");
+		_lodHysteresis = data.resolve<float>("lod_hysteresis");
+
+		_depthShader = data.shader("depth");
+		_instancedDepthShader = data.shader("instanced_depth");
+		_indirectDepthShader = data.shader("indirect_depth");
+
+		_cascades = ShadowCascade::resolve(builder, data);
+
+		for (size_t i{}; i < _cascades.size(); ++i) {
+			builder.write("depthBuffer" + std::to_string(i + 1));
 		}
 
-		size_t drawFrame{ data.parameter<uint32_t>("shadow_draw_frame") };
-		size_t current{ data.parameter<uint32_t>("current_shadow_draw_frame")++ % drawFrame };
+		builder.read("lightData");
+		builder.write("lightData");
+	}
+
+	bool ShadowPass::enabled(RenderData& data) {
+		return *_renderShadow;
+	}
+
+	void ShadowPass::render(RenderContext& context, RenderData& data) {
+		size_t current{ (*_currentDrawFrame)++ % *_drawFrame };
 		if (current != 0) {
 			return;
 		}
 
-		Shader& depthShader{ data.shaders["depth"] };
-		Shader& instancedDepthShader{ data.shaders["instanced_depth"] };
+		Shader& depthShader{ *_depthShader };
+		Shader& instancedDepthShader{ *_instancedDepthShader };
+		Shader& indirectDepthShader{ *_indirectDepthShader };
 
 		float aspectRatio{ static_cast<float>(data.width) / static_cast<float>(data.height) };
 
-		size_t cascadeCount{ data.parameter<uint32_t>("cascade_count") };
+		updateLightMatrices(aspectRatio, context);
 
-		Buffer<Framebuffer*> depthBuffers;
-		for (size_t i = 0; i < cascadeCount; ++i) {
-			depthBuffers.push_back(&data.frameBuffers.at("depthBuffer" + std::to_string(i + 1)));
+		LightBlock& light{ data.lightBlock.data() };
+		for (size_t i{}; i < std::min(_cascades.size(), LightBlock::maxCascades); ++i) {
+			light.lightSpaces[i] = *_cascades[i].lightSpace;
 		}
+		data.lightBlock.upload();
 
-		updateLightMatrices(aspectRatio, data, context);
+		_commands.clear();
+		recordEntities(context, data, depthShader, indirectDepthShader);
+		recordInstances(context, instancedDepthShader);
 
 		RenderAPI::enableCulling();
 		RenderAPI::cullFront();
 
-		for (size_t i{}; i < depthBuffers.size(); ++i) {
-			Mat4 lightSpace{ data.parameter<Mat4>("cascade_light_" + std::to_string(i + 1)) };
+		for (auto& cascade : _cascades) {
+			const Mat4& lightSpace{ *cascade.lightSpace };
 
-			depthBuffers[i]->bind();
-			depthBuffers[i]->clearContent();
+			cascade.depthBuffer->bind();
+			cascade.depthBuffer->clearContent();
 
 			depthShader.bind();
 			depthShader.uniform<Mat4>("uLightSpace", lightSpace);
 
-			renderEntities(context, depthShader);
-
 			instancedDepthShader.bind();
 			instancedDepthShader.uniform<Mat4>("uLightSpace", lightSpace);
-			renderInstances(context);
 
-			depthBuffers[i]->unbind();
+			indirectDepthShader.bind();
+			indirectDepthShader.uniform<Mat4>("uLightSpace", lightSpace);
+
+			_commands.execute();
+
+			cascade.depthBuffer->unbind();
 		}
 
 		RenderAPI::cullBack();
 		RenderAPI::disableCulling();
 	}
 
-	void ShadowPass::renderEntities(RenderContext& context, const Shader& shader) const {
+	void ShadowPass::recordEntities(
+		RenderContext& context,
+		RenderData& data,
+		const Shader& shader,
+		const Shader& indirectShader) {
+		BYTE_PROFILE_ZONE("ShadowPass::recordEntities");
+
+		_entities.clear();
+		_draws.clear();
+		_indirect.clear();
+
 		for (auto& pair : context.renderEntities()) {
-			auto [mesh, material, transform, meshRenderer, mode] = pair.second;
+			auto& entity{ pair.second };
 
-			if (material->shadow() == ShadowMode::ENABLED) {
-				meshRenderer->bind();
+			float texelsPerUnit{};
+			if (entity.material->shadow() != ShadowMode::ENABLED || !casts(*entity.transform, entity.mesh->bounds(), texelsPerUnit)) {
+				continue;
+			}
 
-				shader.uniform<Vec3>("uPosition", transform->position());
-				shader.uniform<Vec3>("uScale", transform->scale());
-				shader.uniform<Quaternion>("uRotation", transform->rotation());
+			const Vec3& scale{ entity.transform->scale() };
+			float maxScale{ std::max(std::max(std::abs(scale.x), std::abs(scale.y)), std::abs(scale.z)) };
 
-				RenderAPI::Draw::elements(mesh->indices().size(), meshRenderer->primitive());
+			entity.shadowLod = static_cast<uint8_t>(entity.mesh->selectLod(
+				texelsPerUnit * maxScale,
+				*_lodThreshold,
+				*_lodHysteresis,
+				entity.shadowLod));
 
-				meshRenderer->unbind();
+			const MeshArena::Slice* slice{ entity.meshRenderer->primitive() == PrimitiveType::TRIANGLES
+				? data.arena.slice(*entity.mesh, entity.shadowLod)
+				: nullptr };
+
+			if (slice) {
+				_draws.queue(0, *slice, *entity.transform);
 			}
+			else {
+				_entities.push_back(&entity);
+			}
+		}
+
+		if (_draws.queued()) {
+			_draws.flush([this](uint32_t group, const IndirectCommand& command) {
+				_indirect.push_back(command);
+			});
+
+			_draws.upload();
+			data.arena.reserve(_draws.size());
+
+			_commands.shader(indirectShader);
+			_commands.texture(_draws.texture(), Shader::drawUnit, TextureType::TEXTURE_BUFFER);
+			_commands.renderArray(data.arena.renderArray());
+			_commands.drawIndirect(_indirect.data(), _indirect.size(), PrimitiveType::TRIANGLES, data.arena.indexType());
 		}
+
+		_recorder.record(_entities.size(), _commands, [this, &shader](CommandList& list, size_t begin, size_t end) {
+			BYTE_PROFILE_ZONE("ShadowPass::recordChunk");
+
+			list.shader(shader);
+
+			for (size_t i{ begin }; i < end; ++i) {
+				auto [mesh, material, transform, meshRenderer, mode, lod, shadowLod] = *_entities[i];
+
+				list.renderArray(*meshRenderer);
+
+				list.uniform<Vec3>("uPosition", meshRenderer->position(*transform));
+				list.uniform<Vec3>("uScale", transform->scale() * meshRenderer->positionScale());
+				list.uniform<Quaternion>("uRotation", transform->rotation());
+
+				list.draw(
+					mesh->lodIndexCount(shadowLod),
+					meshRenderer->primitive(),
+					meshRenderer->indexType(),
+					mesh->lodFirstIndex(shadowLod));
+			}
+		});
 	}
 
-	void ShadowPass::renderInstances(RenderContext& context) const {
+	// Commands are shared by every cascade, so a mesh is kept if its box reaches into the
+	// clip volume of any of them, and its level of detail follows the sharpest of those.
+	bool ShadowPass::casts(const Transform& transform, const MeshBounds& bounds, float& texelsPerUnit) const {
+		BoundingBox world{ bounds.box.transformed(transform.position(), transform.rotation(), transform.scale()) };
+
+		bool inside{ false };
+		texelsPerUnit = 0.0f;
+
+		for (const auto& cascade : _cascades) {
+			const Mat4& lightSpace{ *cascade.lightSpace };
+			BoundingBox clip{ world.transformed(lightSpace) };
+
+			if (clip.max.x >= -1.0f && clip.min.x <= 1.0f &&
+				clip.max.y >= -1.0f && clip.min.y <= 1.0f &&
+				clip.max.z >= -1.0f && clip.min.z <= 1.0f) {
+				Vec3 row{ lightSpace(0, 0), lightSpace(0, 1), lightSpace(0, 2) };
+
+				texelsPerUnit = std::max(texelsPerUnit, row.length() * cascade.depth->width * 0.5f);
+				inside = true;
+			}
+		}
+
+		return inside;
+	}
+
+	void ShadowPass::recordInstances(RenderContext& context, const Shader& shader) {
+		_commands.shader(shader);
+
 		for (auto& pair : context.instances()) {
-			Mesh mesh{ pair.second.mesh() };
+			Mesh& mesh{ pair.second.mesh() };
 			Material& material{ pair.second.material() };
 			MeshRenderer& meshRenderer{ pair.second.meshRenderer() };
 
 			if (material.shadow() == ShadowMode::ENABLED) {
-				meshRenderer.bind();
+				_commands.renderArray(meshRenderer);
 
-				RenderAPI::Draw::instancedElements(
+				_commands.uniform<float>("uPositionScale", meshRenderer.positionScale());
+				_commands.uniform<Vec3>("uPositionOffset", meshRenderer.positionOffset());
+
+				_commands.drawInstanced(
 					mesh.indices().size(),
 					pair.second.size(),
-					meshRenderer.primitive());
-
-				meshRenderer.unbind();
+					meshRenderer.primitive(),
+					meshRenderer.indexType());
 			}
 		}
 	}
 
-	void ShadowPass::updateLightMatrices(float aspectRatio, RenderData& data, RenderContext& context) {
-		size_t cascadeCount{ data.parameter<uint32_t>("cascade_count") };
+	void ShadowPass::updateLightMatrices(float aspectRatio, RenderContext& context) {
+		BYTE_PROFILE_ZONE("ShadowPass::updateLightMatrices");
 
 		auto [dl, dlTransform] = context.directionalLight();
 
@@ -233,11 +542,9 @@ namespace Byte {
 		float far{ camera->farPlane() };
 		float near{ camera->nearPlane() };
 
-		for (size_t i{}; i < cascadeCount; ++i) {
-			float divisor{ data.parameter<float>("cascade_divisor_" + std::to_string(i + 1)) };
-			Mat4 projection{ camera->perspective(aspectRatio,near,far / divisor) };
-			Mat4 lightSpace{ frustumSpace(projection, view, *dlTransform, far) };
-			data.parameter<Mat4>("cascade_light_" + std::to_string(i + 1)) = lightSpace;
+		for (auto& cascade : _cascades) {
+			Mat4 projection{ camera->perspective(aspectRatio,near,far / *cascade.divisor) };
+			*cascade.lightSpace = frustumSpace(projection, view, *dlTransform, far);
 		}
 	}
 
@@ -300,116 +607,202 @@ namespace Byte {
 		return lightProjection * lightView;
 	}
 
-	void GeometryPass::renderEntities(
+	void GeometryPass::recordEntities(
 		RenderContext& context,
 		RenderData& data,
-		const Mat4& projection,
-		const Mat4& view,
-		const ShaderTag& defaultTag,
-		TransparencyMode mode) const {
+		Shader& defaultShader,
+		TransparencyMode mode,
+		Shader* indirectShader) {
+		BYTE_PROFILE_ZONE("GeometryPass::recordEntities");
 
-		for (auto& pair : context.renderEntities()) {
-			auto [mesh, material, transform, meshRenderer, renderMode] = pair.second;
+		_entities.clear();
+		_draws.clear();
+		_batchIndex.clear();
 
-			if (material->transparency() != mode || renderMode == RenderMode::DISABLED) {
+		bool batching{ indirectShader && data.arena.drawable() };
+
+		for (auto& pair : context.renderEntities()) {
+			const auto& entity{ pair.second };
+			if (entity.material->transparency() != mode || entity.mode == RenderMode::DISABLED) {
 				continue;
 			}
 
-			Shader* shader;
+			if (batching && entity.meshRenderer->primitive() == PrimitiveType::TRIANGLES) {
+				const MaterialRecord& record{ data.materials.record(*entity.material) };
+				const MeshArena::Slice* slice{ data.arena.slice(*entity.mesh, entity.lod) };
+
+				if (!record.shader && slice) {
+					uint32_t group{ batch(record) };
+
+					auto ranges{ data.visibleRanges.find(pair.first) };
+					if (ranges != data.visibleRanges.end()) {
+						for (const MeshArena::Slice& range : ranges->second) {
+							_draws.queue(group, range, *entity.transform, record.index);
+						}
+					}
+					else {
+						_draws.queue(group, *slice, *entity.transform, record.index);
+					}
 
-			auto result{ material->shaderMap().find("geometry") };
-			if (result != material->shaderMap().end()) {
-				shader = &data.shaders.at(result->second);
+					continue;
+				}
 			}
-			else {
-				shader = &data.shaders.at(defaultTag);
+
+			_entities.push_back(&entity);
+		}
+
+		_commands.texture(data.materials.texture(), Shader::materialUnit, TextureType::TEXTURE_BUFFER);
+
+		if (_draws.queued()) {
+			recordBatches(context, data, *indirectShader);
+		}
+
+		auto record = [this, &context, &data, &defaultShader](CommandList& list, size_t begin, size_t end) {
+			BYTE_PROFILE_ZONE("GeometryPass::recordChunk");
+
+			const Shader* bound{ nullptr };
+
+			for (size_t i{ begin }; i < end; ++i) {
+				auto [mesh, material, transform, meshRenderer, renderMode, lod, shadowLod] = *_entities[i];
+
+				const MaterialRecord& record{ data.materials.record(*material) };
+				const Shader* shader{ record.shader ? record.shader : &defaultShader };
+
+				if (shader != bound) {
+					list.shader(*shader);
+					list.uniform(context.shaderInputMap());
+					bound = shader;
+				}
+
+				list.material(record);
+
+				list.renderArray(*meshRenderer);
+
+				list.uniform<Vec3>("uPosition", meshRenderer->position(*transform));
+				list.uniform<Vec3>("uScale", transform->scale() * meshRenderer->positionScale());
+				list.uniform<Quaternion>("uRotation", transform->rotation());
+				list.uniform<bool>("uOctahedralNormals", meshRenderer->octahedralNormals());
+
+				list.draw(
+					mesh->lodIndexCount(lod),
+					meshRenderer->primitive(),
+					meshRenderer->indexType(),
+					mesh->lodFirstIndex(lod));
 			}
+		};
 
-			shader->bind();
+		_recorder.record(_entities.size(), _commands, record);
+	}
 
-			shader->uniform(context.shaderInputMap());
+	void GeometryPass::recordBatches(RenderContext& context, RenderData& data, Shader& indirectShader) {
+		BYTE_PROFILE_ZONE("GeometryPass::recordBatches");
 
-			shader->uniform<Mat4>("uProjection", projection);
-			shader->uniform<Mat4>("uView", view);
-			shader->uniform(*material);
+		_draws.flush([this](uint32_t group, const IndirectCommand& command) {
+			_batches[group].commands.push_back(command);
+		});
 
-			meshRenderer->bind();
+		_draws.upload();
+		data.arena.reserve(_draws.size());
 
-			shader->uniform<Vec3>("uPosition", transform->position());
-			shader->uniform<Vec3>("uScale", transform->scale());
-			shader->uniform<Quaternion>("uRotation", transform->rotation());
+		_commands.shader(indirectShader);
+		_commands.uniform(context.shaderInputMap());
+		_commands.texture(_draws.texture(), Shader::drawUnit, TextureType::TEXTURE_BUFFER);
+		_commands.renderArray(data.arena.renderArray());
 
-			RenderAPI::Draw::elements(mesh->indices().size(), meshRenderer->primitive());
+		for (size_t i{}; i < _batchIndex.size(); ++i) {
+			Batch& batch{ _batches[i] };
 
-			meshRenderer->unbind();
+			_commands.material(*batch.record);
+			_commands.drawIndirect(
+				batch.commands.data(),
+				batch.commands.size(),
+				PrimitiveType::TRIANGLES,
+				data.arena.indexType());
 		}
 	}
 
-	void GeometryPass::renderInstances(
+	uint32_t GeometryPass::batch(const MaterialRecord& record) {
+		auto [result, inserted] { _batchIndex.try_emplace(BatchKey{ record.albedo, record.surface }, _batchIndex.size()) };
+
+		if (result->second >= _batches.size()) {
+			_batches.emplace_back();
+		}
+
+		if (inserted) {
+			Batch& batch{ _batches[result->second] };
+			batch.record = &record;
+			batch.commands.clear();
+		}
+
+		return static_cast<uint32_t>(result->second);
+	}
+
+	void GeometryPass::recordInstances(
 		RenderContext& context,
 		RenderData& data,
-		const Mat4& projection,
-		const Mat4& view,
-		const ShaderTag& defaultTag,
-		TransparencyMode mode) const {
+		Shader& defaultShader,
+		TransparencyMode mode) {
+		BYTE_PROFILE_ZONE("GeometryPass::recordInstances");
+
+		const Shader* bound{ nullptr };
 
 		for (auto& pair : context.instances()) {
 			Mesh& mesh{ pair.second.mesh() };
-			Material& material{ pair.second.material() };
+			const Material& material{ pair.second.material() };
 			MeshRenderer& meshRenderer{ pair.second.meshRenderer() };
 
 			if (material.transparency() != mode || pair.second.renderMode() == RenderMode::DISABLED) {
 				continue;
 			}
 
-			Shader* shader;
+			const MaterialRecord& record{ data.materials.record(material) };
+			const Shader* shader{ record.shader ? record.shader : &defaultShader };
 
-			auto result{ material.shaderMap().find("geometry") };
-			if (result != material.shaderMap().end()) {
-				shader = &data.shaders.at(result->second);
-			}
-			else {
-				shader = &data.shaders.at(defaultTag);
+			if (shader != bound) {
+				_commands.shader(*shader);
+				_commands.uniform(context.shaderInputMap());
+				bound = shader;
 			}
 
-			shader->bind();
-			shader->uniform(context.shaderInputMap());
+			_commands.material(record);
 
-			shader->uniform<Mat4>("uProjection", projection);
-			shader->uniform<Mat4>("uView", view);
-			shader->uniform(material);
+			_commands.renderArray(meshRenderer);
 
-			meshRenderer.bind();
+			_commands.uniform<float>("uPositionScale", meshRenderer.positionScale());
+			_commands.uniform<Vec3>("uPositionOffset", meshRenderer.positionOffset());
+			_commands.uniform<bool>("uOctahedralNormals", meshRenderer.octahedralNormals());
 
-			RenderAPI::Draw::instancedElements(
+			_commands.drawInstanced(
 				mesh.indices().size(),
 				pair.second.size(),
-				meshRenderer.primitive());
-
-			meshRenderer.unbind();
+				meshRenderer.primitive(),
+				meshRenderer.indexType());
 		}
 	}
 
-	void OpaquePass::render(RenderContext& context, RenderData& data) {
-		float aspectRatio{ static_cast<float>(data.width) / static_cast<float>(data.height) };
-		auto [camera, cTransform] = context.camera();
-		Mat4 projection{ camera->perspective(aspectRatio) };
-		Mat4 view{ cTransform->view() };
+	void OpaquePass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		builder.read("visibility");
+		builder.read("frameData");
+		builder.read("viewData");
+		builder.write("gBuffer", LoadOperation::CLEAR);
 
-		Framebuffer& gBuffer{ data.frameBuffers.at("gBuffer") };
-		gBuffer.bind();
+		_gBuffer = data.framebuffer("gBuffer");
+		_shader = data.shader("deferred");
+		_instancedShader = data.shader("instanced_deferred");
+		_indirectShader = data.shader("indirect_deferred");
+	}
 
-		if (data.parameter<bool>("clear_gbuffer")) {
-			gBuffer.clearContent();
-		}
+	void OpaquePass::render(RenderContext& context, RenderData& data) {
+		Framebuffer& gBuffer{ *_gBuffer };
+		gBuffer.bind();
 
-		renderEntities(context, data, projection, view, "deferred", TransparencyMode::BINARY);
+		_commands.clear();
+		recordEntities(context, data, *_shader, TransparencyMode::BINARY, _indirectShader.get());
+		recordInstances(context, data, *_instancedShader, TransparencyMode::BINARY);
 
-		renderInstances(context, data, projection, view, "instanced_deferred", TransparencyMode::BINARY);
+		_commands.execute();
 
 		gBuffer.unbind();
-
-		data.parameter<bool>("clear_gbuffer") = true;
 	}
 		
 	SSAOPass::SSAOPass() {
@@ -436,132 +829,153 @@ namespace Byte {
 		}
 	}
 
-	void SSAOPass::render(RenderContext& context, RenderData& data) {
-		if (!_noiseTexture.data().id) {
-			RenderAPI::Texture::build(_noiseTexture.data());
-		}
+	void SSAOPass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		builder.read("gBuffer");
+		builder.read("ssaoBuffer");
+		builder.read("frameData");
+		builder.read("viewData");
+		builder.write("ssaoBuffer", LoadOperation::CLEAR);
+		builder.write("blurBuffer", LoadOperation::CLEAR);
 
-		if (!data.parameter<bool>("render_ssao")) {
-			return;
-		}
+		_renderSSAO = data.resolve<bool>("render_ssao");
+
+		_ssaoShader = data.shader("ssao");
+		_blurShader = data.shader("blur");
 
-		Shader& ssaoShader{ data.shaders.at("ssao") };
+		_ssaoBuffer = data.framebuffer("ssaoBuffer");
+		_blurBuffer = data.framebuffer("blurBuffer");
 
 		Framebuffer& gBuffer{ data.frameBuffers.at("gBuffer") };
+		_normal = Attachment{ gBuffer, "normal" };
+		_depth = Attachment{ gBuffer, "depth" };
+		_ssao = Attachment{ *_ssaoBuffer, "color" };
 
-		Framebuffer& ssaoBuffer{ data.frameBuffers.at("ssaoBuffer") };
-		ssaoBuffer.bind();
-		ssaoBuffer.clearContent();
+		_quad = data.mesh("quad");
+	}
 
-		ssaoShader.bind();
+	bool SSAOPass::enabled(RenderData& data) {
+		return *_renderSSAO;
+	}
 
-		float aspectRatio{ static_cast<float>(data.width) / static_cast<float>(data.height) };
+	void SSAOPass::render(RenderContext& context, RenderData& data) {
+		if (!_noiseTexture.data().id) {
+			RenderAPI::Texture::build(_noiseTexture.data());
+		}
 
-		auto [camera, cTransform] = context.camera();
-		auto [directionalLight, dlTransform] = context.directionalLight();
+		Shader& ssaoShader{ *_ssaoShader };
 
-		Mat4 projection{ camera->perspective(aspectRatio) };
-		Mat4 view{ cTransform->view() };
-		Mat4 inverseView{ view.inverse() };
-		Mat4 inverseProjection{ projection.inverse() };
+		_ssaoBuffer->bind();
 
-		Vec2 screenSize{ static_cast<float>(data.width), static_cast<float>(data.height) };
+		ssaoShader.bind();
 
-		ssaoShader.uniform<Mat4>("uProjection", projection);
-		ssaoShader.uniform<Mat4>("uInverseView", inverseView);
-		ssaoShader.uniform<Mat4>("uInverseProjection", inverseProjection);
-		ssaoShader.uniform<Vec2>("uScreenSize", screenSize);
 		ssaoShader.uniform<Vec3>("uSamples", _kernel);
 
-		RenderAPI::Texture::bind(gBuffer.textureID("normal"), TextureUnit::T0);
+		RenderAPI::Texture::bind(_normal->id, TextureUnit::T0);
 		RenderAPI::Texture::bind(_noiseTexture.id(), TextureUnit::T1);
-		RenderAPI::Texture::bind(gBuffer.textureID("depth"), TextureUnit::T2);
+		RenderAPI::Texture::bind(_depth->id, TextureUnit::T2);
 
 		ssaoShader.uniform("uNormal", 0);
 		ssaoShader.uniform("uNoise", 1);
 		ssaoShader.uniform("uDepth", 2);
 
-		data.meshes.at("quad").renderer.bind();
+		_quad->renderer.bind();
 
 		RenderAPI::Draw::quad();
 
-		data.meshes.at("quad").renderer.unbind();
+		_quad->renderer.unbind();
 
-		Framebuffer& blurBuffer{ data.frameBuffers.at("blurBuffer") };
-		blurBuffer.bind();
-		blurBuffer.clearContent();
-		Shader& blurShader{ data.shaders.at("blur") };
+		_blurBuffer->bind();
+		Shader& blurShader{ *_blurShader };
 		blurShader.bind();
 
-		RenderAPI::Texture::bind(ssaoBuffer.textureID("color"), TextureUnit::T0);
-		RenderAPI::Texture::bind(gBuffer.textureID("depth"), TextureUnit::T1);
+		RenderAPI::Texture::bind(_ssao->id, TextureUnit::T0);
+		RenderAPI::Texture::bind(_depth->id, TextureUnit::T1);
 
 		blurShader.uniform("uSrcTexture", 0);
 		blurShader.uniform("uDepth", 1);
 
-		data.meshes.at("quad").renderer.bind();
+		_quad->renderer.bind();
 
 		RenderAPI::Draw::quad();
 
-		data.meshes.at("quad").renderer.unbind();
+		_quad->renderer.unbind();
 	}
 		
-	void LightingPass::render(RenderContext& context, RenderData& data) {
-		Shader& lightingShader{ data.shaders.at("lighting") };
+	void LightingPass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		_cascades = ShadowCascade::resolve(builder, data);
+
+		builder.read("gBuffer");
+		builder.read("blurBuffer");
+		builder.read("viewData");
+		builder.read("lightData");
+
+		for (size_t i{}; i < _cascades.size(); ++i) {
+			builder.read("depthBuffer" + std::to_string(i + 1));
+		}
+
+		builder.write("colorBuffer", LoadOperation::CLEAR);
+
+		_renderSSAO = data.resolve<bool>("render_ssao");
+
+		_lightingShader = data.shader("lighting");
+		_pointLightShader = data.shader("point_light");
+
+		_colorBuffer = data.framebuffer("colorBuffer");
 
 		Framebuffer& gBuffer{ data.frameBuffers.at("gBuffer") };
-		Framebuffer& colorBuffer{ data.frameBuffers.at("colorBuffer") };
+		_normal = Attachment{ gBuffer, "normal" };
+		_albedo = Attachment{ gBuffer, "albedo" };
+		_material = Attachment{ gBuffer, "material" };
+		_depth = Attachment{ gBuffer, "depth" };
+		_ssao = data.attachment("blurBuffer", "color");
+
+		_quad = data.mesh("quad");
+		_sphere = data.mesh("low_poly_sphere");
+
+		_depthUnits.clear();
+		for (size_t i{}; i < _cascades.size(); ++i) {
+			_depthUnits.push_back(static_cast<int>(i + 4));
+		}
+	}
+
+	void LightingPass::render(RenderContext& context, RenderData& data) {
+		Shader& lightingShader{ *_lightingShader };
+
+		Framebuffer& colorBuffer{ *_colorBuffer };
 
 		colorBuffer.bind();
-		colorBuffer.clearContent();
 
 		lightingShader.bind();
 
-		float aspectRatio{ static_cast<float>(data.width) / static_cast<float>(data.height) };
-
 		auto [camera, cTransform] = context.camera();
-		auto [directionalLight, dlTransform] = context.directionalLight();
-
-		Mat4 projection{ camera->perspective(aspectRatio) };
-		Mat4 view{ cTransform->view() };
-		Mat4 inverseView{ view.inverse() };
-		Mat4 inverseProjection{ projection.inverse() };
-		Vec3 viewPos{ cTransform->position() };
 
-		RenderAPI::Texture::bind(gBuffer.textureID("normal"), TextureUnit::T0);
-		RenderAPI::Texture::bind(gBuffer.textureID("albedo"), TextureUnit::T1);
-		RenderAPI::Texture::bind(gBuffer.textureID("material"), TextureUnit::T2);
-		RenderAPI::Texture::bind(gBuffer.textureID("depth"), TextureUnit::T3);
+		RenderAPI::Texture::bind(_normal->id, TextureUnit::T0);
+		RenderAPI::Texture::bind(_albedo->id, TextureUnit::T1);
+		RenderAPI::Texture::bind(_material->id, TextureUnit::T2);
+		RenderAPI::Texture::bind(_depth->id, TextureUnit::T3);
 
-		if (data.parameter<bool>("render_ssao")) {
-			size_t cascadeCount{ data.parameter<uint32_t>("cascade_count") };
+		if (*_renderSSAO) {
 			TextureUnit ssaoUnit{ static_cast<TextureUnit>(
-				static_cast<uint32_t>(TextureUnit::T4) + cascadeCount
+				static_cast<uint32_t>(TextureUnit::T4) + _cascades.size()
 			) };
 
-			Framebuffer& blurBuffer{ data.frameBuffers.at("blurBuffer") };
-			RenderAPI::Texture::bind(blurBuffer.textureID("color"), ssaoUnit);
+			RenderAPI::Texture::bind(_ssao->id, ssaoUnit);
 			lightingShader.uniform("uSSAO", static_cast<int>(ssaoUnit));
 		}
 
 		setupGBufferTextures(lightingShader);
-		setupCascades(data, lightingShader, *camera);
-		bindCommon(lightingShader, view, inverseView, inverseProjection, viewPos);
+		setupCascades(lightingShader);
 
-		lightingShader.uniform<Vec3>("uDirectionalLight.direction", dlTransform->front());
-		lightingShader.uniform<Vec3>("uDirectionalLight.color", directionalLight->color);
-		lightingShader.uniform<float>("uDirectionalLight.intensity", directionalLight->intensity);
+		lightingShader.uniform<bool>("uUseSSAO", *_renderSSAO);
 
-		lightingShader.uniform<bool>("uUseSSAO", data.parameter<bool>("render_ssao"));
-
-		data.meshes.at("quad").renderer.bind();
+		_quad->renderer.bind();
 		RenderAPI::Draw::quad();
-		data.meshes.at("quad").renderer.unbind();
+		_quad->renderer.unbind();
 
 		lightingShader.unbind();
 
 		if (!context.pointLights().empty()) {
-			Shader& plShader{ data.shaders.at("point_light") };
+			Shader& plShader{ *_pointLightShader };
 			plShader.bind();
 
 			RenderAPI::enableBlend();
@@ -570,18 +984,11 @@ namespace Byte {
 			RenderAPI::cullFront();
 			RenderAPI::disableDepth();
 
-			plShader.uniform<Vec2>(
-				"uViewPortSize",
-				Vec2{ static_cast<float>(data.width), static_cast<float>(data.height) });
-
-			bindCommon(plShader, view, inverseView, inverseProjection, viewPos);
-			plShader.uniform<Mat4>("uProjection", projection);
-
 			setupGBufferTextures(plShader);
 
 			float halfFar{ camera->farPlane() / 2 };
 
-			data.meshes.at("low_poly_sphere").renderer.bind();
+			_sphere->renderer.bind();
 
 			for (auto& pair : context.pointLights()) {
 				auto [pointLight, _transform] = pair.second;
@@ -602,11 +1009,12 @@ namespace Byte {
 				plShader.uniform<float>("uPointLight.quadratic", pointLight->quadratic);
 
 				RenderAPI::Draw::elements(
-					data.meshes.at("low_poly_sphere").mesh.indices().size(),
-					data.meshes.at("low_poly_sphere").renderer.primitive());
+					_sphere->mesh.indices().size(),
+					_sphere->renderer.primitive(),
+					_sphere->renderer.indexType());
 			}
 
-			data.meshes.at("low_poly_sphere").renderer.unbind();
+			_sphere->renderer.unbind();
 			plShader.unbind();
 
 			RenderAPI::enableDepth();
@@ -625,47 +1033,31 @@ namespace Byte {
 		shader.uniform("uDepth", 3);
 	}
 
-	void LightingPass::setupCascades(RenderData& data, Shader& shader, Camera& camera) {
-		size_t cascadeCount{ data.parameter<uint32_t>("cascade_count") };
-
-		float far{ camera.farPlane() };
-		Buffer<float> farPlanes;
-		Buffer<Mat4> lightSpaces{};
-		Buffer<TextureID> dbTextures;
-
-		for (size_t i{ 0 }; i < cascadeCount; ++i) {
-			float divisor{ data.parameter<float>("cascade_divisor_" + std::to_string(i + 1)) };
-			farPlanes.push_back(far / divisor);
-			lightSpaces.push_back(data.parameter<Mat4>("cascade_light_" + std::to_string(i + 1)));
-			dbTextures.push_back(data.frameBuffers.at("depthBuffer" + std::to_string(i + 1)).textureID("depth"));
-		}
-
-		for (size_t i{}; i < dbTextures.size(); ++i) {
-			shader.uniform("uDepthMaps[" + std::to_string(i) + "]", static_cast<int>(i + 4));
+	void LightingPass::setupCascades(Shader& shader) {
+		for (size_t i{}; i < _cascades.size(); ++i) {
 			TextureUnit unit{ static_cast<TextureUnit>(static_cast<uint32_t>(TextureUnit::T4) + i) };
-			RenderAPI::Texture::bind(dbTextures[i], unit);
+			RenderAPI::Texture::bind(_cascades[i].depth->id, unit);
 		}
 
-		shader.uniform<Mat4>("uLightSpaces", lightSpaces);
-		shader.uniform<float>("uCascadeFars", farPlanes);
-		shader.uniform<int>("uCascadeCount", static_cast<int>(cascadeCount));
+		shader.uniform<int>("uDepthMaps", _depthUnits);
 	}
 
-	void LightingPass::bindCommon(Shader& shader, Mat4& view, Mat4& iView, Mat4& iProjection, Vec3& viewPos) {
-		shader.uniform<Mat4>("uView", view);
-		shader.uniform<Mat4>("uInverseView", iView);
-		shader.uniform<Mat4>("uInverseProjection", iProjection);
-		shader.uniform<Vec3>("uViewPos", viewPos);
+	void TransparentPass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		builder.read("visibility");
+		builder.read("gBuffer");
+		builder.read("frameData");
+		builder.read("viewData");
+		builder.write("colorBuffer");
+
+		_gBuffer = data.framebuffer("gBuffer");
+		_colorBuffer = data.framebuffer("colorBuffer");
+		_shader = data.shader("transparency");
+		_instancedShader = data.shader("instanced_transparency");
 	}
 
 	void TransparentPass::render(RenderContext& context, RenderData& data)  {
-		float aspectRatio{ static_cast<float>(data.width) / static_cast<float>(data.height) };
-		auto [camera, cTransform] = context.camera();
-		Mat4 projection{ camera->perspective(aspectRatio) };
-		Mat4 view{ cTransform->view() };
-
-		Framebuffer& gBuffer{ data.frameBuffers.at("gBuffer") };
-		Framebuffer& colorBuffer{ data.frameBuffers.at("colorBuffer") };
+		Framebuffer& gBuffer{ *_gBuffer };
+		Framebuffer& colorBuffer{ *_colorBuffer };
 
 		RenderAPI::Framebuffer::blitDepth(gBuffer.data(), colorBuffer.data());
 
@@ -675,53 +1067,80 @@ namespace Byte {
 		RenderAPI::enableBlend();
 		RenderAPI::setBlendTransparency();
 
-		renderEntities(context, data, projection, view, "transparency", TransparencyMode::UNSORTED);
+		_commands.clear();
+		recordEntities(context, data, *_shader, TransparencyMode::UNSORTED);
+		recordInstances(context, data, *_instancedShader, TransparencyMode::UNSORTED);
 
-		renderInstances(context, data, projection, view, "instanced_transparency", TransparencyMode::UNSORTED);
+		_commands.execute();
 
 		RenderAPI::enableDepthMask();
 		RenderAPI::disableBlend();
 
 		colorBuffer.unbind();
-
-		data.parameter<bool>("clear_gbuffer") = true;
 	}
 		
-	void BloomPass::render(RenderContext& context, RenderData& data) {
-		if (!data.parameter<bool>("render_bloom")) {
-			return;
+	void BloomPass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		size_t mipCount{ builder.count("bloom_mip_count") };
+
+		builder.read("colorBuffer");
+
+		_bloomBuffers.clear();
+
+		for (size_t i{ 1 }; i <= mipCount; ++i) {
+			FramebufferTag tag{ "bloomBuffer" + std::to_string(i) };
+
+			builder.read(tag);
+			builder.write(tag, LoadOperation::CLEAR);
+
+			Framebuffer& bloomBuffer{ data.frameBuffers.at(tag) };
+			_bloomBuffers.push_back(Target{ bloomBuffer, Attachment{ bloomBuffer, "color" } });
 		}
 
-		size_t mipCount{ data.parameter<uint32_t>("bloom_mip_count") };
+		builder.write("colorBuffer");
+
+		_renderBloom = data.resolve<bool>("render_bloom");
+		_gamma = data.resolve<float>("gamma");
+		_strength = data.resolve<float>("bloom_strength");
+
+		_downsampleShader = data.shader("bloom_downsample");
+		_upsampleShader = data.shader("bloom_upsample");
 
-		Shader& downsampleShader{ data.shaders.at("bloom_downsample") };
+		Framebuffer& colorBuffer{ data.frameBuffers.at("colorBuffer") };
+		_colorBuffer = Target{ colorBuffer, Attachment{ colorBuffer, "color" } };
+
+		_quad = data.mesh("quad");
+	}
+
+	bool BloomPass::enabled(RenderData& data) {
+		return *_renderBloom;
+	}
+
+	void BloomPass::render(RenderContext& context, RenderData& data) {
+		Shader& downsampleShader{ *_downsampleShader };
 		downsampleShader.bind();
-		downsampleShader.uniform<float>("uInvGamma", 1.0f / data.parameter<float>("gamma"));
+		downsampleShader.uniform<float>("uInvGamma", 1.0f / *_gamma);
 		downsampleShader.uniform<bool>(" uKarisAvarage", true);
 
-		Framebuffer* src{ &data.frameBuffers.at("colorBuffer") };
+		const Target* src{ &_colorBuffer };
 
-		for (size_t i{ 1 }; i <= mipCount; ++i) {
-			Framebuffer* dest{ &data.frameBuffers.at("bloomBuffer" + std::to_string(i)) };
+		for (const auto& dest : _bloomBuffers) {
+			float srcWidth{ static_cast<float>(src->framebuffer->width()) };
+			float srcHeight{ static_cast<float>(src->framebuffer->height()) };
 
-			float srcWidth{ static_cast<float>(src->width()) };
-			float srcHeight{ static_cast<float>(src->height()) };
-
-			dest->bind();
-			dest->clearContent();
+			dest.framebuffer->bind();
 
 			downsampleShader.uniform("uSrcTexture", 0);
-			RenderAPI::Texture::bind(src->textureID("color"));
+			RenderAPI::Texture::bind(src->color->id);
 
 			downsampleShader.uniform<Vec2>("uSrcResolution", Vec2{ srcWidth,srcHeight });
 
-			data.meshes.at("quad").renderer.bind();
+			_quad->renderer.bind();
 
 			RenderAPI::Draw::quad();
 
-			data.meshes.at("quad").renderer.unbind();
+			_quad->renderer.unbind();
 
-			src = dest;
+			src = &dest;
 
 			downsampleShader.uniform<bool>(" uKarisAvarage", false);
 		}
@@ -729,81 +1148,72 @@ namespace Byte {
 		RenderAPI::enableBlend();
 		RenderAPI::disableDepth();
 
-		Shader& upsampleShader{ data.shaders.at("bloom_upsample") };
+		Shader& upsampleShader{ *_upsampleShader };
 
 		upsampleShader.bind();
 		upsampleShader.uniform<float>("uFilterRadius", 0.01f);
 		upsampleShader.uniform("uSrcTexture", 0);
-		RenderAPI::Texture::bind(src->textureID("color"));
-
-		src = &data.frameBuffers["bloomBuffer" + std::to_string(mipCount)];
-		for (size_t i{ mipCount }; i > 1; --i) {
-			Framebuffer* dest{ &data.frameBuffers.at("bloomBuffer" + std::to_string(i - 1)) };
+		RenderAPI::Texture::bind(src->color->id);
 
-			dest->bind();
+		for (size_t i{ _bloomBuffers.size() }; i > 1; --i) {
+			_bloomBuffers[i - 2].framebuffer->bind();
 
-			data.meshes.at("quad").renderer.bind();
+			_quad->renderer.bind();
 
 			RenderAPI::Draw::quad();
 
-			data.meshes.at("quad").renderer.unbind();
-
-			src = dest;
+			_quad->renderer.unbind();
 		}
 
-		float strength{ data.parameter<float>("bloom_strength") };
+		float strength{ *_strength };
 
 		RenderAPI::setBlend(strength, 1.0f - strength);
 
-		data.frameBuffers.at("colorBuffer").bind();
+		_colorBuffer.framebuffer->bind();
 
-		data.meshes.at("quad").renderer.bind();
+		_quad->renderer.bind();
 		RenderAPI::Draw::quad();
-		data.meshes.at("quad").renderer.unbind();
+		_quad->renderer.unbind();
 
 		RenderAPI::disableBlend();
 		RenderAPI::enableDepth();
 	}
 		
-	void DrawPass::render(RenderContext& context, RenderData& data) {
-		RenderAPI::viewPort(data.width, data.height);
-		RenderAPI::Framebuffer::clear(0);
+	void DrawPass::setup(RenderGraph::Builder& builder, RenderData& data) {
+		builder.read("colorBuffer");
+		builder.read("gBuffer");
+		builder.read("frameData");
+		builder.read("viewData");
+		builder.output();
 
-		auto [camera, cTransform] = context.camera();
+		_renderFXAA = data.resolve<bool>("render_fxaa");
 
-		Shader* shader;
+		_fxaaShader = data.shader("fxaa");
+		_quadShader = data.shader("quad");
 
-		if (data.parameter<bool>("render_fxaa")) {
-			shader = &data.shaders.at("fxaa");
-			shader->bind();
-			Vec2 screenSize{ static_cast<float>(data.width), static_cast<float>(data.height) };
-			shader->uniform("uScreenSize", screenSize);
-		}
-		else {
-			shader = &data.shaders.at("quad");
-			shader->bind();
-		}
+		_color = data.attachment("colorBuffer", "color");
+		_depth = data.attachment("gBuffer", "depth");
 
-		Framebuffer& colorBuffer{ data.frameBuffers.at("colorBuffer") };
-		Framebuffer& gBuffer{ data.frameBuffers.at("gBuffer") };
+		_quad = data.mesh("quad");
+	}
+
+	void DrawPass::render(RenderContext& context, RenderData& data) {
+		RenderAPI::viewPort(data.width, data.height);
+		RenderAPI::Framebuffer::clear(RenderAPI::Framebuffer::defaultFramebuffer());
+
+		Shader* shader{ *_renderFXAA ? _fxaaShader.get() : _quadShader.get() };
+		shader->bind();
 
-		shader->uniform("uGamma", data.parameter<float>("gamma"));
 		shader->uniform("uAlbedo", 0);
-		RenderAPI::Texture::bind(colorBuffer.textureID("color"), TextureUnit::T0);
+		RenderAPI::Texture::bind(_color->id, TextureUnit::T0);
 		shader->uniform("uDepth", 1);
-		RenderAPI::Texture::bind(gBuffer.textureID("depth"), TextureUnit::T1);
-
-		shader->uniform("uNear", camera->nearPlane());
-		shader->uniform("uFar", camera->farPlane());
-		shader->uniform("uFogNear", data.parameter<float>("fog_near"));
-		shader->uniform("uFogFar", data.parameter<float>("fog_far"));
-		shader->uniform("uFogColor", data.parameter<Vec3>("fog_color"));
+		RenderAPI::Texture::bind(_depth->id, TextureUnit::T1);
 
-		data.meshes.at("quad").renderer.bind();
+		_quad->renderer.bind();
 
 		RenderAPI::Draw::quad();
 
-		data.meshes.at("quad").renderer.unbind();
+		_quad->renderer.unbind();
 	}
 
 }
\ No newline at end of file
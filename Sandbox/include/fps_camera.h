@@ -49,6 +49,9 @@ namespace Byte {
 		}
 
 		void update(Window& window, Transform& transform, float dt) {
+			if (!window.glfwWindow) {
+				return;
+			}
 
 			double xpos, ypos;
 			glfwGetCursorPos(window.glfwWindow, &xpos, &ypos);
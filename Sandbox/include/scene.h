@@ -6,6 +6,8 @@
 
 #include "render.h"
 #include "render/mesh_renderer.h"
+#include "render/frame_capture.h"
+#include "core/static_batcher.h"
 #include "particle.h"
 #include "terrain.h"
 #include "fps_camera.h"
@@ -19,6 +21,14 @@ namespace Byte {
 		Transform transform;
 		MeshRenderer renderer;
 		std::unique_ptr<Collider> collider;
+
+		bool isStatic{ false };
+		bool batched{ false };
+	};
+
+	struct StaticEntity {
+		StaticBatch batch;
+		MeshRenderer renderer;
 	};
 
 	struct InstancedEntity {
@@ -39,6 +49,8 @@ namespace Byte {
 
 		std::unordered_map<std::string, InstancedEntity> instancedEntities;
 
+		std::vector<StaticEntity> staticEntities;
+
 		std::vector<std::unique_ptr<PointLight>> pointLights;
 		std::vector<std::unique_ptr<Transform>> pointLightTransforms;
 
@@ -47,6 +59,8 @@ namespace Byte {
 		ParticleSystem particleSystem;
 		FPSCamera fpsCamera;
 
+		FrameCapture* capture{};
+
 		void setContext(Renderer& renderer) {
 			renderer.context().clear();
 
@@ -54,7 +68,13 @@ namespace Byte {
 			renderer.context().submit(directionalLight, directionalLightTransform);
 
 			for (auto& pair : entities) {
-				renderer.context().submit(pair.second.mesh, pair.second.material, pair.second.transform, pair.second.renderer);
+				if (!pair.second.batched) {
+					renderer.context().submit(pair.second.mesh, pair.second.material, pair.second.transform, pair.second.renderer);
+				}
+			}
+
+			for (auto& entity : staticEntities) {
+				renderer.context().submit(entity.batch.mesh, entity.batch.material, entity.batch.transform, entity.renderer);
 			}
 
 			for (size_t i{}; i < pointLights.size(); ++i) {
@@ -70,33 +90,66 @@ namespace Byte {
 			}
 		}
 
+		// Merges the static entities into batches once they are placed; entities the batcher
+		// does not accept keep drawing on their own.
+		void batchStatic() {
+			StaticBatcher batcher;
+
+			for (auto& [tag, entity] : entities) {
+				entity.batched = entity.isStatic && batcher.add(entity.mesh, entity.material, entity.transform);
+			}
+
+			staticEntities.clear();
+			for (auto& batch : batcher.build()) {
+				staticEntities.push_back(StaticEntity{ std::move(batch) });
+			}
+		}
+
 		void update(float dt, Renderer& renderer, Window& window) {
-			particleSystem.update(dt, renderer);
+			BYTE_PROFILE_ZONE("Scene::update");
+
+			{
+				BYTE_PROFILE_ZONE("ParticleSystem::update");
+				particleSystem.update(dt, renderer);
+			}
+
 			fpsCamera.update(window, cameraTransform, dt);
 
-			std::vector<Collider*> colliders;
+			{
+				BYTE_PROFILE_ZONE("Physics");
 
-			for (auto& [tag, entity] : entities) {
-				if (entity.collider) {
-					colliders.push_back(entity.collider.get());
+				std::vector<Collider*> colliders;
+
+				for (auto& [tag, entity] : entities) {
+					if (entity.collider) {
+						colliders.push_back(entity.collider.get());
+					}
 				}
+
+				Physics::applyGravity(colliders, dt);
+				Physics::solve(colliders);
 			}
 
-			Physics::applyGravity(colliders, dt);
-			Physics::solve(colliders);
+			renderer.context().time(renderer.context().time() + dt);
 
-			renderer.context().input<float>("uTime") += dt;
+			if (capture) {
+				capture->capture(renderer, dt);
+			}
 
 			renderer.render();
 			renderer.update(window);
-			glfwPollEvents();
+			if (window.glfwWindow) {
+				glfwPollEvents();
+			}
+
+			BYTE_PROFILE_ZONE("Scene::spawn");
 
 			//APP specific:
 			Texture& heightMap{ textures.at("height_map") };
 			auto& group{ particleSystem.groups().at("grass_particle") };
 			Particle particle{};
 			particle.lifeTime = 5.0f;
-			particle.velocity = renderer.context().input<Vec3>("uWind") * 3 + Vec3{ 0.0f, 1.0f, 0.0f };
+			particle.velocity = renderer.context().wind() * 3 + Vec3{ 0.0f, 1.0f, 0.0f };
 
 			const float spawnRadius{ 100.0f };
 			Vec3 cameraPos{ cameraTransform.position() };
@@ -134,7 +187,7 @@ namespace Byte {
 				group.particles.push_back(particle);
 			}
 
-			if (glfwGetKey(window.glfwWindow, GLFW_KEY_E) == GLFW_PRESS) {
+			if (window.glfwWindow && glfwGetKey(window.glfwWindow, GLFW_KEY_E) == GLFW_PRESS) {
 				Entity sphere;
 				sphere.mesh = MeshBuilder::sphere(1,10);
 				sphere.transform = Transform{ cameraTransform };
@@ -6,6 +6,7 @@
 #include <algorithm>
 
 #include "core/mesh.h"
+#include "core/mesh_optimizer.h"
 
 namespace Byte {
 
@@ -49,10 +50,21 @@ namespace Byte {
             std::move(vertices),
             std::move(indices),
             MeshMode::STATIC,
-            1000.0f,
+            {},
             {3, 2}
         };
 
+        // Neighbouring patches emit their shared corners separately.
+        MeshOptimizer::weld(data);
+        MeshOptimizer::optimizeVertexFetch(data);
+
+        // terrain.tese displaces the flat grid by heights in [-16, 48].
+        BoundingBox box{ MeshBounds::computeBox(data.vertices.data(), data.vertices.size() / 5, 5) };
+        box.min.y = -16.0f;
+        box.max.y = 48.0f;
+
+        data.bounds = MeshBounds::enclosing(box);
+
         return Mesh{ std::move(data) };
     }
 
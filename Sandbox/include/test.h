@@ -10,6 +10,8 @@
 #include "render/mesh_renderer.h"
 #include "particle.h"
 #include "terrain.h"
+#include "core/mesh_optimizer.h"
+#include "core/mesh_file.h"
 #include "fps_camera.h"
 #include "scene.h"
 #include "loader.h"
@@ -34,6 +36,65 @@ namespace Byte {
 		return Mesh{ std::move(data) };
 	}
 
+	// Blotchy grey stone; rocks pick one of a few of these, which the renderer packs into one array.
+	inline TextureData buildStoneTexture(size_t size, uint32_t seed) {
+		auto noise = [seed](size_t x, size_t y) {
+			uint32_t h{ static_cast<uint32_t>(x) * 374761393u + static_cast<uint32_t>(y) * 668265263u + seed * 2246822519u };
+			h = (h ^ (h >> 13)) * 1274126177u;
+			return static_cast<float>((h ^ (h >> 16)) & 0xFF) / 255.0f;
+		};
+
+		TextureData texture;
+		texture.width = size;
+		texture.height = size;
+		texture.wrapS = TextureWrap::REPEAT;
+		texture.wrapT = TextureWrap::REPEAT;
+		texture.data.resize(size * size * 4);
+
+		for (size_t y{}; y < size; ++y) {
+			for (size_t x{}; x < size; ++x) {
+				float value{ 0.6f * noise(x / 8, y / 8) + 0.25f * noise(x / 2, y / 2) + 0.15f * noise(x, y) };
+				uint8_t grey{ static_cast<uint8_t>(150.0f + value * 105.0f) };
+
+				uint8_t* pixel{ texture.data.data() + (y * size + x) * 4 };
+				pixel[0] = grey;
+				pixel[1] = grey;
+				pixel[2] = static_cast<uint8_t>(grey * 0.95f);
+				pixel[3] = 255;
+			}
+		}
+
+		return texture;
+	}
+
+	inline Mesh optimizeMesh(const std::string& name, MeshData&& data) {
+		MeshOptimizer::Report report{ MeshOptimizer::optimize(data) };
+
+		std::cout << "Mesh " << name
+			<< ": ACMR " << report.before.acmr << " -> " << report.after.acmr
+			<< ", ATVR " << report.before.atvr << " -> " << report.after.atvr
+			<< ", vertices " << report.before.vertexCount << " -> " << report.after.vertexCount << "\n";
+
+		return Mesh{ std::move(data) };
+	}
+
+	// Places a mesh file in front of the camera, scaled to a few units across. Its vertices are
+	// drawn straight from the file's mapping.
+	inline void addMeshFile(Scene& scene, Renderer& renderer, const Path& path) {
+		Entity entity;
+		entity.mesh = MeshFile::load(path);
+
+		const BoundingSphere& sphere{ entity.mesh.bounds().sphere };
+		float scale{ sphere.radius > 0.0f ? 8.0f / sphere.radius : 1.0f };
+
+		entity.transform.scale(Vec3{ scale, scale, scale });
+		entity.transform.position(scene.cameraTransform.position() + scene.cameraTransform.front() * 40.0f - sphere.center * scale);
+		entity.material.albedo(Vec3{ 0.8f, 0.8f, 0.8f });
+
+		scene.entities["mesh_file"] = std::move(entity);
+		scene.setContext(renderer);
+	}
+
 	inline Scene buildCustomScene(Renderer& renderer) {
 		Scene scene;
 
@@ -98,10 +159,7 @@ namespace Byte {
 
 		renderer.data().shaders.emplace("grass", Shader{ "shader/grass.vert","../ByteRenderer/shader/deferred.frag" });
 		renderer.data().shaders.emplace("particle", Shader{ "shader/particle.vert","../ByteRenderer/shader/forward.frag" });
-		renderer.data().shaders.at("grass").include(Uniform{ "uTime",UniformType::FLOAT });
-		renderer.context().input("uTime", ShaderInput<float>{0.0f, UniformType::FLOAT});
-		renderer.data().shaders.at("grass").include(Uniform{ "uWind",UniformType::VEC3 });
-		renderer.context().input("uWind", ShaderInput<Vec3>{Vec3(1.0f, 0.0, 0.0f), UniformType::VEC3});
+		renderer.context().wind(Vec3(1.0f, 0.0, 0.0f));
 		renderer.compileShaders();
 		scene.instancedEntities.at("grass").material.shaderMap().emplace("geometry", "grass");
 		scene.particleSystem.groups().emplace("grass_particle", ParticleGroup{ MeshBuilder::plane(0.2f,0.2f,1), Material{} });
@@ -127,8 +185,33 @@ namespace Byte {
 		scene.entities["height_map"] = std::move(terrain);
 		scene.entities["height_map"].collider->transform = &scene.entities["height_map"].transform;
 
+		Mesh rockMesh{ optimizeMesh("rock", MeshData{ MeshBuilder::sphere(1.0f, 8).data() }) };
+
+		constexpr size_t rockTextures{ 4 };
+		for (size_t i{}; i < rockTextures; ++i) {
+			scene.textures["rock_" + std::to_string(i)] = buildStoneTexture(64, static_cast<uint32_t>(i + 1));
+		}
+
+		for (size_t i{}; i < 32; ++i) {
+			float x{ static_cast<float>(rand() % 1200) / 10.0f - 110.0f };
+			float z{ static_cast<float>(rand() % 1200) / 10.0f - 20.0f };
+
+			Entity rock;
+			rock.mesh = rockMesh;
+			rock.material.albedo(Vec3{ 0.36f, 0.34f, 0.31f });
+			rock.material.roughness(0.9f);
+			rock.material.texture("albedo", scene.textures.at("rock_" + std::to_string(i % rockTextures)));
+			rock.transform.position(Vec3{ x, getHeight(heightMap, x, z), z });
+			rock.transform.rotation(Vec3{ 0.0f, static_cast<float>(rand() % 360), 0.0f });
+			rock.transform.scale(Vec3{ 1.6f, 0.8f, 1.2f } * (1.0f + (rand() % 1000) / 1000.0f));
+			rock.isStatic = true;
+
+			scene.entities["rock_" + std::to_string(i)] = std::move(rock);
+		}
+
 		scene.cameraTransform.position(Vec3(-50.0f, 70.0f, 100.0f));
 
+		scene.batchStatic();
 		scene.setContext(renderer);
 
 		return scene;
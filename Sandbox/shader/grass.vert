@@ -6,15 +6,32 @@ layout (location = 2) in vec2 aTexCoord;
 layout (location = 3) in vec3 aPosition;
 layout (location = 4) in vec3 aScale;
 
-uniform mat4 uProjection;
-uniform mat4 uView;
-
-uniform float uTime;
-uniform vec3 uWind;
+layout (std140) uniform FrameData {
+    vec3 uWind;
+    float uTime;
+    vec3 uFogColor;
+    float uFogNear;
+    vec2 uScreenSize;
+    float uFogFar;
+    float uGamma;
+};
+
+layout (std140) uniform ViewData {
+    mat4 uProjection;
+    mat4 uView;
+    mat4 uInverseProjection;
+    mat4 uInverseView;
+    vec3 uViewPos;
+    float uNear;
+    float uFar;
+};
+
+uniform int uMaterialIndex;
 
 out vec3 vNormal;
 out vec2 vTexCoord;
 out vec3 vFragPos;
+flat out int vMaterialIndex;
 
 vec3 rotateAroundY(vec3 v, float angle) {
     float s = sin(angle);
@@ -69,4 +86,5 @@ void main() {
     vNormal = normalize(rotateAroundY(aNormal, angle));
     vTexCoord = aTexCoord;
     vFragPos = worldPos;
+    vMaterialIndex = uMaterialIndex;
 }
@@ -8,12 +8,22 @@ layout (location = 3) in vec3 aPosition;
 layout (location = 4) in vec3 aScale;
 layout (location = 5) in vec4 aRotation;
 
-uniform mat4 uProjection;
-uniform mat4 uView;
+layout (std140) uniform ViewData {
+    mat4 uProjection;
+    mat4 uView;
+    mat4 uInverseProjection;
+    mat4 uInverseView;
+    vec3 uViewPos;
+    float uNear;
+    float uFar;
+};
+
+uniform int uMaterialIndex;
 
 out vec3 vNormal;
 out vec2 vTexCoord;
 out vec3 vFragPos;
+flat out int vMaterialIndex;
 
 vec3 scaleVertex(vec3 point, vec3 scaleFactor) {
     return point * scaleFactor;
@@ -99,4 +109,5 @@ void main() {
     vNormal = normalize(finalRot * aNormal);
     vTexCoord = aTexCoord;
     vFragPos = translated;
+    vMaterialIndex = uMaterialIndex;
 }
@@ -1,7 +1,11 @@
 #include <chrono>
+#include <cstring>
+#include <fstream>
 
 #include "test.h"
 #include "render.h"
+#include "core/mesh_file.h"
+#include "core/mesh_importer.h"
 
 using namespace Byte;
 
@@ -13,7 +17,292 @@ extern "C" {
 //TODO: Lighting to transparent objects (with shadows).
 //TODO: OIT.
 
-int main() {
+// Loads an OBJ or glTF file and reports how long it took and what it holds.
+int runImport(const Path& input, const ImportSettings& settings) {
+	try {
+		auto start{ std::chrono::high_resolution_clock::now() };
+
+		MeshData data{ MeshImporter::load(input, settings) };
+
+		float elapsed{ std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() };
+
+		// Quantized imports keep only the packed vertices.
+		size_t stride{};
+		for (uint8_t size : data.vertexLayout) {
+			stride += size;
+		}
+
+		size_t vertexCount{ data.vertices.empty()
+			? data.packed.bytes().size() / std::max<size_t>(data.packed.stride, 1)
+			: data.vertices.size() / std::max<size_t>(stride, 1) };
+
+		std::cout << "Imported " << input.string() << " in " << elapsed << " ms\n";
+		std::cout << "  Vertices: " << vertexCount << ", indices: " << data.indices.size() << ", ranges: " << data.ranges.size() << ", LODs: " << data.lods.size() << "\n";
+		std::cout << "  Bounding radius: " << data.bounds.sphere.radius << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cout << "Cannot import " << input.string() << ": " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+// Writes an OBJ, glTF or mesh file as a mesh file; loading it again maps the vertices in place.
+int runConvert(const Path& input, const Path& output, const ImportSettings& settings) {
+	try {
+		auto start{ std::chrono::high_resolution_clock::now() };
+
+		std::string extension{ input.extension().string() };
+		Mesh mesh{ extension == ".bmsh" ? MeshFile::load(input, true) : Mesh{ MeshImporter::load(input, settings) } };
+
+		// Float vertices are quantized, so the arena can draw the mapped file without repacking it.
+		if (mesh.data().vertexTypes.empty()) {
+			mesh = MeshBuilder::quantized(mesh);
+		}
+
+		MeshFile::write(output, mesh);
+
+		float elapsed{ std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() };
+
+		MeshFileHeader header{ MeshFile::inspect(output) };
+		std::cout << "Converted " << input.string() << " to " << output.string() << " in " << elapsed << " ms\n";
+		std::cout << "  Vertices: " << header.vertexCount << " (" << header.stride << " bytes each)\n";
+		std::cout << "  Indices: " << header.indexCount << ", ranges: " << header.rangeCount << ", LODs: " << header.lodCount << std::endl;
+
+		const MeshData& data{ mesh.data() };
+		if (data.vertexLayout != MeshArena::Format::vertexLayout() || data.vertexTypes != MeshArena::Format::vertexTypes()) {
+			std::cout << "  Not in the mesh arena format, so it is repacked or drawn from its own array when loaded" << std::endl;
+		}
+	}
+	catch (const std::exception& e) {
+		std::cout << "Cannot convert " << input.string() << ": " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+// Runs the scene on the null or recording device with a fixed timestep and reports CPU cost.
+int runHeadless(RenderBackend backend, size_t frames, const Path& meshPath) {
+	RenderAPI::backend(backend);
+
+	Window window{ 1336,768 };
+
+	Renderer renderer{ deferredRenderer(window) };
+
+	Scene scene{ buildCustomScene(renderer) };
+	if (!meshPath.empty()) {
+		addMeshFile(scene, renderer, meshPath);
+	}
+
+	std::cout << "Renderer: " << glGetString(GL_RENDERER) << "\n";
+
+	renderer.load();
+	NullDevice::resetCounters();
+	NullDevice::clearLog();
+	RenderAPI::State::resetCounters();
+
+	const float deltaTime{ 1.0f / 60.0f };
+	auto start{ std::chrono::high_resolution_clock::now() };
+
+	for (size_t frame{}; frame < frames; ++frame) {
+		scene.update(deltaTime, renderer, window);
+	}
+
+	float elapsed{ std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() };
+
+	const auto& counters{ NullDevice::counters() };
+	std::cout << "Frames: " << frames << "\n";
+	std::cout << "  CPU: " << elapsed / frames << " ms per frame\n";
+	std::cout << "  GL calls: " << counters.calls / frames << " per frame\n";
+	std::cout << "  Draws: " << counters.draws / frames
+		<< " (" << counters.instances / frames << " instances, "
+		<< counters.indices / frames << " indices) per frame\n";
+	std::cout << "  Binds: " << counters.binds / frames << ", uniforms: " << counters.uniforms / frames << " per frame\n";
+	std::cout << "  Uploaded: " << counters.uploadedBytes / frames << " bytes per frame\n";
+	std::cout << "  GL errors: " << counters.errors << std::endl;
+
+	if (backend == RenderBackend::RECORDING) {
+		std::ofstream file{ "calls.log" };
+		NullDevice::writeLog(file);
+		std::cout << "  Call log written to calls.log" << std::endl;
+	}
+
+	return counters.errors ? 1 : 0;
+}
+
+// Renders the scene offscreen on a headless GL context with a fixed timestep, reports CPU and
+// GPU cost, and writes the last frame to frame.ppm.
+int runOffscreen(size_t frames, const Path& meshPath) {
+	if (!Window::initialize(WindowMode::HEADLESS)) {
+		std::cout << "GLFW null platform is unavailable" << std::endl;
+		return 1;
+	}
+
+	Window window{ 1336,768,"Test",WindowMode::HEADLESS };
+
+	Renderer renderer{ deferredRenderer(window) };
+
+	Scene scene{ buildCustomScene(renderer) };
+	if (!meshPath.empty()) {
+		addMeshFile(scene, renderer, meshPath);
+	}
+
+	std::cout << "Renderer: " << glGetString(GL_RENDERER) << "\n";
+	std::cout << "Version: " << glGetString(GL_VERSION) << "\n";
+
+	renderer.load();
+
+	const float deltaTime{ 1.0f / 60.0f };
+	auto start{ std::chrono::high_resolution_clock::now() };
+
+	for (size_t frame{}; frame < frames; ++frame) {
+		scene.update(deltaTime, renderer, window);
+	}
+
+	float elapsed{ std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() };
+
+	std::cout << "Frames: " << frames << "\n";
+	std::cout << "  CPU: " << elapsed / frames << " ms per frame\n";
+
+	const GPUTimer& gpuTimer{ renderer.gpuTimer() };
+	for (const auto& zone : gpuTimer.zones()) {
+		std::cout << "  " << zone.tag
+			<< " avg: " << gpuTimer.average(zone.tag) << " ms"
+			<< " p95: " << gpuTimer.percentile(zone.tag, 0.95f) << " ms\n";
+	}
+	std::cout << "  GPU total: " << gpuTimer.total() << " ms" << std::endl;
+
+	size_t width{ window.width() };
+	size_t height{ window.height() };
+	Buffer<uint8_t> pixels{ renderer.readback() };
+
+	std::ofstream file{ "frame.ppm", std::ios::binary };
+	file << "P6\n" << width << " " << height << "\n255\n";
+	for (size_t y{ height }; y-- > 0;) {
+		for (size_t x{}; x < width; ++x) {
+			file.write(reinterpret_cast<const char*>(&pixels[(y * width + x) * 4]), 3);
+		}
+	}
+	std::cout << "  Last frame written to frame.ppm" << std::endl;
+
+	GLenum error{ glGetError() };
+	if (error) {
+		std::cout << "GRAPHIC ERROR: " << error << std::endl;
+	}
+
+	return error ? 1 : 0;
+}
+
+// Re-renders a frame capture offscreen, one captured frame per step, and reports per-frame timings.
+// GPU times trail the CPU by the GPU timer's query latency.
+int runReplay(const Path& path) {
+	if (!Window::initialize(WindowMode::HEADLESS)) {
+		std::cout << "GLFW null platform is unavailable" << std::endl;
+		return 1;
+	}
+
+	Window window{ 1336,768,"Replay",WindowMode::HEADLESS };
+
+	Renderer renderer{ deferredRenderer(window) };
+
+	FrameReplay replay{ path };
+
+	std::cout << "Renderer: " << glGetString(GL_RENDERER) << "\n";
+
+	const GPUTimer& gpuTimer{ renderer.gpuTimer() };
+	float cpuTotal{};
+
+	while (replay.next(renderer)) {
+		auto start{ std::chrono::high_resolution_clock::now() };
+
+		renderer.render();
+		renderer.update(window);
+
+		float cpu{ std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() };
+		cpuTotal += cpu;
+
+		float gpu{};
+		for (const auto& zone : gpuTimer.zones()) {
+			gpu += gpuTimer.latest(zone.tag);
+		}
+
+		std::cout << "Frame " << replay.frame() << ": CPU " << cpu << " ms, GPU " << gpu << " ms\n";
+	}
+
+	if (!replay.frame()) {
+		std::cout << "Capture holds no frames" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Frames: " << replay.frame() << "\n";
+	std::cout << "  CPU avg: " << cpuTotal / replay.frame() << " ms\n";
+	for (const auto& zone : gpuTimer.zones()) {
+		std::cout << "  " << zone.tag
+			<< " avg: " << gpuTimer.average(zone.tag) << " ms"
+			<< " p95: " << gpuTimer.percentile(zone.tag, 0.95f) << " ms\n";
+	}
+	std::cout << "  GPU total: " << gpuTimer.total() << " ms" << std::endl;
+
+	GLenum error{ glGetError() };
+	if (error) {
+		std::cout << "GRAPHIC ERROR: " << error << std::endl;
+	}
+
+	return error ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+	Path capturePath{};
+	size_t captureFrames{};
+
+	// A mesh file to draw in any of the modes below, and how --import and --convert read meshes.
+	Path meshPath{};
+	ImportSettings importSettings{};
+
+	for (int i{ 1 }; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--mesh") == 0 && i + 1 < argc) {
+			meshPath = argv[i + 1];
+		}
+
+		importSettings.quantize = importSettings.quantize || std::strcmp(argv[i], "--quantize") == 0;
+		importSettings.lods = importSettings.lods || std::strcmp(argv[i], "--lods") == 0;
+	}
+
+	for (int i{ 1 }; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--import") == 0 && i + 1 < argc) {
+			return runImport(argv[i + 1], importSettings);
+		}
+
+		if (std::strcmp(argv[i], "--convert") == 0 && i + 2 < argc) {
+			return runConvert(argv[i + 1], argv[i + 2], importSettings);
+		}
+
+		if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			return runReplay(argv[i + 1]);
+		}
+
+		if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+			capturePath = argv[i + 1];
+			captureFrames = i + 2 < argc ? std::strtoull(argv[i + 2], nullptr, 10) : 0;
+			captureFrames = captureFrames ? captureFrames : 300;
+		}
+
+		if (std::strcmp(argv[i], "--headless") == 0) {
+			size_t frames{ i + 1 < argc ? std::strtoull(argv[i + 1], nullptr, 10) : 0 };
+			return runOffscreen(frames ? frames : 300, meshPath);
+		}
+
+		bool null{ std::strcmp(argv[i], "--null") == 0 };
+		bool record{ std::strcmp(argv[i], "--record") == 0 };
+
+		if (null || record) {
+			size_t frames{ i + 1 < argc ? std::strtoull(argv[i + 1], nullptr, 10) : 0 };
+			return runHeadless(null ? RenderBackend::NULL_DEVICE : RenderBackend::RECORDING, frames ? frames : 300, meshPath);
+		}
+	}
+
 	glfwInit();
 
 	Window window{ 1336,768,"Test" };
@@ -21,6 +310,15 @@ int main() {
 	Renderer renderer{ deferredRenderer(window) };
 
 	Scene scene{ buildCustomScene(renderer) };
+	if (!meshPath.empty()) {
+		addMeshFile(scene, renderer, meshPath);
+	}
+
+	FrameCapture capture;
+	if (!capturePath.empty()) {
+		capture.open(capturePath);
+		scene.capture = &capture;
+	}
 
 	std::cout << "Renderer: " << glGetString(GL_RENDERER) << "\n";
 	std::cout << "Vendor: " << glGetString(GL_VENDOR) << "\n";
@@ -38,11 +336,31 @@ int main() {
 
 		scene.update(deltaTime, renderer, window);
 
+		if (scene.capture && capture.frames() >= captureFrames) {
+			capture.close();
+			scene.capture = nullptr;
+			std::cout << "Captured " << captureFrames << " frames to " << capturePath.string() << std::endl;
+		}
+
 		frameCount++;
 		fpsTimer += deltaTime;
 
 		if (fpsTimer >= 1.0f) {
 			std::cout << "FPS: " << frameCount << std::endl;
+
+			const GPUTimer& gpuTimer{ renderer.gpuTimer() };
+			for (const auto& zone : gpuTimer.zones()) {
+				std::cout << "  " << zone.tag
+					<< " avg: " << gpuTimer.average(zone.tag) << " ms"
+					<< " p95: " << gpuTimer.percentile(zone.tag, 0.95f) << " ms\n";
+			}
+			std::cout << "  GPU total: " << gpuTimer.total() << " ms" << std::endl;
+
+			const auto& stateCounters{ RenderAPI::State::counters() };
+			std::cout << "  GL state: " << stateCounters.issued / frameCount << " issued, "
+				<< stateCounters.filtered / frameCount << " filtered per frame" << std::endl;
+			RenderAPI::State::resetCounters();
+
 			GLenum error{ glGetError() };
 			if (error) {
 				std::cout << "GRAPHIC ERROR: " << error << std::endl;
@@ -52,5 +370,9 @@ int main() {
 		}
 	}
 
+#ifdef BYTE_PROFILE
+	Profiler::exportChromeTrace("trace.json");
+#endif
+
 	return 0;
 }
\ No newline at end of file